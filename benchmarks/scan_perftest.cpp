@@ -1,7 +1,12 @@
+#include <array>
+#include <string_view>
+
 #include "mio/mmap.hpp"
 #include "spdlog/spdlog.h"
 
+#include "index_types.hpp"
 #include "mappable/mapper.hpp"
+#include "memory_source.hpp"
 #include "sequence/partitioned_sequence.hpp"
 #include "sequence/uniform_partitioned_sequence.hpp"
 #include "sequence_collection.hpp"
@@ -11,8 +16,29 @@
 using pisa::do_not_optimize_away;
 using pisa::get_time_usecs;
 
+/**
+ * Reads the first `calls` values of a sequence one by one with `next()` or, with `bulk`, by
+ * decoding them in chunks of 128 values.
+ */
+template <typename Reader>
+void scan_sequence(Reader& reader, uint64_t calls, bool bulk)
+{
+    if (bulk) {
+        std::array<uint64_t, 128> values;
+        for (uint64_t pos = 0; pos < calls; pos += values.size()) {
+            reader.decode(pos, std::min<uint64_t>(values.size(), calls - pos), values.data());
+            do_not_optimize_away(values);
+        }
+        return;
+    }
+    auto val = reader.move(0);
+    for (size_t i = 0; i < calls; ++i, val = reader.next()) {
+        do_not_optimize_away(val.second);
+    }
+}
+
 template <typename BaseSequence>
-void perftest(const char* index_filename)
+void perftest(const char* index_filename, bool bulk)
 {
     using collection_type = pisa::sequence_collection<BaseSequence>;
     spdlog::info("Loading collection from {}", index_filename);
@@ -21,17 +47,14 @@ void perftest(const char* index_filename)
     pisa::mapper::map(coll, m, pisa::mapper::map_flags::warmup);
 
     if (true) {
-        spdlog::info("Scanning all the posting lists");
+        spdlog::info("Scanning all the posting lists{}", bulk ? " in bulk" : "");
         auto tick = get_time_usecs();
         uint64_t calls_per_list = 500000;
         size_t postings = 0;
         for (size_t i = 0; i < coll.size(); ++i) {
             auto reader = coll[i];
             auto calls = std::min(calls_per_list, reader.size());
-            auto val = reader.move(0);
-            for (size_t i = 0; i < calls; ++i, val = reader.next()) {
-                do_not_optimize_away(val.second);
-            }
+            scan_sequence(reader, calls, bulk);
             postings += calls;
         }
         double elapsed = get_time_usecs() - tick;
@@ -44,7 +67,9 @@ void perftest(const char* index_filename)
 
     {
         size_t min_length = 4096;
-        spdlog::info("Scanning posting lists longer than {}", min_length);
+        spdlog::info(
+            "Scanning posting lists longer than {}{}", min_length, bulk ? " in bulk" : ""
+        );
         std::vector<size_t> long_lists;
         for (size_t i = 0; i < coll.size(); ++i) {
             if (coll[i].size() >= min_length) {
@@ -58,10 +83,7 @@ void perftest(const char* index_filename)
         for (auto i: long_lists) {
             auto reader = coll[i];
             auto calls = std::min(calls_per_list, reader.size());
-            auto val = reader.move(0);
-            for (size_t i = 0; i < calls; ++i, val = reader.next()) {
-                do_not_optimize_away(val.second);
-            }
+            scan_sequence(reader, calls, bulk);
             postings += calls;
         }
         double elapsed = get_time_usecs() - tick;
@@ -131,6 +153,49 @@ void perftest(const char* index_filename)
             (elapsed / calls * 1000));
     }
 }
+/**
+ * Scans the posting lists of a block index, decoding both document IDs and frequencies, so that
+ * the cost of decoding the blocks of each codec can be compared.
+ */
+template <typename Index>
+void block_perftest(Index const& index)
+{
+    auto scan = [&](std::vector<size_t> const& lists) {
+        auto tick = get_time_usecs();
+        uint64_t calls_per_list = 500000;
+        size_t postings = 0;
+        for (auto i: lists) {
+            auto reader = index[i];
+            auto calls = std::min(calls_per_list, reader.size());
+            for (size_t i = 0; i < calls; ++i, reader.next()) {
+                do_not_optimize_away(reader.docid());
+                do_not_optimize_away(reader.freq());
+            }
+            postings += calls;
+        }
+        double elapsed = get_time_usecs() - tick;
+        spdlog::info(
+            "Read {} postings in {} seconds, {:.1f} ns per posting",
+            postings,
+            uint64_t(elapsed / 1000000),
+            (elapsed / postings * 1000));
+    };
+
+    size_t min_length = 4096;
+    std::vector<size_t> all_lists;
+    std::vector<size_t> long_lists;
+    for (size_t i = 0; i < index.size(); ++i) {
+        all_lists.push_back(i);
+        if (index[i].size() >= min_length) {
+            long_lists.push_back(i);
+        }
+    }
+    spdlog::info("Scanning all the posting lists");
+    scan(all_lists);
+    spdlog::info("Scanning posting lists longer than {}", min_length);
+    scan(long_lists);
+}
+
 int main(int argc, const char** argv)
 {
     using pisa::compact_elias_fano;
@@ -138,8 +203,10 @@ int main(int argc, const char** argv)
     using pisa::partitioned_sequence;
     using pisa::uniform_partitioned_sequence;
 
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <collection type> <index filename>" << std::endl;
+    bool bulk = argc == 4 && std::string_view(argv[3]) == "--bulk";
+    if (argc != 3 && !bulk) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <collection type | block encoding> <index filename> [--bulk]" << std::endl;
         return 1;
     }
 
@@ -147,13 +214,22 @@ int main(int argc, const char** argv)
     const char* index_filename = argv[2];
 
     if (type == "ef") {
-        perftest<compact_elias_fano>(index_filename);
+        perftest<compact_elias_fano>(index_filename, bulk);
     } else if (type == "is") {
-        perftest<indexed_sequence>(index_filename);
+        perftest<indexed_sequence>(index_filename, bulk);
     } else if (type == "uniform") {
-        perftest<uniform_partitioned_sequence<>>(index_filename);
+        perftest<uniform_partitioned_sequence<>>(index_filename, bulk);
     } else if (type == "part") {
-        perftest<partitioned_sequence<>>(index_filename);
+        perftest<partitioned_sequence<>>(index_filename, bulk);
+    } else if (type.rfind("block_", 0) == 0) {
+        if (bulk) {
+            spdlog::warn("Block indexes always decode whole blocks, ignoring --bulk");
+        }
+        pisa::run_for_index(
+            type,
+            pisa::MemorySource::mapped_file(std::string_view(index_filename)),
+            [](auto index) { block_perftest(index); }
+        );
     } else {
         spdlog::error("Unknown type {}", type);
     }
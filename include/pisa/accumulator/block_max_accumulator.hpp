@@ -0,0 +1,133 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "partial_score_accumulator.hpp"
+#include "topk_queue.hpp"
+#include "util/intrinsics.hpp"
+
+namespace pisa {
+
+/**
+ * Accumulator that keeps, next to the array of scores, the maximum score of each block of
+ * `block_size` consecutive documents.
+ *
+ * The maximum is updated whenever a score is accumulated. Collection skips the blocks whose
+ * maximum would not enter the top-k queue, and compares the scores of the remaining blocks
+ * against the threshold with SIMD instructions. The maximum of a block that has not been touched
+ * since the last reset is the lowest float value, so resetting only clears the touched blocks.
+ */
+template <std::size_t block_size = 64>
+class BlockMaxAccumulator {
+    static_assert(block_size > 0 && block_size % 8 == 0, "block size must be a multiple of 8");
+
+    constexpr static float untouched = std::numeric_limits<float>::lowest();
+
+  public:
+    explicit BlockMaxAccumulator(std::size_t size)
+        : m_size(size),
+          m_block_max((size + block_size - 1) / block_size, untouched),
+          m_scores(m_block_max.size() * block_size) {
+        static_assert(PartialScoreAccumulator<decltype(*this)>);
+    }
+
+    void reset() {
+        for (std::size_t block = 0; block < m_block_max.size(); ++block) {
+            if (m_block_max[block] != untouched) {
+                auto first = std::next(m_scores.begin(), block * block_size);
+                std::fill(first, std::next(first, block_size), 0.0F);
+                m_block_max[block] = untouched;
+            }
+        }
+    }
+
+    void accumulate(std::uint32_t doc, float score) {
+        auto& accumulated = m_scores[doc];
+        accumulated += score;
+        auto& block_max = m_block_max[doc / block_size];
+        block_max = std::max(block_max, accumulated);
+    }
+
+    /**
+     * Pushes the scores of the blocks whose maximum would enter the queue. If the queue supports
+     * batch insertion, such as `buffered_topk_queue`, each such block is inserted as a batch.
+     */
+    template <typename Queue>
+    void collect(Queue& topk) {
+        for (std::size_t block = 0; block < m_block_max.size(); ++block) {
+            if (not topk.would_enter(m_block_max[block])) {
+                continue;
+            }
+            auto first = block * block_size;
+            auto scores = std::span<float const>(m_scores).subspan(
+                first, std::min(block_size, m_size - first)
+            );
+            if constexpr (requires { topk.insert_batch(std::span<float const>{}, 0U); }) {
+                topk.insert_batch(scores, static_cast<std::uint32_t>(first));
+            } else {
+                collect_block(topk, scores, static_cast<std::uint32_t>(first));
+            }
+        }
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return m_size; }
+
+    /** The maximum score accumulated in the block of the given document since the last reset. */
+    [[nodiscard]] auto block_max(std::uint32_t doc) const noexcept -> float {
+        return m_block_max[doc / block_size];
+    }
+
+  private:
+    /**
+     * Inserts the scores of a block one by one, selecting the candidates with SIMD comparisons
+     * against the threshold as of the beginning of each group of 8 scores.
+     */
+    template <typename Queue>
+    static void collect_block(Queue& topk, std::span<float const> scores, std::uint32_t first) {
+        std::size_t pos = 0;
+#if defined(__AVX__)
+        for (; pos + 8 <= scores.size(); pos += 8) {
+            __m256 values = _mm256_loadu_ps(scores.data() + pos);
+            __m256 bound = _mm256_set1_ps(topk.effective_threshold());
+            auto mask = static_cast<std::uint64_t>(
+                _mm256_movemask_ps(_mm256_cmp_ps(values, bound, _CMP_GT_OQ))
+            );
+            unsigned long idx;
+            while (intrinsics::bsf64(&idx, mask)) {
+                topk.insert(scores[pos + idx], first + pos + idx);
+                mask &= mask - 1;
+            }
+        }
+#endif
+        for (; pos < scores.size(); ++pos) {
+            if (topk.would_enter(scores[pos])) {
+                topk.insert(scores[pos], first + pos);
+            }
+        }
+    }
+
+    std::size_t m_size;
+    std::vector<float> m_block_max;
+    std::vector<float> m_scores;
+};
+
+}  // namespace pisa
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <span>
 #include <vector>
 
 #include "partial_score_accumulator.hpp"
@@ -78,17 +79,34 @@ class LazyAccumulator {
         m_accumulators[block].accumulators[pos_in_block] += score;
     }
 
-    void collect(topk_queue& topk) {
+    /**
+     * Pushes the scores to the queue. If the queue supports batch insertion, such as
+     * `buffered_topk_queue`, each block is inserted as a batch, with scores from previous queries
+     * replaced by zeros.
+     */
+    template <typename Queue>
+    void collect(Queue& topk) {
         uint64_t docid = 0U;
-        for (auto const& block: m_accumulators) {
-            int pos = 0;
-            for (auto const& score: block.accumulators) {
-                if (block.counter(pos++) == m_counter && topk.would_enter(score)) {
-                    topk.insert(score, docid);
+        if constexpr (requires { topk.insert_batch(std::span<float const>{}, 0U); }) {
+            std::array<float, counters_in_descriptor> scores;
+            for (auto const& block: m_accumulators) {
+                for (int pos = 0; pos < static_cast<int>(counters_in_descriptor); ++pos) {
+                    scores[pos] = block.counter(pos) == m_counter ? block.accumulators[pos] : 0.0F;
                 }
-                ++docid;
+                topk.insert_batch(scores, static_cast<std::uint32_t>(docid));
+                docid += counters_in_descriptor;
             }
-        };
+        } else {
+            for (auto const& block: m_accumulators) {
+                int pos = 0;
+                for (auto const& score: block.accumulators) {
+                    if (block.counter(pos++) == m_counter && topk.would_enter(score)) {
+                        topk.insert(score, docid);
+                    }
+                    ++docid;
+                }
+            };
+        }
         m_counter = (m_counter + 1) % cycle;
     }
 
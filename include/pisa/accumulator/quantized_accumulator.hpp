@@ -0,0 +1,196 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "partial_score_accumulator.hpp"
+#include "topk_queue.hpp"
+#include "util/intrinsics.hpp"
+
+namespace pisa {
+
+/**
+ * Accumulator of integer scores, for indexes with quantized scores.
+ *
+ * Scores are summed in `Lane` integers: with `std::uint16_t`, sums saturate at the maximum value,
+ * which halves the memory traffic compared to floats; with `std::uint32_t`, they are exact.
+ * Partial scores are truncated to integers, which is exact for quantized scores and integer
+ * query term weights.
+ *
+ * The lanes are partitioned into blocks of 32 bytes, i.e., 16 lanes of 16 bits or 8 lanes of 32
+ * bits, each of which fits into an AVX2 register. Each block records the query (epoch) it was last
+ * written in; like in `LazyAccumulator`, a block is cleared only when it is first written in a
+ * query, and blocks written in previous queries are skipped during collection.
+ *
+ * Collection compares whole blocks against an integer threshold with SIMD instructions, and
+ * selects the top-k documents among integer candidates. Only the final top-k scores are converted
+ * to floats when they are pushed to the queue.
+ */
+template <typename Lane = std::uint16_t>
+    requires(std::same_as<Lane, std::uint16_t> || std::same_as<Lane, std::uint32_t>)
+class QuantizedAccumulator {
+    constexpr static std::size_t lanes_per_block = 32 / sizeof(Lane);
+    constexpr static Lane max_lane = std::numeric_limits<Lane>::max();
+
+    struct Block {
+        std::array<Lane, lanes_per_block> lanes{};
+    };
+
+    using candidate_type = std::pair<Lane, std::uint32_t>;
+
+  public:
+    explicit QuantizedAccumulator(std::size_t size)
+        : m_size(size),
+          m_blocks((size + lanes_per_block - 1) / lanes_per_block),
+          m_epochs(m_blocks.size(), 0) {
+        static_assert(PartialScoreAccumulator<decltype(*this)>);
+    }
+
+    void reset() {
+        ++m_epoch;
+        if (m_epoch == 0) {
+            std::fill(m_epochs.begin(), m_epochs.end(), 0);
+            m_epoch = 1;
+        }
+    }
+
+    void accumulate(std::uint32_t doc, float score) {
+        auto const block = doc / lanes_per_block;
+        if (m_epochs[block] != m_epoch) {
+            m_blocks[block] = Block{};
+            m_epochs[block] = m_epoch;
+        }
+        auto& lane = m_blocks[block].lanes[doc % lanes_per_block];
+        auto const partial = static_cast<std::uint32_t>(score);
+        if constexpr (std::same_as<Lane, std::uint16_t>) {
+            lane = static_cast<Lane>(std::min<std::uint32_t>(lane + partial, max_lane));
+        } else {
+            lane += partial;
+        }
+    }
+
+    /**
+     * Pushes the top-k documents to the queue. Documents are selected by their integer scores,
+     * starting with the threshold of the queue rounded down.
+     */
+    template <typename Queue>
+    void collect(Queue& topk) {
+        auto k = topk.capacity();
+        if (k == 0) {
+            return;
+        }
+        auto threshold = integer_threshold(topk.effective_threshold());
+        m_candidates.clear();
+        for (std::size_t block = 0; block < m_blocks.size(); ++block) {
+            if (m_epochs[block] != m_epoch || threshold == max_lane) {
+                continue;
+            }
+            auto const& lanes = m_blocks[block].lanes;
+            auto mask = greater_mask(lanes.data(), threshold);
+            unsigned long idx;
+            while (intrinsics::bsf64(&idx, mask)) {
+                mask &= mask - 1;
+                auto docid = block * lanes_per_block + idx;
+                if (docid < m_size) {
+                    m_candidates.emplace_back(lanes[idx], static_cast<std::uint32_t>(docid));
+                }
+            }
+            if (m_candidates.size() >= 2 * k + lanes_per_block) {
+                threshold = std::max(threshold, select(k));
+            }
+        }
+        select(k);
+        for (auto [score, docid]: m_candidates) {
+            topk.insert(static_cast<Score>(score), docid);
+        }
+        m_candidates.clear();
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return m_size; }
+
+  private:
+    /** The greatest integer that a score must exceed to be greater than `threshold`. */
+    [[nodiscard]] static auto integer_threshold(Score threshold) noexcept -> Lane {
+        if (threshold < 0.0F) {
+            return 0;
+        }
+        auto floor = std::floor(threshold);
+        return floor >= static_cast<Score>(max_lane) ? max_lane : static_cast<Lane>(floor);
+    }
+
+    /**
+     * Keeps the `k` highest scored candidates (if there are more), and returns the lowest of
+     * their scores, or 0 if there are fewer than `k` candidates.
+     */
+    auto select(std::size_t k) -> Lane {
+        if (m_candidates.size() < k) {
+            return 0;
+        }
+        auto kth = std::next(m_candidates.begin(), static_cast<std::ptrdiff_t>(k - 1));
+        std::nth_element(m_candidates.begin(), kth, m_candidates.end(), [](auto lhs, auto rhs) {
+            return lhs.first > rhs.first;
+        });
+        m_candidates.resize(k);
+        return m_candidates.back().first;
+    }
+
+    /** Returns the mask of the lanes of a block that are greater than `threshold`. */
+    [[nodiscard]] static auto greater_mask(Lane const* lanes, Lane threshold) noexcept
+        -> std::uint64_t {
+        // `threshold < max_lane`, so `lane > threshold` iff `max(lane, threshold + 1) == lane`.
+        auto const bound = static_cast<Lane>(threshold + 1);
+#if defined(__AVX2__)
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(lanes));
+        if constexpr (std::same_as<Lane, std::uint16_t>) {
+            __m256i geq = _mm256_cmpeq_epi16(
+                _mm256_max_epu16(x, _mm256_set1_epi16(static_cast<short>(bound))), x
+            );
+            // Narrow the 16-bit comparison results to bytes to get one bit per lane.
+            __m128i bytes = _mm_packs_epi16(
+                _mm256_castsi256_si128(geq), _mm256_extracti128_si256(geq, 1)
+            );
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(bytes));
+        } else {
+            __m256i geq = _mm256_cmpeq_epi32(
+                _mm256_max_epu32(x, _mm256_set1_epi32(static_cast<int>(bound))), x
+            );
+            return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(geq)));
+        }
+#else
+        std::uint64_t mask = 0;
+        for (std::size_t idx = 0; idx < lanes_per_block; ++idx) {
+            mask |= static_cast<std::uint64_t>(lanes[idx] >= bound) << idx;
+        }
+        return mask;
+#endif
+    }
+
+    std::size_t m_size;
+    std::vector<Block> m_blocks;
+    std::vector<std::uint32_t> m_epochs;
+    std::uint32_t m_epoch = 1;
+    std::vector<candidate_type> m_candidates;
+};
+
+}  // namespace pisa
@@ -17,6 +17,7 @@ limitations under the License. */
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 #include "partial_score_accumulator.hpp"
@@ -39,14 +40,23 @@ class SimpleAccumulator: public std::vector<float> {
 
     void accumulate(std::uint32_t doc, float score) { operator[](doc) += score; }
 
-    void collect(topk_queue& topk) {
-        std::uint32_t docid = 0U;
-        std::for_each(begin(), end(), [&](auto score) {
-            if (topk.would_enter(score)) {
-                topk.insert(score, docid);
-            }
-            docid += 1;
-        });
+    /**
+     * Pushes the scores to the queue. If the queue supports batch insertion, such as
+     * `buffered_topk_queue`, the whole array is inserted as a single batch.
+     */
+    template <typename Queue>
+    void collect(Queue& topk) {
+        if constexpr (requires { topk.insert_batch(std::span<float const>{}, 0U); }) {
+            topk.insert_batch(std::span<float const>(data(), size()), 0U);
+        } else {
+            std::uint32_t docid = 0U;
+            std::for_each(begin(), end(), [&](auto score) {
+                if (topk.would_enter(score)) {
+                    topk.insert(score, docid);
+                }
+                docid += 1;
+            });
+        }
     }
 };
 
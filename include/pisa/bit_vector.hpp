@@ -253,6 +253,32 @@ class bit_vector {
             return m_position;
         }
 
+        // write the positions of the next n ones to out, as n calls to next() would return them,
+        // enumerating the ones of each word with popcount and tzcnt
+        void decode(uint64_t n, uint64_t* out) {
+            if (n == 0) {
+                return;
+            }
+            uint64_t base = m_position & ~uint64_t(63);
+            uint64_t buf = m_buf;
+            while (broadword::popcount(buf) < n) {
+                n -= broadword::popcount(buf);
+                for (; buf != 0U; buf &= buf - 1) {
+                    *out++ = base + broadword::lsb(buf);
+                }
+                base += 64;
+                buf = m_data[base / 64];
+            }
+            unsigned long pos_in_word = 0;
+            for (; n > 0; --n) {
+                broadword::lsb(buf, pos_in_word);
+                *out++ = base + pos_in_word;
+                buf &= buf - 1;
+            }
+            m_buf = buf;
+            m_position = base + pos_in_word;
+        }
+
         // skip to the k-th one after the current position
         void skip(uint64_t k) {
             uint64_t skipped = 0;
@@ -1,14 +1,26 @@
 #pragma once
 
-#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <concepts>
+#include <limits>
+#include <memory_resource>
 #include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fmt/format.h>
 #include <spdlog/spdlog.h>
 
 #include "binary_freq_collection.hpp"
 #include "bit_vector.hpp"
 #include "codec/block_codec.hpp"
 #include "codec/block_codecs.hpp"
+#include "concepts/inverted_index.hpp"
 #include "concepts/posting_cursor.hpp"
+#include "docid_bitmap.hpp"
 #include "global_parameters.hpp"
 #include "mappable/mappable_vector.hpp"
 #include "mappable/mapper.hpp"
@@ -18,6 +30,7 @@
 #include "temporary_directory.hpp"
 #include "type_safe.hpp"
 #include "util/block_profiler.hpp"
+#include "util/intrinsics.hpp"
 
 namespace pisa {
 
@@ -26,45 +39,214 @@ namespace index::block {
     class InMemoryPostingAccumulator;
     // class StreamBuilder;
     class StreamPostingAccumulator;
+
+    class HybridCodecSelector;
+
+    /** Posting list flag: the block maxima are followed by a skip layer. */
+    inline constexpr std::uint32_t SKIP_LAYER = 0b1;
+
+    /**
+     * Posting list flag: the flags are followed by the tag of the codec the list is encoded with
+     * (see `HybridBlockInvertedIndex`).
+     */
+    inline constexpr std::uint32_t CODEC_TAG = 0b10;
+
+    /**
+     * Posting list flag: the document IDs are stored as a bitmap over the IDs up to the last one,
+     * placed right before the blocks, which then hold only frequencies (see `DocidBitmap`).
+     */
+    inline constexpr std::uint32_t DENSE = 0b100;
+
+    /**
+     * Posting list flag: the skip layer is followed by the maximum score of the list, as a
+     * 32-bit float, and by an upper bound of the scores of each block, quantized to one byte
+     * (see `block_max_score_step`).
+     */
+    inline constexpr std::uint32_t BLOCK_MAX_SCORES = 0b1000;
+
+    /**
+     * Posting list flag: the header stores the fingerprint of the scorer the block max scores were
+     * computed with (see `scorer_fingerprint`). Only the first posting list of an index has it.
+     */
+    inline constexpr std::uint32_t BLOCK_MAX_SCORER = 0b10000;
+
+    /**
+     * Returns the score of a single quantization step of the block max scores of a list with
+     * the given maximum score, such that 255 steps are at least the maximum score.
+     */
+    [[nodiscard]] inline auto block_max_score_step(float max_score) -> float {
+        float step = max_score / 255.0F;
+        while (step * 255.0F < max_score) {
+            step = std::nextafter(step, std::numeric_limits<float>::infinity());
+        }
+        return step;
+    }
+
+    /** Returns the number of 64-bit words of the bitmap of a dense list ending at `last_docid`. */
+    [[nodiscard]] inline auto dense_bitmap_words(std::uint32_t last_docid) -> std::size_t {
+        return last_docid / 64 + 1;
+    }
+
+    /** The number of blocks covered by a single skip layer entry. */
+    inline constexpr std::uint32_t SKIP_INTERVAL = 64;
+
+    /**
+     * Decodes the header of a posting list, and returns the pointer past it.
+     *
+     * A posting list starts with the number of postings `n`. Because lists are never empty,
+     * `n = 0` marks an extended header, in which it is preceded by the posting list flags, by the
+     * codec tag if the `CODEC_TAG` flag is set, and by the scorer fingerprint if the
+     * `BLOCK_MAX_SCORER` flag is set. The codec tag and the scorer are 0 if not present.
+     */
+    inline auto decode_posting_list_header(
+        std::uint8_t const* data,
+        std::uint32_t& n,
+        std::uint32_t& flags,
+        std::uint32_t& codec_tag,
+        std::uint32_t& scorer
+    ) -> std::uint8_t const* {
+        data = TightVariableByte::decode(data, &n, 1);
+        flags = 0;
+        codec_tag = 0;
+        scorer = 0;
+        if (n == 0) {
+            data = TightVariableByte::decode(data, &flags, 1);
+            if ((flags & CODEC_TAG) != 0U) {
+                data = TightVariableByte::decode(data, &codec_tag, 1);
+            }
+            if ((flags & BLOCK_MAX_SCORER) != 0U) {
+                data = TightVariableByte::decode(data, &scorer, 1);
+            }
+            data = TightVariableByte::decode(data, &n, 1);
+        }
+        return data;
+    }
+
+    inline auto decode_posting_list_header(
+        std::uint8_t const* data, std::uint32_t& n, std::uint32_t& flags, std::uint32_t& codec_tag
+    ) -> std::uint8_t const* {
+        std::uint32_t scorer = 0;
+        return decode_posting_list_header(data, n, flags, codec_tag, scorer);
+    }
+
+    inline auto
+    decode_posting_list_header(std::uint8_t const* data, std::uint32_t& n, std::uint32_t& flags)
+        -> std::uint8_t const* {
+        std::uint32_t codec_tag = 0;
+        return decode_posting_list_header(data, n, flags, codec_tag);
+    }
 }  // namespace index::block
 
 enum Profiling : bool { On, Off };
 
+namespace detail {
+    /**
+     * Decoding buffer of a cursor: allocated from the given memory resource at runtime unless
+     * the codec is known statically.
+     */
+    template <typename Codec>
+    struct BlockBuffer {
+        using type = std::pmr::vector<std::uint32_t>;
+
+        [[nodiscard]] static auto make(std::size_t size, std::pmr::memory_resource* resource)
+            -> type {
+            return type(size, resource);
+        }
+    };
+
+    template <StaticBlockCodec Codec>
+    struct BlockBuffer<Codec> {
+        using type = std::array<std::uint32_t, Codec::fixed_block_size>;
+
+        [[nodiscard]] static auto make(std::size_t, std::pmr::memory_resource*) -> type {
+            return type{};
+        }
+    };
+}  // namespace detail
+
 /**
  * Cursor for a block-encoded posting list.
+ *
+ * When a block is decoded, its document ID gaps are turned into absolute document IDs at once
+ * (see `intrinsics::gaps_to_docids`), so that moving within a block is a lookup, and `next_geq`
+ * within a block is a vectorized search.
+ *
+ * If the posting list has a skip layer (see `index::block::SKIP_LAYER`), it holds the maximum
+ * document ID of every `SKIP_INTERVAL` consecutive blocks, which `next_geq` uses to skip over
+ * long stretches of block maxima without reading them.
+ *
+ * If the list is dense (see `index::block::DENSE`), the document IDs of a block are extracted from
+ * the bitmap instead of being decoded, and the bitmap itself is exposed by `docid_bitmap`.
+ *
+ * If the list has block max scores (see `index::block::BLOCK_MAX_SCORES`), they are read with
+ * `block_max_next_geq`, `block_max_docid`, and `block_max_score`, whose position is independent
+ * of that of the postings, as with a WAND data enumerator. The blocks are the posting blocks.
+ *
+ * By default, blocks are decoded through the `BlockCodec` interface, i.e., the codec is resolved
+ * at runtime. If `Codec` is a `StaticBlockCodec`, the decoding calls are resolved at compile time,
+ * the block size is a constant, and the block buffers are fixed-size arrays. Otherwise, the
+ * buffers are allocated from the memory resource passed to the constructor, such as the arena of
+ * a `QueryContext`.
  */
-template <Profiling profiling = Profiling::Off>
+template <Profiling profiling = Profiling::Off, typename Codec = BlockCodec>
+    requires(std::same_as<Codec, BlockCodec> || StaticBlockCodec<Codec>)
 class BlockInvertedIndexCursor {
   public:
     BlockInvertedIndexCursor(
-        BlockCodec const* block_codec,
+        Codec const* block_codec,
         std::uint8_t const* data,
         std::uint64_t universe,
-        [[maybe_unused]] std::uint32_t term_id
+        [[maybe_unused]] std::uint32_t term_id,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource()
     )
-        : m_base(TightVariableByte::decode(data, &m_n, 1)),
+        : m_base(index::block::decode_posting_list_header(data, m_n, m_flags)),
           m_blocks(ceil_div(m_n, block_codec->block_size())),
           m_block_maxs(m_base),
           m_block_endpoints(m_block_maxs + 4 * m_blocks),
-          m_blocks_data(m_block_endpoints + 4 * (m_blocks - 1)),
+          m_skip_count(
+              (m_flags & index::block::SKIP_LAYER) != 0U
+                  ? ceil_div(m_blocks, index::block::SKIP_INTERVAL)
+                  : 0
+          ),
+          m_skips(m_block_endpoints + 4 * (m_blocks - 1)),
+          m_block_scores(m_skips + 4 * m_skip_count),
+          m_bitmap_words(
+              (m_flags & index::block::DENSE) != 0U
+                  ? index::block::dense_bitmap_words(block_max(m_blocks - 1))
+                  : 0
+          ),
+          m_bitmap(
+              m_block_scores
+              + ((m_flags & index::block::BLOCK_MAX_SCORES) != 0U ? 4 + m_blocks : 0)
+          ),
+          m_blocks_data(m_bitmap + 8 * m_bitmap_words),
           m_universe(universe),
+          m_docs_buf(detail::BlockBuffer<Codec>::make(block_codec->block_size(), resource)),
+          m_freqs_buf(detail::BlockBuffer<Codec>::make(block_codec->block_size(), resource)),
           m_block_codec(block_codec),
           m_block_size(block_codec->block_size()) {
         static_assert((
             concepts::FrequencyPostingCursor<BlockInvertedIndexCursor>
             && concepts::SortedPostingCursor<BlockInvertedIndexCursor>
+            && concepts::BlockPostingCursor<BlockInvertedIndexCursor>
+            && concepts::DensePostingCursor<BlockInvertedIndexCursor>
         ));
 
         if constexpr (profiling == Profiling::On) {
             m_profiler = block_profiler::open_list(term_id, m_blocks);
         }
+        if (has_block_max_scores()) {
+            std::memcpy(&m_max_score, m_block_scores, sizeof(m_max_score));
+            m_block_score_step = index::block::block_max_score_step(m_max_score);
+        }
 
-        m_docs_buf.resize(m_block_size);
-        m_freqs_buf.resize(m_block_size);
         reset();
     }
 
-    void reset() { decode_docs_block(0); }
+    void reset() {
+        decode_docs_block(0);
+        m_max_block = 0;
+    }
 
     void PISA_ALWAYSINLINE next() {
         ++m_pos_in_block;
@@ -75,7 +257,7 @@ class BlockInvertedIndexCursor {
             }
             decode_docs_block(m_cur_block + 1);
         } else {
-            m_cur_docid += m_docs_buf[m_pos_in_block] + 1;
+            m_cur_docid = m_docs_buf[m_pos_in_block];
         }
     }
 
@@ -88,35 +270,61 @@ class BlockInvertedIndexCursor {
      */
     void PISA_ALWAYSINLINE next_geq(uint64_t lower_bound) {
         if (lower_bound > m_cur_block_max) [[unlikely]] {
-            // binary search seems to perform worse here
             if (lower_bound > block_max(m_blocks - 1)) {
                 m_cur_docid = m_universe;
                 return;
             }
-
-            uint64_t block = m_cur_block + 1;
-            while (block_max(block) < lower_bound) {
-                ++block;
-            }
-
-            decode_docs_block(block);
+            decode_docs_block(find_block(m_cur_block + 1, lower_bound));
         }
 
-        while (docid() < lower_bound) {
-            m_cur_docid += m_docs_buf[++m_pos_in_block] + 1;
+        if (docid() < lower_bound) {
+            // The last document ID in the block is at least `lower_bound`, so one is found.
+            m_pos_in_block += intrinsics::find_geq(
+                m_docs_buf.data() + m_pos_in_block, m_cur_block_size - m_pos_in_block, lower_bound
+            );
             assert(m_pos_in_block < m_cur_block_size);
+            m_cur_docid = m_docs_buf[m_pos_in_block];
         }
     }
 
     void PISA_ALWAYSINLINE move(uint64_t pos) {
         assert(pos >= position());
-        uint64_t block = pos / m_block_size;
+        uint64_t block = pos / block_size();
         if (block != m_cur_block) [[unlikely]] {
             decode_docs_block(block);
         }
-        while (position() < pos) {
-            m_cur_docid += m_docs_buf[++m_pos_in_block] + 1;
+        m_pos_in_block = pos - block * block_size();
+        m_cur_docid = m_docs_buf[m_pos_in_block];
+    }
+
+    /**
+     * Writes the postings from the current position to the end of the current block, stopping
+     * before `max_docid` or when either output is full, and moves past them.
+     * See `concepts::BlockPostingCursor`.
+     */
+    auto PISA_ALWAYSINLINE
+    read_block(std::span<DocId> docids, std::span<std::uint32_t> freqs, DocId max_docid)
+        -> std::size_t {
+        std::size_t limit = std::min<std::size_t>(
+            {docids.size(), freqs.size(), m_cur_block_size - m_pos_in_block}
+        );
+        if (m_cur_docid >= max_docid || m_cur_docid >= m_universe || limit == 0) {
+            return 0;
+        }
+        if (!m_freqs_decoded) {
+            decode_freqs_block();
+        }
+        auto const* block_docids = m_docs_buf.data() + m_pos_in_block;
+        if (block_docids[limit - 1] >= max_docid) {
+            limit = intrinsics::find_geq(block_docids, limit, max_docid);
+        }
+        for (std::size_t idx = 0; idx < limit; ++idx) {
+            docids[idx] = block_docids[idx];
+            freqs[idx] = m_freqs_buf[m_pos_in_block + idx] + 1;
         }
+        m_pos_in_block += limit - 1;
+        next();
+        return limit;
     }
 
     uint64_t docid() const { return m_cur_docid; }
@@ -130,26 +338,66 @@ class BlockInvertedIndexCursor {
 
     uint64_t PISA_ALWAYSINLINE value() { return freq(); }
 
-    uint64_t position() const { return m_cur_block * m_block_size + m_pos_in_block; }
+    uint64_t position() const { return m_cur_block * block_size() + m_pos_in_block; }
 
     uint64_t size() const noexcept { return m_n; }
 
     uint64_t num_blocks() const { return m_blocks; }
 
+    [[nodiscard]] auto has_block_max_scores() const noexcept -> bool {
+        return (m_flags & index::block::BLOCK_MAX_SCORES) != 0U;
+    }
+
+    /** Returns the maximum score of the list; see `index::block::BLOCK_MAX_SCORES`. */
+    [[nodiscard]] auto max_score() const noexcept -> float { return m_max_score; }
+
+    /** Returns the maximum document ID of the current block-max block. */
+    [[nodiscard]] PISA_ALWAYSINLINE auto block_max_docid() const -> std::uint32_t {
+        return block_max(m_max_block);
+    }
+
+    /** Returns an upper bound of the scores of the current block-max block. */
+    [[nodiscard]] PISA_ALWAYSINLINE auto block_max_score() const -> float {
+        return static_cast<float>(m_block_scores[4 + m_max_block]) * m_block_score_step;
+    }
+
+    /**
+     * Moves the block-max position to the first block with the maximum document ID of at least
+     * `docid`, or to the last block if there is none. It never moves backwards.
+     */
+    void PISA_ALWAYSINLINE block_max_next_geq(std::uint32_t docid) {
+        if (docid <= block_max_docid()) {
+            return;
+        }
+        if (docid > block_max(m_blocks - 1)) {
+            m_max_block = m_blocks - 1;
+            return;
+        }
+        m_max_block = find_block(m_max_block + 1, docid);
+    }
+
+    /** Returns the document ID bitmap if the list is dense, and an empty bitmap otherwise. */
+    [[nodiscard]] auto docid_bitmap() const -> DocidBitmap {
+        return DocidBitmap(m_bitmap, m_bitmap_words);
+    }
+
     uint64_t stats_freqs_size() const {
         // XXX rewrite in terms of get_blocks()
         uint64_t bytes = 0;
         uint8_t const* ptr = m_blocks_data;
-        static const uint64_t block_size = m_block_size;
+        uint64_t const block_size = this->block_size();
         std::vector<uint32_t> buf(block_size);
         for (size_t b = 0; b < m_blocks; ++b) {
             uint32_t cur_block_size =
                 ((b + 1) * block_size <= size()) ? block_size : (size() % block_size);
 
             uint32_t cur_base = (b != 0U ? block_max(b - 1) : uint32_t(-1)) + 1;
-            uint8_t const* freq_ptr = m_block_codec->decode(
-                ptr, buf.data(), block_max(b) - cur_base - (cur_block_size - 1), cur_block_size
-            );
+            uint8_t const* freq_ptr = ptr;
+            if (m_bitmap_words == 0) {
+                freq_ptr = m_block_codec->decode(
+                    ptr, buf.data(), block_max(b) - cur_base - (cur_block_size - 1), cur_block_size
+                );
+            }
             ptr = m_block_codec->decode(freq_ptr, buf.data(), uint32_t(-1), cur_block_size);
             bytes += ptr - freq_ptr;
         }
@@ -186,11 +434,15 @@ class BlockInvertedIndexCursor {
         }
     };
 
+    /** Returns the encoded blocks; dense lists have no encoded document ID blocks. */
     std::vector<block_data> get_blocks() {
+        if (m_bitmap_words > 0) {
+            throw std::logic_error("the blocks of a dense posting list hold no document IDs");
+        }
         std::vector<block_data> blocks;
 
         uint8_t const* ptr = m_blocks_data;
-        static const uint64_t block_size = m_block_size;
+        uint64_t const block_size = this->block_size();
         std::vector<uint32_t> buf(block_size);
         for (size_t b = 0; b < m_blocks; ++b) {
             blocks.emplace_back();
@@ -219,21 +471,64 @@ class BlockInvertedIndexCursor {
     }
 
   private:
+    [[nodiscard]] PISA_ALWAYSINLINE auto block_size() const noexcept -> uint64_t {
+        if constexpr (StaticBlockCodec<Codec>) {
+            return Codec::fixed_block_size;
+        } else {
+            return m_block_size;
+        }
+    }
+
     uint32_t block_max(uint32_t block) const { return ((uint32_t const*)m_block_maxs)[block]; }
 
+    /**
+     * Returns the first block, starting at `first`, with the maximum document ID of at least
+     * `lower_bound`; such block must exist.
+     *
+     * The blocks right after `first` are checked first, as short jumps are the most common.
+     * Then, the skip layer, if present, narrows down the search to `SKIP_INTERVAL` blocks.
+     */
+    [[nodiscard]] PISA_ALWAYSINLINE auto
+    find_block(std::uint32_t first, std::uint32_t lower_bound) const -> std::uint32_t {
+        constexpr std::uint32_t short_jump = 8;
+        auto const* block_maxs = reinterpret_cast<std::uint32_t const*>(m_block_maxs);
+        std::uint32_t last = m_blocks;
+        if (m_skip_count > 0 && last - first > short_jump) {
+            auto pos = intrinsics::find_geq(block_maxs + first, short_jump, lower_bound);
+            if (pos < short_jump) {
+                return first + pos;
+            }
+            first += short_jump;
+            auto const* skips = reinterpret_cast<std::uint32_t const*>(m_skips);
+            std::uint32_t group = first / index::block::SKIP_INTERVAL;
+            group += intrinsics::find_geq(skips + group, m_skip_count - group, lower_bound);
+            first = std::max(first, group * index::block::SKIP_INTERVAL);
+            last = std::min(last, (group + 1) * index::block::SKIP_INTERVAL);
+        }
+        return first + intrinsics::find_geq(block_maxs + first, last - first, lower_bound);
+    }
+
     void PISA_NOINLINE decode_docs_block(uint64_t block) {
-        static const uint64_t block_size = m_block_size;
+        uint64_t const block_size = this->block_size();
         uint32_t endpoint = block != 0U ? ((uint32_t const*)m_block_endpoints)[block - 1] : 0;
         uint8_t const* block_data = m_blocks_data + endpoint;
         m_cur_block_size = ((block + 1) * block_size <= size()) ? block_size : (size() % block_size);
         uint32_t cur_base = (block != 0U ? block_max(block - 1) : uint32_t(-1)) + 1;
         m_cur_block_max = block_max(block);
-        m_freqs_block_data = m_block_codec->decode(
-            block_data, m_docs_buf.data(), m_cur_block_max - cur_base - (m_cur_block_size - 1), m_cur_block_size
-        );
-        intrinsics::prefetch(m_freqs_block_data);
+        if (m_bitmap_words > 0) {
+            docid_bitmap().decode(cur_base, m_cur_block_size, m_docs_buf.data());
+            m_freqs_block_data = block_data;
+        } else {
+            m_freqs_block_data = m_block_codec->decode(
+                block_data,
+                m_docs_buf.data(),
+                m_cur_block_max - cur_base - (m_cur_block_size - 1),
+                m_cur_block_size
+            );
+            intrinsics::prefetch(m_freqs_block_data);
 
-        m_docs_buf[0] += cur_base;
+            intrinsics::gaps_to_docids(m_docs_buf.data(), m_cur_block_size, cur_base);
+        }
 
         m_cur_block = block;
         m_pos_in_block = 0;
@@ -258,10 +553,16 @@ class BlockInvertedIndexCursor {
     }
 
     uint32_t m_n{0};
+    uint32_t m_flags{0};
     uint8_t const* m_base;
     uint32_t m_blocks;
     uint8_t const* m_block_maxs;
     uint8_t const* m_block_endpoints;
+    uint32_t m_skip_count;
+    uint8_t const* m_skips;
+    uint8_t const* m_block_scores;
+    std::size_t m_bitmap_words;
+    uint8_t const* m_bitmap;
     uint8_t const* m_blocks_data;
     uint64_t m_universe;
 
@@ -270,13 +571,16 @@ class BlockInvertedIndexCursor {
     uint32_t m_cur_block_max{0};
     uint32_t m_cur_block_size{0};
     uint32_t m_cur_docid{0};
+    uint32_t m_max_block{0};
+    float m_max_score{0.0};
+    float m_block_score_step{0.0};
 
     uint8_t const* m_freqs_block_data{nullptr};
     bool m_freqs_decoded{false};
 
-    std::vector<uint32_t> m_docs_buf;
-    std::vector<uint32_t> m_freqs_buf;
-    BlockCodec const* m_block_codec;
+    typename detail::BlockBuffer<Codec>::type m_docs_buf{};
+    typename detail::BlockBuffer<Codec>::type m_freqs_buf{};
+    Codec const* m_block_codec;
     std::size_t m_block_size;
     block_profiler::counter_type* m_profiler = nullptr;
 };
@@ -299,6 +603,31 @@ class BlockInvertedIndex {
   protected:
     void check_term_range(std::size_t term_id) const;
 
+    /**
+     * Collects the size statistics of `index`, whose cursors are used to find the sizes of the
+     * frequency blocks.
+     */
+    template <typename Index>
+    [[nodiscard]] static auto collect_size_stats(Index& index) -> SizeStats {
+        SizeStats stats;
+        stats.size_tree = mapper::size_tree_of(index);
+        for (auto const& node: stats.size_tree->children) {
+            if (node->name == "m_lists") {
+                stats.docs = node->size;
+            }
+        }
+        for (std::size_t term_id = 0; term_id < index.size(); ++term_id) {
+            stats.freqs += index[term_id].stats_freqs_size();
+        }
+        stats.docs -= stats.freqs;
+        return stats;
+    }
+
+    /**
+     * Returns a pointer to the beginning of the encoded posting list of the given term.
+     */
+    [[nodiscard]] auto posting_list_data(std::size_t term_id) const -> std::uint8_t const*;
+
     friend class index::block::InMemoryPostingAccumulator;
     friend class index::block::StreamPostingAccumulator;
 
@@ -317,6 +646,10 @@ class BlockInvertedIndex {
 
     [[nodiscard]] auto operator[](std::size_t term_id) const -> BlockInvertedIndexCursor<>;
 
+    /** Returns a cursor whose decoding buffers are allocated from `resource`. */
+    [[nodiscard]] auto cursor(std::size_t term_id, std::pmr::memory_resource* resource) const
+        -> BlockInvertedIndexCursor<>;
+
     /**
      * The size of the index, i.e., the number of terms (posting lists).
      */
@@ -329,6 +662,19 @@ class BlockInvertedIndex {
 
     void warmup(std::size_t term_id) const;
 
+    /**
+     * Returns true if the posting lists store block max scores (see
+     * `index::block::BLOCK_MAX_SCORES`); an index has them in either all or none of its lists.
+     */
+    [[nodiscard]] auto has_block_max_scores() const -> bool;
+
+    /**
+     * Returns the fingerprint of the scorer the block max scores were computed with (see
+     * `scorer_fingerprint`), or 0 if the index has no block max scores or does not record it.
+     * The block max scores are only upper bounds of the scores of this scorer.
+     */
+    [[nodiscard]] auto block_max_scorer() const -> std::uint32_t;
+
     [[nodiscard]] auto size_stats() -> SizeStats;
 };
 
@@ -342,14 +688,61 @@ class ProfilingBlockInvertedIndex: public BlockInvertedIndex {
         -> BlockInvertedIndexCursor<Profiling::On>;
 };
 
+/**
+ * Block inverted index with the codec fixed at compile time.
+ *
+ * The data format is exactly the same as that of `BlockInvertedIndex`, but the returned cursors
+ * decode blocks with direct (non-virtual) calls to `Codec`, which lets the compiler specialize
+ * the query processing loop for the codec. Use `run_for_index` to resolve the type once
+ * from the encoding name.
+ */
+template <StaticBlockCodec Codec>
+class StaticBlockInvertedIndex: public BlockInvertedIndex {
+    std::shared_ptr<Codec> m_codec;
+
+    StaticBlockInvertedIndex(MemorySource source, std::shared_ptr<Codec> codec)
+        : BlockInvertedIndex(std::move(source), codec), m_codec(std::move(codec)) {}
+
+  public:
+    using document_enumerator = BlockInvertedIndexCursor<Profiling::Off, Codec>;
+
+    explicit StaticBlockInvertedIndex(MemorySource source)
+        : StaticBlockInvertedIndex(std::move(source), std::make_shared<Codec>()) {
+        static_assert(concepts::SortedInvertedIndex<StaticBlockInvertedIndex, document_enumerator>);
+    }
+
+    [[nodiscard]] auto operator[](std::size_t term_id) const -> document_enumerator {
+        return document_enumerator(m_codec.get(), posting_list_data(term_id), num_docs(), term_id);
+    }
+
+    /** Cursors of a static codec use fixed-size buffers, so `resource` is not used. */
+    [[nodiscard]] auto cursor(std::size_t term_id, std::pmr::memory_resource*) const
+        -> document_enumerator {
+        return (*this)[term_id];
+    }
+};
+
 namespace index::block {
 
+    /**
+     * Encodes a posting list, with a skip layer over the block maxima if `skip_layer` is true
+     * (see `BlockInvertedIndexCursor`), with `codec_tag` in the header if given (see
+     * `CODEC_TAG`), with the document IDs stored as a bitmap if `dense` is true (see
+     * `DENSE`), and with block max scores if the scores of the postings are given (see
+     * `BLOCK_MAX_SCORES`), computed with the scorer of fingerprint `scorer` if given (see
+     * `BLOCK_MAX_SCORER`).
+     */
     void write_posting_list(
         BlockCodec const* codec,
         std::vector<uint8_t>& out,
         std::uint32_t n,
         std::uint32_t const* docs,
-        std::uint32_t const* freqs
+        std::uint32_t const* freqs,
+        bool skip_layer = false,
+        std::optional<std::uint32_t> codec_tag = std::nullopt,
+        bool dense = false,
+        float const* scores = nullptr,
+        std::optional<std::uint32_t> scorer = std::nullopt
     );
 
     class PostingAccumulator {
@@ -357,26 +750,60 @@ namespace index::block {
         BlockCodecPtr m_block_codec;
         std::size_t m_num_docs;
         std::string m_output_filename;
+        bool m_skip_layer;
         bool m_finished = false;
+        std::shared_ptr<HybridCodecSelector const> m_codec_selector;
+        std::optional<double> m_dense_cutoff;
+        std::optional<std::uint32_t> m_block_max_scorer;
+        std::uint32_t m_term_id = 0;
 
       public:
         explicit PostingAccumulator(
-            BlockCodecPtr block_codec, std::size_t num_docs, std::string output_filename
+            BlockCodecPtr block_codec,
+            std::size_t num_docs,
+            std::string output_filename,
+            bool skip_layer = false
         );
 
         virtual ~PostingAccumulator() = default;
 
+        /**
+         * Encodes the next posting list; if `scores` is given, with the block max scores of
+         * the scores of its postings.
+         */
         virtual void accumulate_posting_list(
-            std::size_t n, std::uint32_t const* docs, std::uint32_t const* freqs
+            std::size_t n,
+            std::uint32_t const* docs,
+            std::uint32_t const* freqs,
+            float const* scores = nullptr
         ) = 0;
 
         virtual void finish() = 0;
 
+        /**
+         * Makes the accumulator choose the codec of each posting list with `selector`, instead
+         * of encoding all of them with the block codec.
+         */
+        void select_codecs(std::shared_ptr<HybridCodecSelector const> selector);
+
+        /**
+         * Makes the accumulator store the document IDs of the lists with at least
+         * `cutoff * num_docs` postings as bitmaps (see `DENSE`); no list is dense if not set.
+         */
+        void dense_cutoff(std::optional<double> cutoff);
+
+        /**
+         * Records `scorer` as the fingerprint of the scorer of the block max scores (see
+         * `BLOCK_MAX_SCORER`) in the first posting list.
+         */
+        void block_max_scorer(std::uint32_t scorer);
+
         void write(
             std::vector<uint8_t>& out,
             std::uint32_t n,
             std::uint32_t const* docs,
-            std::uint32_t const* freqs
+            std::uint32_t const* freqs,
+            float const* scores = nullptr
         );
     };
 
@@ -387,11 +814,17 @@ namespace index::block {
 
       public:
         explicit InMemoryPostingAccumulator(
-            BlockCodecPtr block_codec, std::size_t num_docs, std::string output_filename
+            BlockCodecPtr block_codec,
+            std::size_t num_docs,
+            std::string output_filename,
+            bool skip_layer = false
         );
 
         void accumulate_posting_list(
-            std::uint64_t n, std::uint32_t const* docs, std::uint32_t const* freqs
+            std::uint64_t n,
+            std::uint32_t const* docs,
+            std::uint32_t const* freqs,
+            float const* scores = nullptr
         ) override;
 
         void finish() override;
@@ -407,11 +840,17 @@ namespace index::block {
 
       public:
         explicit StreamPostingAccumulator(
-            BlockCodecPtr block_codec, std::size_t num_docs, std::string output_filename
+            BlockCodecPtr block_codec,
+            std::size_t num_docs,
+            std::string output_filename,
+            bool skip_layer = false
         );
 
         void accumulate_posting_list(
-            std::uint64_t n, std::uint32_t const* docs, std::uint32_t const* freqs
+            std::uint64_t n,
+            std::uint32_t const* docs,
+            std::uint32_t const* freqs,
+            float const* scores = nullptr
         ) override;
 
         void finish() override;
@@ -427,6 +866,10 @@ class BlockIndexBuilder {
     std::optional<QuantizingScorer> m_quantizing_scorer;
     bool m_check = false;
     bool m_in_memory = false;
+    bool m_skip_layer = false;
+    std::shared_ptr<index::block::HybridCodecSelector const> m_codec_selector;
+    std::optional<double> m_dense_cutoff;
+    std::unique_ptr<IndexScorer> m_block_max_scorer;
 
     auto resolve_accumulator(std::size_t num_docs, std::string const& index_path)
         -> std::unique_ptr<index::block::PostingAccumulator>;
@@ -435,6 +878,31 @@ class BlockIndexBuilder {
     BlockIndexBuilder(BlockCodecPtr block_codec, ScorerParams scorer_params);
     auto check(bool check) -> BlockIndexBuilder&;
     auto in_memory(bool in_mem) -> BlockIndexBuilder&;
+    auto skip_layer(bool skip_layer) -> BlockIndexBuilder&;
+
+    /**
+     * Builds a `HybridBlockInvertedIndex`, choosing the codec of each posting list with
+     * `selector`.
+     */
+    auto hybrid(std::shared_ptr<index::block::HybridCodecSelector const> selector)
+        -> BlockIndexBuilder&;
+
+    /**
+     * Stores the document IDs of the posting lists with at least `cutoff * num_docs` postings as
+     * bitmaps (see `index::block::DENSE`).
+     */
+    auto dense_cutoff(std::optional<double> cutoff) -> BlockIndexBuilder&;
+
+    /**
+     * Stores the block max scores in the posting lists (see `index::block::BLOCK_MAX_SCORES`),
+     * computed with the scorer of the builder, whose statistics are taken from `wdata`. If the
+     * index is quantized, the quantized scores are used instead.
+     */
+    template <typename WandData>
+    auto block_max_scores(WandData const& wdata) -> BlockIndexBuilder& {
+        m_block_max_scorer = scorer::from_params(m_scorer_params, wdata);
+        return *this;
+    }
 
     template <typename WandData>
     auto quantize(Size bits, WandData const& wdata) -> BlockIndexBuilder& {
@@ -451,6 +919,7 @@ class BlockIndexBuilder {
         index::block::PostingAccumulator* accumulator
     ) {
         std::size_t size = documents.size();
+        std::vector<float> scores;
         if (m_quantizing_scorer.has_value()) {
             auto term_scorer = m_quantizing_scorer->term_scorer(term_id);
             std::vector<std::uint32_t> quants;
@@ -461,9 +930,27 @@ class BlockIndexBuilder {
                 quants.push_back(quant_score);
             }
             assert(quants.size() == size);
-            accumulator->accumulate_posting_list(size, documents.begin(), &quants[0]);
+            if (m_block_max_scorer != nullptr) {
+                scores.assign(quants.begin(), quants.end());
+            }
+            accumulator->accumulate_posting_list(
+                size, documents.begin(), &quants[0], scores.empty() ? nullptr : scores.data()
+            );
         } else {
-            accumulator->accumulate_posting_list(size, documents.begin(), frequencies.begin());
+            if (m_block_max_scorer != nullptr) {
+                auto term_scorer = m_block_max_scorer->term_scorer(term_id);
+                for (size_t pos = 0; pos < size; ++pos) {
+                    scores.push_back(
+                        term_scorer(*(documents.begin() + pos), *(frequencies.begin() + pos))
+                    );
+                }
+            }
+            accumulator->accumulate_posting_list(
+                size,
+                documents.begin(),
+                frequencies.begin(),
+                scores.empty() ? nullptr : scores.data()
+            );
         }
     }
 
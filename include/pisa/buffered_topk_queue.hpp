@@ -0,0 +1,220 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "topk_queue.hpp"
+#include "type_alias.hpp"
+#include "util/intrinsics.hpp"
+
+namespace pisa {
+
+/// Top-k document queue optimized for inserting many candidates at once.
+///
+/// Instead of maintaining a heap, the queue appends every entry above the threshold to a buffer
+/// of `buffer_capacity()` entries. Whenever the buffer fills up, it is compacted: `nth_element`
+/// keeps the `k` highest scored entries and the threshold is raised to the lowest of them. This
+/// avoids the sifting of a binary heap, which dominates when a large number of documents is
+/// collected, e.g., from the accumulators of term-at-a-time processing.
+///
+/// `insert_batch()` compares scores against the threshold with SIMD instructions, so that only
+/// the candidates that would enter the queue are touched individually.
+///
+/// The threshold contract is the same as that of `topk_queue`: an entry enters if its score is
+/// greater than `effective_threshold()`. However, the threshold is only raised at compaction;
+/// therefore, before `finalize()` is called, `size()` may exceed `capacity()`, and the threshold
+/// may be lower than the one of a `topk_queue` with the same entries. Documents with equal scores
+/// at the k-th position may be resolved differently than by `topk_queue`.
+class buffered_topk_queue {
+  public:
+    using entry_type = topk_queue::entry_type;
+
+    /// Constructs a queue with the given initial threshold; see `topk_queue`.
+    explicit buffered_topk_queue(std::size_t k, Score initial_threshold = 0.0F) {
+        reset(k, initial_threshold);
+    }
+
+    /// Inserts an entry if its score is above the threshold, and returns `true` if inserted.
+    auto insert(Score score, DocId docid = 0) -> bool {
+        if (not would_enter(score)) [[unlikely]] {
+            return false;
+        }
+        m_q.emplace_back(score, docid);
+        if (m_q.size() >= m_buffer_capacity) [[unlikely]] {
+            compact();
+        }
+        return true;
+    }
+
+    /// Inserts entries `(scores[i], first_docid + i)` whose scores are above the threshold.
+    ///
+    /// Returns the number of inserted entries.
+    auto insert_batch(std::span<Score const> scores, DocId first_docid = 0) -> std::size_t {
+        std::size_t inserted = 0;
+        std::size_t pos = 0;
+        Score threshold = effective_threshold();
+#if defined(__AVX__)
+        __m256 bound = _mm256_set1_ps(threshold);
+        for (; pos + 8 <= scores.size(); pos += 8) {
+            __m256 values = _mm256_loadu_ps(scores.data() + pos);
+            auto mask = static_cast<std::uint64_t>(
+                _mm256_movemask_ps(_mm256_cmp_ps(values, bound, _CMP_GT_OQ))
+            );
+            if (mask == 0) [[likely]] {
+                continue;
+            }
+            inserted += append_masked(scores.data() + pos, mask, first_docid + pos);
+            if (m_q.size() >= m_buffer_capacity) [[unlikely]] {
+                compact();
+                threshold = effective_threshold();
+                bound = _mm256_set1_ps(threshold);
+            }
+        }
+#elif defined(__SSE__)
+        __m128 bound = _mm_set1_ps(threshold);
+        for (; pos + 4 <= scores.size(); pos += 4) {
+            __m128 values = _mm_loadu_ps(scores.data() + pos);
+            auto mask = static_cast<std::uint64_t>(_mm_movemask_ps(_mm_cmpgt_ps(values, bound)));
+            if (mask == 0) [[likely]] {
+                continue;
+            }
+            inserted += append_masked(scores.data() + pos, mask, first_docid + pos);
+            if (m_q.size() >= m_buffer_capacity) [[unlikely]] {
+                compact();
+                threshold = effective_threshold();
+                bound = _mm_set1_ps(threshold);
+            }
+        }
+#endif
+        for (; pos < scores.size(); ++pos) {
+            if (scores[pos] > threshold) {
+                insert(scores[pos], first_docid + pos);
+                threshold = effective_threshold();
+                ++inserted;
+            }
+        }
+        return inserted;
+    }
+
+    /// Checks if an entry with the given score would be inserted to the queue, according
+    /// to the current threshold.
+    [[nodiscard]] auto would_enter(Score score) const noexcept -> bool {
+        return score > effective_threshold();
+    }
+
+    /// Shares the threshold with other queues processing the same query; see `topk_queue`.
+    void share_threshold(SharedThreshold& threshold) noexcept { m_shared_threshold = &threshold; }
+
+    /// Keeps the `k` highest scored entries and sorts them in the descending score order.
+    void finalize() {
+        compact();
+        std::sort(m_q.begin(), m_q.end(), [](auto const& lhs, auto const& rhs) {
+            return lhs.first > rhs.first;
+        });
+        auto last = std::find_if(m_q.begin(), m_q.end(), [](auto const& entry) {
+            return entry.first <= 0.0F;
+        });
+        m_q.erase(last, m_q.end());
+    }
+
+    /// Returns a reference to the buffered entries, sorted after calling `finalize()`.
+    [[nodiscard]] auto topk() const noexcept -> std::vector<entry_type> const& { return m_q; }
+
+    /// Returns the score of the `k`-th document as of the last compaction, or 0.0 if fewer than
+    /// `k` documents were kept at that point.
+    [[nodiscard]] auto true_threshold() const noexcept -> Score { return m_true_threshold; }
+
+    /// Returns the threshold set at the start (by default 0.0).
+    [[nodiscard]] auto initial_threshold() const noexcept -> Score { return m_initial_threshold; }
+
+    /// Returns the maximum of `true_threshold()` and `initial_threshold()`, and of the shared
+    /// threshold, if any.
+    [[nodiscard]] auto effective_threshold() const noexcept -> Score {
+        if (m_shared_threshold != nullptr) [[unlikely]] {
+            return std::max(m_effective_threshold, m_shared_threshold->load());
+        }
+        return m_effective_threshold;
+    }
+
+    /// Returns `true` if no documents have been missed up to this point; see `topk_queue`.
+    [[nodiscard]] auto is_safe() const noexcept -> bool {
+        return m_effective_threshold >= m_initial_threshold;
+    }
+
+    /// Empties the queue and sets it up for `k` entries and the given initial threshold, keeping
+    /// the allocated storage.
+    void reset(std::size_t k, Score initial_threshold = 0.0F) {
+        m_k = k;
+        m_buffer_capacity = std::max(2 * k, min_buffer_capacity);
+        m_initial_threshold = initial_threshold;
+        m_effective_threshold = std::nextafter(m_initial_threshold, 0.0F);
+        m_true_threshold = 0.0F;
+        m_shared_threshold = nullptr;
+        m_q.clear();
+        m_q.reserve(m_buffer_capacity + batch_slack);
+    }
+
+    /// The maximum number of entries returned after `finalize()`.
+    [[nodiscard]] auto capacity() const noexcept -> std::size_t { return m_k; }
+
+    /// The number of entries in the buffer before it is compacted.
+    [[nodiscard]] auto buffer_capacity() const noexcept -> std::size_t {
+        return m_buffer_capacity;
+    }
+
+    /// The current number of buffered entries.
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return m_q.size(); }
+
+  private:
+    constexpr static std::size_t min_buffer_capacity = 64;
+    /// The most entries a single SIMD comparison can append before the buffer is compacted.
+    constexpr static std::size_t batch_slack = 8;
+
+    /// Appends the entries selected by the bits of `mask`; returns the number of entries.
+    auto append_masked(Score const* scores, std::uint64_t mask, std::size_t first_docid)
+        -> std::size_t {
+        std::size_t count = 0;
+        unsigned long idx;
+        while (intrinsics::bsf64(&idx, mask)) {
+            m_q.emplace_back(scores[idx], static_cast<DocId>(first_docid + idx));
+            mask &= mask - 1;
+            ++count;
+        }
+        return count;
+    }
+
+    /// Drops all but the `k` highest scored entries, and raises the threshold if there are `k`.
+    void compact() {
+        if (m_q.size() < m_k || m_k == 0) {
+            if (m_k == 0) {
+                m_q.clear();
+            }
+            return;
+        }
+        auto kth = std::next(m_q.begin(), static_cast<std::ptrdiff_t>(m_k - 1));
+        std::nth_element(m_q.begin(), kth, m_q.end(), [](auto const& lhs, auto const& rhs) {
+            return lhs.first > rhs.first;
+        });
+        m_q.resize(m_k);
+        m_true_threshold = kth->first;
+        if (m_true_threshold > m_effective_threshold) {
+            m_effective_threshold = m_true_threshold;
+        }
+        if (m_shared_threshold != nullptr) [[unlikely]] {
+            m_shared_threshold->raise(m_true_threshold);
+        }
+    }
+
+    std::size_t m_k = 0;
+    std::size_t m_buffer_capacity = 0;
+    Score m_initial_threshold = 0.0F;
+    Score m_effective_threshold = 0.0F;
+    Score m_true_threshold = 0.0F;
+    std::vector<entry_type> m_q;
+    SharedThreshold* m_shared_threshold = nullptr;
+};
+
+}  // namespace pisa
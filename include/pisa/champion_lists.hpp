@@ -0,0 +1,127 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include <tbb/parallel_for.h>
+
+#include "binary_freq_collection.hpp"
+#include "memory_source.hpp"
+#include "scorer/scorer.hpp"
+#include "type_alias.hpp"
+
+namespace pisa {
+
+/** A document of a champion list together with its score for the term. */
+struct ChampionEntry {
+    DocId docid;
+    Score score;
+};
+
+/**
+ * Precomputed champion lists: the highest scoring postings of each term.
+ *
+ * The champion list of a term holds up to `depth()` of its postings with the highest scores under
+ * the scorer the lists were built with, in decreasing order of score, ties broken by increasing
+ * document ID. Postings with a zero score are left out, so a list shorter than `depth()` holds all
+ * the postings that can contribute to a score. The lists are only valid for the index and scorer
+ * they were built with.
+ *
+ * The encoded lists consist of a header (magic number, version, depth, and the number of terms and
+ * entries), followed by the position of the first entry of each term (plus one past the last) and
+ * the entries of all terms. The arrays are read directly from the memory source, so the lists can
+ * be memory-mapped and used without parsing.
+ */
+class ChampionLists {
+  public:
+    explicit ChampionLists(MemorySource source);
+
+    /** The maximum number of entries of each list. */
+    [[nodiscard]] auto depth() const noexcept -> std::size_t;
+
+    /** The number of terms. */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /** The champion list of the term, or an empty list if the term is out of range. */
+    [[nodiscard]] auto champions(TermId term) const noexcept -> std::span<ChampionEntry const>;
+
+    /**
+     * Whether the champion list of the term holds its `k` highest scoring postings, i.e., it has
+     * at least `k` entries, or it holds all postings with a non-zero score.
+     */
+    [[nodiscard]] auto covers(TermId term, std::size_t k) const noexcept -> bool;
+
+  private:
+    MemorySource m_source;
+    std::size_t m_depth;
+    std::span<std::uint64_t const> m_term_entries;
+    std::span<ChampionEntry const> m_entries;
+};
+
+/** Collects champion lists and encodes them in the format of `ChampionLists`. */
+class ChampionListsBuilder {
+  public:
+    ChampionListsBuilder(std::size_t depth, std::size_t num_terms);
+
+    /**
+     * Sets the champion list of the term from its scored postings, of which the `depth` highest
+     * scoring ones with a non-zero score are kept. Lists of different terms can be set
+     * concurrently.
+     *
+     * Throws `std::out_of_range` if the term is not less than the number of terms.
+     */
+    void term(TermId term, std::vector<ChampionEntry> postings);
+
+    void encode(std::ostream& out) const;
+
+  private:
+    std::size_t m_depth;
+    std::vector<std::vector<ChampionEntry>> m_lists;
+};
+
+/**
+ * Builds the champion lists of all terms of the collection, scoring the postings with the scorer
+ * defined by `scorer_params` over the WAND data of the collection. Terms are processed in
+ * parallel, and their IDs are their positions in the collection.
+ */
+template <typename Wand>
+[[nodiscard]] auto build_champion_lists(
+    binary_freq_collection const& collection,
+    Wand const& wdata,
+    ScorerParams const& scorer_params,
+    std::size_t depth
+) -> ChampionListsBuilder {
+    std::vector<binary_freq_collection::sequence> sequences(collection.begin(), collection.end());
+    ChampionListsBuilder builder(depth, sequences.size());
+    auto scorer = scorer::from_params(scorer_params, wdata);
+    tbb::parallel_for(std::size_t{0}, sequences.size(), [&](std::size_t term) {
+        auto const& sequence = sequences[term];
+        auto term_scorer = scorer->term_scorer(term);
+        std::vector<ChampionEntry> postings;
+        postings.reserve(sequence.docs.size());
+        auto freq = sequence.freqs.begin();
+        for (auto docid: sequence.docs) {
+            postings.push_back(ChampionEntry{docid, term_scorer(docid, *freq++)});
+        }
+        builder.term(static_cast<TermId>(term), std::move(postings));
+    });
+    return builder;
+}
+
+}  // namespace pisa
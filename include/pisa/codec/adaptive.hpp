@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "codec/block_codec.hpp"
+#include "codec/optpfor.hpp"
+#include "codec/simdbp.hpp"
+#include "codec/streamvbyte.hpp"
+
+namespace pisa {
+
+/**
+ * Block codec that chooses the encoding of each block.
+ *
+ * Every block starts with a one-byte tag, followed by the block encoded with SIMD-BP128,
+ * StreamVByte, OptPForDelta, or, if all values are equal, by the value alone. The latter covers,
+ * e.g., runs of consecutive documents and blocks of frequencies that are all 1.
+ *
+ * By default, the smallest encoding is chosen. With a positive space slack, the fastest to decode
+ * of the encodings taking at most `1 + space_slack` times the space of the smallest one is chosen
+ * instead. The encodings are ordered by decoding speed as in `Encoding`.
+ */
+class AdaptiveBlockCodec final: public BlockCodec {
+    static constexpr std::uint64_t m_block_size = 128;
+
+    static_assert(SimdBpBlockCodec::fixed_block_size == m_block_size);
+    static_assert(StreamVByteBlockCodec::fixed_block_size == m_block_size);
+    static_assert(OptPForBlockCodec::fixed_block_size == m_block_size);
+
+  public:
+    constexpr static std::string_view name = "block_adaptive";
+    constexpr static std::size_t fixed_block_size = m_block_size;
+
+    /** The block encodings, from the fastest to the slowest to decode. */
+    enum class Encoding : std::uint8_t { Constant = 0, SimdBp = 1, StreamVByte = 2, OptPFor = 3 };
+
+    explicit AdaptiveBlockCodec(double space_slack = 0.0);
+    virtual ~AdaptiveBlockCodec() = default;
+
+    void encode(
+        uint32_t const* in, uint32_t sum_of_values, size_t n, std::vector<uint8_t>& out
+    ) const override;
+    uint8_t const*
+    decode(uint8_t const* in, uint32_t* out, uint32_t sum_of_values, size_t n) const override;
+    auto block_size() const noexcept -> std::size_t override { return m_block_size; }
+    auto get_name() const noexcept -> std::string_view override { return name; }
+
+    /** Returns the encoding of the block starting at `in`. */
+    [[nodiscard]] static auto encoding(uint8_t const* in) -> Encoding;
+
+  private:
+    double m_space_slack;
+    SimdBpBlockCodec m_simdbp;
+    StreamVByteBlockCodec m_streamvbyte;
+    OptPForBlockCodec m_optpfor;
+};
+
+}  // namespace pisa
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <numeric>
+
 #include "bit_vector.hpp"
 #include "global_parameters.hpp"
 #include "util/util.hpp"
@@ -47,6 +49,15 @@ struct all_ones_sequence {
             return value_type(m_position, m_position);
         }
 
+        void decode(uint64_t position, uint64_t n, uint64_t* out) {
+            assert(position + n <= size());
+            if (n == 0) {
+                return;
+            }
+            std::iota(out, out + n, position);
+            m_position = position + n - 1;
+        }
+
         uint64_t size() const { return m_universe; }
 
         uint64_t prev_value() const {
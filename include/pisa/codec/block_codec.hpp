@@ -1,8 +1,10 @@
 #pragma once
 
+#include <concepts>
 #include <cstdint>
 #include <memory>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace pisa {
@@ -46,4 +48,16 @@ class BlockCodec {
 
 using BlockCodecPtr = std::shared_ptr<BlockCodec>;
 
+/**
+ * A block codec whose concrete type is known at compile time.
+ *
+ * The codec class must be `final`, so that `decode` and `encode` called through a pointer to it
+ * are resolved statically instead of through the virtual table, and it must expose its block size
+ * as a compile-time constant, so that buffers can be allocated without knowing the object.
+ */
+template <typename C>
+concept StaticBlockCodec = std::derived_from<C, BlockCodec> && std::is_final_v<C> && requires {
+    { C::fixed_block_size } -> std::convertible_to<std::size_t>;
+};
+
 };  // namespace pisa
@@ -7,6 +7,7 @@
 
 #include "global_parameters.hpp"
 #include "util/compiler_attribute.hpp"
+#include "util/intrinsics.hpp"
 #include "util/util.hpp"
 
 namespace pisa {
@@ -227,6 +228,34 @@ struct compact_elias_fano {
             return value();
         }
 
+        // write the values at positions [position, position + n), which must not exceed size(),
+        // to out, leaving the enumerator at position + n - 1 as move() would; the high parts are
+        // read a word at a time and the low parts unpacked with SIMD
+        void decode(uint64_t position, uint64_t n, uint64_t* out) {
+            assert(position + n <= size());
+            if (n == 0) {
+                return;
+            }
+            out[0] = move(position).second;
+            if (n == 1) {
+                return;
+            }
+            m_high_enumerator.decode(n - 1, out + 1);
+            uint64_t high_base = m_of.higher_bits_offset + position + 1;
+            for (uint64_t i = 1; i < n; ++i) {
+                out[i] = (out[i] - high_base - i) << m_of.lower_bits;
+            }
+            intrinsics::or_packed_bits(
+                out + 1,
+                reinterpret_cast<uint8_t const*>(m_bv->data().data()),
+                m_of.lower_bits_offset + (position + 1) * m_of.lower_bits,
+                m_of.lower_bits,
+                n - 1
+            );
+            m_position = position + n - 1;
+            m_value = out[n - 1];
+        }
+
         uint64_t prev_value() const {
             if (m_position == 0) {
                 return 0;
@@ -197,6 +197,25 @@ struct compact_ranked_bitvector {
             return value();
         }
 
+        // write the values at positions [position, position + n), which must not exceed size(),
+        // to out, leaving the enumerator at position + n - 1 as move() would
+        void decode(uint64_t position, uint64_t n, uint64_t* out) {
+            assert(position + n <= size());
+            if (n == 0) {
+                return;
+            }
+            out[0] = move(position).second;
+            if (n == 1) {
+                return;
+            }
+            m_enumerator.decode(n - 1, out + 1);
+            for (uint64_t i = 1; i < n; ++i) {
+                out[i] -= m_of.bits_offset;
+            }
+            m_position = position + n - 1;
+            m_value = out[n - 1];
+        }
+
         uint64_t size() const { return m_of.n; }
 
         uint64_t prev_value() const {
@@ -13,11 +13,12 @@ namespace pisa {
  * Alistair Moffat, Lang Stuiver: Binary Interpolative Coding for Effective Index Compression. Inf.
  * Retr. 3(1): 25-47 (2000)
  */
-class InterpolativeBlockCodec: public BlockCodec {
+class InterpolativeBlockCodec final: public BlockCodec {
     static constexpr std::uint64_t m_block_size = 128;
 
   public:
     constexpr static std::string_view name = "block_interpolative";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~InterpolativeBlockCodec() = default;
 
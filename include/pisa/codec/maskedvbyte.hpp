@@ -12,12 +12,13 @@ namespace pisa {
  * Jeff Plaisance, Nathan Kurz, Daniel Lemire, Vectorized VByte Decoding, International Symposium on
  * Web Algorithms 2015, 2015.
  */
-class MaskedVByteBlockCodec: public BlockCodec {
+class MaskedVByteBlockCodec final: public BlockCodec {
     static constexpr std::uint64_t m_block_size = 128;
     static constexpr std::uint64_t m_overflow = 512;
 
   public:
     constexpr static std::string_view name = "block_maskedvbyte";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~MaskedVByteBlockCodec() = default;
 
@@ -15,7 +15,7 @@ namespace pisa {
  * optimized document ordering. In Proceedings of the 18th international conference on World wide
  * web (WWW '09). ACM, New York, NY, USA, 401-410. DOI: https://doi.org/10.1145/1526709.1526764
  */
-class OptPForBlockCodec: public BlockCodec {
+class OptPForBlockCodec final: public BlockCodec {
     struct Codec: FastPForLib::OPTPFor<4, FastPForLib::Simple16<false>> {
         uint8_t const* force_b = nullptr;
         uint32_t findBestB(const uint32_t* in, uint32_t len);
@@ -25,6 +25,7 @@ class OptPForBlockCodec: public BlockCodec {
 
   public:
     constexpr static std::string_view name = "block_optpfor";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~OptPForBlockCodec() = default;
 
@@ -12,12 +12,13 @@ namespace pisa {
  * Guido Zuccon (Eds.). ACM, New York, NY, USA, Pages 50, 8 pages. DOI:
  * https://doi.org/10.1145/2682862.2682870
  */
-class QmxBlockCodec: public BlockCodec {
+class QmxBlockCodec final: public BlockCodec {
     static constexpr std::uint64_t m_block_size = 128;
     static constexpr std::uint64_t m_overflow = 512;
 
   public:
     constexpr static std::string_view name = "block_qmx";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~QmxBlockCodec() = default;
 
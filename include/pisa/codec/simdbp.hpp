@@ -12,11 +12,12 @@ namespace pisa {
  * Daniel Lemire, Leonid Boytsov: Decoding billions of integers per second through vectorization.
  * Softw., Pract. Exper. 45(1): 1-29 (2015)
  */
-class SimdBpBlockCodec: public BlockCodec {
+class SimdBpBlockCodec final: public BlockCodec {
     static constexpr std::uint64_t m_block_size = 128;
 
   public:
     constexpr static std::string_view name = "block_simdbp";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~SimdBpBlockCodec() = default;
 
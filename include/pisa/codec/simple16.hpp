@@ -11,11 +11,12 @@ namespace pisa {
  * caching in search engines. In Proceedings of the 17th international conference on World Wide Web
  * (WWW '08). ACM, New York, NY, USA, 387-396. DOI: https://doi.org/10.1145/1367497.1367550
  */
-class Simple16BlockCodec: public BlockCodec {
+class Simple16BlockCodec final: public BlockCodec {
     static constexpr std::uint64_t m_block_size = 128;
 
   public:
     constexpr static std::string_view name = "block_simple16";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~Simple16BlockCodec() = default;
 
@@ -10,11 +10,12 @@ namespace pisa {
  * Vo Ngoc Anh, Alistair Moffat: Index compression using 64-bit words. Softw., Pract. Exper. 40(2):
  * 131-147 (2010)
  */
-class Simple8bBlockCodec: public BlockCodec {
+class Simple8bBlockCodec final: public BlockCodec {
     static constexpr std::uint64_t m_block_size = 128;
 
   public:
     constexpr static std::string_view name = "block_simple8b";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~Simple8bBlockCodec() = default;
 
@@ -24,13 +24,14 @@ constexpr std::size_t streamvbyte_max_compressedbytes(std::uint32_t length) {
  * Daniel Lemire, Nathan Kurz, Christoph Rupp: Stream VByte: Faster byte-oriented integer
  * compression. Inf. Process. Lett. 130: 1-6 (2018). DOI: https://doi.org/10.1016/j.ipl.2017.09.011
  */
-class StreamVByteBlockCodec: public BlockCodec {
+class StreamVByteBlockCodec final: public BlockCodec {
     static constexpr std::uint64_t m_block_size = 128;
     static constexpr std::size_t m_max_compressed_bytes =
         pisa::streamvbyte_max_compressedbytes(m_block_size);
 
   public:
     constexpr static std::string_view name = "block_streamvbyte";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~StreamVByteBlockCodec() = default;
 
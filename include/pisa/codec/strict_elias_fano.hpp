@@ -60,6 +60,13 @@ struct strict_elias_fano {
             return value_type(val.first, val.second + val.first);
         }
 
+        void decode(uint64_t position, uint64_t n, uint64_t* out) {
+            m_ef_enum.decode(position, n, out);
+            for (uint64_t i = 0; i < n; ++i) {
+                out[i] += position + i;
+            }
+        }
+
         uint64_t size() const { return m_ef_enum.size(); }
 
         uint64_t prev_value() const {
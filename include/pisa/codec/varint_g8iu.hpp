@@ -16,11 +16,12 @@ namespace pisa {
  * Wenfei Fan, Craig Macdonald, Iadh Ounis, and Ian Ruthven (Eds.). ACM, New York, NY, USA, 317-326.
  * DOI: https://doi.org/10.1145/2063576.2063627
  */
-class VarintG8IUBlockCodec: public BlockCodec {
+class VarintG8IUBlockCodec final: public BlockCodec {
     static const uint64_t m_block_size = 128;
 
   public:
     constexpr static std::string_view name = "block_varintg8iu";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~VarintG8IUBlockCodec() = default;
 
@@ -236,11 +236,12 @@ class VarIntGB {
  * (WSDM '09), Ricardo Baeza-Yates, Paolo Boldi, Berthier Ribeiro-Neto, and B. Barla Cambazoglu
  * (Eds.). ACM, New York, NY, USA, 1-1. DOI: http://dx.doi.org/10.1145/1498759.1498761
  */
-class VarintGbBlockCodec: public BlockCodec {
+class VarintGbBlockCodec final: public BlockCodec {
     static constexpr std::uint64_t m_block_size = 128;
 
   public:
     constexpr static std::string_view name = "block_varintgb";
+    constexpr static std::size_t fixed_block_size = m_block_size;
 
     virtual ~VarintGbBlockCodec() = default;
 
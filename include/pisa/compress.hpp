@@ -8,6 +8,20 @@
 
 namespace pisa {
 
+/**
+ * Options of the `block_hybrid` encoding; see `index::block::HybridCodecSelector`.
+ */
+struct HybridCompressOptions {
+    /** The weight of the expected decoding time, in bytes per nanosecond. */
+    double decode_weight = 0.1;
+
+    /** Query log term frequencies, one per line in term ID order. */
+    std::optional<std::string> term_frequencies_file = std::nullopt;
+
+    /** Decoding time predictors, replacing the default predictors of the codecs they define. */
+    std::optional<std::string> decode_model_file = std::nullopt;
+};
+
 void compress(
     std::string const& input_basename,
     std::optional<std::string> const& wand_data_filename,
@@ -16,7 +30,11 @@ void compress(
     ScorerParams const& scorer_params,
     std::optional<Size> quantization_bits,
     bool check,
-    bool in_memory
+    bool in_memory,
+    bool skip_layer = false,
+    HybridCompressOptions const& hybrid_options = {},
+    std::optional<double> dense_cutoff = std::nullopt,
+    bool block_max_scores = false
 );
 
 }  // namespace pisa
@@ -17,9 +17,12 @@
 #pragma once
 
 #include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <span>
 
 #include "container.hpp"
+#include "docid_bitmap.hpp"
 #include "type_alias.hpp"
 
 namespace pisa::concepts {
@@ -69,6 +72,45 @@ concept SortedPostingCursor = PostingCursor<C>
     cursor.next_geq(docid);
 };
 
+/**
+ * A sorted frequency cursor that can hand out the decoded postings of its current block in bulk.
+ */
+template <typename C>
+concept BlockPostingCursor = FrequencyPostingCursor<C> && SortedPostingCursor<C>
+&& requires(C cursor, std::span<DocId> docids, std::span<std::uint32_t> freqs, DocId max_docid) {
+    /**
+     * Writes the document IDs and frequencies of the postings starting at the current position,
+     * and moves the cursor past them. It stops at the end of the current block, at the first
+     * document ID that is not lower than `max_docid`, or when the output is full, whichever
+     * comes first. Returns the number of written postings; 0 means no posting below `max_docid`
+     * is left.
+     */
+    { cursor.read_block(docids, freqs, max_docid) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * A sorted scored cursor that can score the decoded postings of its current block in bulk.
+ */
+template <typename C>
+concept BlockScoredPostingCursor = ScoredPostingCursor<C> && SortedPostingCursor<C>
+&& requires(C cursor, std::span<DocId> docids, std::span<Score> scores, DocId max_docid) {
+    /**
+     * Same as `BlockPostingCursor::read_block`, except that scores are written instead of
+     * frequencies.
+     */
+    { cursor.score_block(docids, scores, max_docid) } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * A sorted cursor whose document IDs may be stored as a bitmap, which lets intersections with
+ * other dense lists be computed word by word instead of posting by posting.
+ */
+template <typename C>
+concept DensePostingCursor = SortedPostingCursor<C> && requires(C const& cursor) {
+    /** Returns the document ID bitmap of the list, which is empty if the list is not dense. */
+    { cursor.docid_bitmap() } -> std::convertible_to<DocidBitmap>;
+};
+
 /**
  * A posting cursor with max score.
  */
@@ -90,6 +132,23 @@ concept BlockMaxPostingCursor = MaxScorePostingCursor<C> && SortedPostingCursor<
     { cursor.block_max_score() } -> std::convertible_to<Score>;
 };
 
+/**
+ * A sorted cursor over a posting list that stores its own block-max scores, so that they need
+ * not be read from separate WAND data.
+ */
+template <typename C>
+concept EmbeddedBlockMaxPostingCursor = SortedPostingCursor<C>
+&& requires(C cursor, std::uint32_t docid) {
+    /** Returns the max score of the entire list. */
+    { cursor.max_score() } -> std::convertible_to<Score>;
+    /** Returns the max highest docid of the current block. */
+    { cursor.block_max_docid() } -> std::convertible_to<DocId>;
+    /** Returns the max score of the current block. */
+    { cursor.block_max_score() } -> std::convertible_to<Score>;
+    /** Moves to the first block with the max docid of at least `docid`. */
+    cursor.block_max_next_geq(docid);
+};
+
 };  // namespace pisa
 
 // clang-format on
@@ -9,20 +9,22 @@
 
 namespace pisa {
 
-template <typename Cursor, typename Wand>
+template <typename Cursor, typename Wand, typename TermScorerType = TermScorer>
     requires(concepts::FrequencyPostingCursor<Cursor> && concepts::SortedPostingCursor<Cursor>)
-class BlockMaxScoredCursor: public MaxScoredCursor<Cursor> {
+class BlockMaxScoredCursor: public MaxScoredCursor<Cursor, TermScorerType> {
   public:
     using base_cursor_type = Cursor;
 
     BlockMaxScoredCursor(
         Cursor cursor,
-        TermScorer term_scorer,
+        TermScorerType term_scorer,
         float weight,
         float max_score,
         typename Wand::wand_data_enumerator wdata
     )
-        : MaxScoredCursor<Cursor>(std::move(cursor), std::move(term_scorer), weight, max_score),
+        : MaxScoredCursor<Cursor, TermScorerType>(
+            std::move(cursor), std::move(term_scorer), weight, max_score
+        ),
           m_wdata(std::move(wdata)) {
         static_assert(concepts::BlockMaxPostingCursor<BlockMaxScoredCursor>);
     }
@@ -46,20 +48,70 @@ class BlockMaxScoredCursor: public MaxScoredCursor<Cursor> {
     typename Wand::wand_data_enumerator m_wdata;
 };
 
+/**
+ * Block-max scored cursor reading the block-max scores from the posting list itself (see
+ * `concepts::EmbeddedBlockMaxPostingCursor`), instead of moving a WAND data enumerator alongside
+ * it. The blocks are those of the posting list.
+ */
+template <typename Cursor, typename TermScorerType = TermScorer>
+    requires((
+        concepts::FrequencyPostingCursor<Cursor>
+        && concepts::EmbeddedBlockMaxPostingCursor<Cursor>
+    ))
+class EmbeddedBlockMaxScoredCursor: public MaxScoredCursor<Cursor, TermScorerType> {
+  public:
+    using base_cursor_type = Cursor;
+
+    EmbeddedBlockMaxScoredCursor(Cursor cursor, TermScorerType term_scorer, float weight)
+        // The max score is read before the cursor is moved, as it is taken by reference.
+        : EmbeddedBlockMaxScoredCursor(
+            std::move(cursor), std::move(term_scorer), weight, cursor.max_score()
+        ) {
+        static_assert(concepts::BlockMaxPostingCursor<EmbeddedBlockMaxScoredCursor>);
+    }
+    EmbeddedBlockMaxScoredCursor(EmbeddedBlockMaxScoredCursor const&) = delete;
+    EmbeddedBlockMaxScoredCursor(EmbeddedBlockMaxScoredCursor&&) = default;
+    EmbeddedBlockMaxScoredCursor& operator=(EmbeddedBlockMaxScoredCursor const&) = delete;
+    EmbeddedBlockMaxScoredCursor& operator=(EmbeddedBlockMaxScoredCursor&&) = default;
+    ~EmbeddedBlockMaxScoredCursor() = default;
+
+    [[nodiscard]] PISA_ALWAYSINLINE auto block_max_score() -> float {
+        return this->base_cursor().block_max_score() * this->weight();
+    }
+
+    [[nodiscard]] PISA_ALWAYSINLINE auto block_max_docid() -> std::uint32_t {
+        return this->base_cursor().block_max_docid();
+    }
+
+    PISA_ALWAYSINLINE void block_max_next_geq(std::uint32_t docid) {
+        this->base_cursor().block_max_next_geq(docid);
+    }
+
+  private:
+    EmbeddedBlockMaxScoredCursor(
+        Cursor&& cursor, TermScorerType&& term_scorer, float weight, float max_score
+    )
+        : MaxScoredCursor<Cursor, TermScorerType>(
+            std::move(cursor), std::move(term_scorer), weight, max_score
+        ) {}
+};
+
 template <typename Index, typename WandType, typename Scorer>
 [[nodiscard]] auto make_block_max_scored_cursors(
     Index const& index, WandType const& wdata, Scorer const& scorer, Query const& query, bool weighted = false
 ) {
-    std::vector<BlockMaxScoredCursor<typename Index::document_enumerator, WandType>> cursors;
+    using cursor_type =
+        BlockMaxScoredCursor<typename Index::document_enumerator, WandType, term_scorer_t<Scorer>>;
+    std::vector<cursor_type> cursors;
     cursors.reserve(query.terms().size());
     std::transform(
         query.terms().begin(),
         query.terms().end(),
         std::back_inserter(cursors),
         [&](WeightedTerm const& term) {
-            return BlockMaxScoredCursor<typename Index::document_enumerator, WandType>(
+            return cursor_type(
                 index[term.id],
-                scorer.term_scorer(term.id),
+                make_term_scorer(scorer, term.id),
                 weighted ? term.weight : 1.0F,
                 wdata.max_term_weight(term.id),
                 wdata.getenum(term.id)
@@ -70,4 +122,74 @@ template <typename Index, typename WandType, typename Scorer>
     return cursors;
 }
 
+/**
+ * Creates block-max scored cursors allocated from the arena of the context; see `make_cursors`.
+ */
+template <typename Index, typename WandType, typename Scorer>
+[[nodiscard]] auto make_block_max_scored_cursors(
+    Index const& index,
+    WandType const& wdata,
+    Scorer const& scorer,
+    Query const& query,
+    QueryContext& context,
+    bool weighted = false
+) {
+    using cursor_type =
+        BlockMaxScoredCursor<typename Index::document_enumerator, WandType, term_scorer_t<Scorer>>;
+    std::pmr::vector<cursor_type> cursors(context.resource());
+    cursors.reserve(query.terms().size());
+    for (WeightedTerm const& term: query.terms()) {
+        cursors.emplace_back(
+            make_cursor(index, term.id, context.resource()),
+            make_term_scorer(scorer, term.id),
+            weighted ? term.weight : 1.0F,
+            wdata.max_term_weight(term.id),
+            wdata.getenum(term.id)
+        );
+    }
+    return cursors;
+}
+
+template <typename Index, typename Scorer>
+[[nodiscard]] auto make_embedded_block_max_scored_cursors(
+    Index const& index, Scorer const& scorer, Query const& query, bool weighted = false
+) {
+    using cursor_type =
+        EmbeddedBlockMaxScoredCursor<typename Index::document_enumerator, term_scorer_t<Scorer>>;
+    std::vector<cursor_type> cursors;
+    cursors.reserve(query.terms().size());
+    for (WeightedTerm const& term: query.terms()) {
+        cursors.emplace_back(
+            index[term.id], make_term_scorer(scorer, term.id), weighted ? term.weight : 1.0F
+        );
+    }
+    return cursors;
+}
+
+/**
+ * Creates cursors with embedded block-max scores allocated from the arena of the context; see
+ * `make_cursors`.
+ */
+template <typename Index, typename Scorer>
+[[nodiscard]] auto make_embedded_block_max_scored_cursors(
+    Index const& index,
+    Scorer const& scorer,
+    Query const& query,
+    QueryContext& context,
+    bool weighted = false
+) {
+    using cursor_type =
+        EmbeddedBlockMaxScoredCursor<typename Index::document_enumerator, term_scorer_t<Scorer>>;
+    std::pmr::vector<cursor_type> cursors(context.resource());
+    cursors.reserve(query.terms().size());
+    for (WeightedTerm const& term: query.terms()) {
+        cursors.emplace_back(
+            make_cursor(index, term.id, context.resource()),
+            make_term_scorer(scorer, term.id),
+            weighted ? term.weight : 1.0F
+        );
+    }
+    return cursors;
+}
+
 }  // namespace pisa
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <memory_resource>
+#include <vector>
+
+#include "concepts/posting_cursor.hpp"
+#include "type_alias.hpp"
+#include "util/compiler_attribute.hpp"
+
+namespace pisa {
+
+/**
+ * Adapts a cursor that supports block scoring to a regular scored cursor.
+ *
+ * Moving forward with `next()` scores the remaining postings of the current block at once and
+ * serves `docid()` and `score()` from the buffer. Moving with `next_geq()` past the buffered
+ * postings does not score anything: sparse access, such as in non-essential lists, would waste
+ * most of the block; `score()` then delegates to the underlying cursor.
+ *
+ * No posting at or above `max_docid` is consumed from the underlying cursor, so that it can be
+ * processed again with a greater `max_docid` (e.g., in range queries).
+ */
+template <typename Cursor>
+    requires(concepts::BlockScoredPostingCursor<Cursor>)
+class BufferedScoredCursor {
+  public:
+    constexpr static std::size_t capacity = Cursor::max_block_size;
+
+    BufferedScoredCursor(Cursor& cursor, DocId max_docid)
+        : m_cursor(&cursor), m_max_docid(max_docid) {}
+
+    [[nodiscard]] PISA_ALWAYSINLINE auto docid() const -> std::uint32_t {
+        return m_pos < m_size ? m_docids[m_pos] : m_cursor->docid();
+    }
+
+    [[nodiscard]] PISA_ALWAYSINLINE auto score() -> float {
+        return m_pos < m_size ? m_scores[m_pos] : m_cursor->score();
+    }
+
+    void PISA_ALWAYSINLINE next() {
+        if (m_pos < m_size) {
+            if (++m_pos < m_size) {
+                return;
+            }
+        } else {
+            m_cursor->next();
+        }
+        m_size = m_cursor->score_block(m_docids, m_scores, m_max_docid);
+        m_pos = 0;
+    }
+
+    void PISA_ALWAYSINLINE next_geq(std::uint32_t docid) {
+        while (m_pos < m_size && m_docids[m_pos] < docid) {
+            ++m_pos;
+        }
+        if (m_pos == m_size) {
+            m_cursor->next_geq(docid);
+        }
+    }
+
+    [[nodiscard]] PISA_ALWAYSINLINE auto size() const noexcept -> std::size_t {
+        return m_cursor->size();
+    }
+
+    [[nodiscard]] PISA_ALWAYSINLINE auto max_score() const noexcept -> float
+        requires(concepts::MaxScorePostingCursor<Cursor>)
+    {
+        return m_cursor->max_score();
+    }
+
+  private:
+    Cursor* m_cursor;
+    DocId m_max_docid;
+    std::size_t m_pos = 0;
+    std::size_t m_size = 0;
+    std::array<DocId, capacity> m_docids{};
+    std::array<Score, capacity> m_scores{};
+};
+
+/** Wraps each cursor in a `BufferedScoredCursor`, allocated from `resource`. */
+template <typename CursorRange>
+[[nodiscard]] auto make_buffered_scored_cursors(
+    CursorRange& cursors,
+    DocId max_docid,
+    std::pmr::memory_resource* resource = std::pmr::get_default_resource()
+) -> std::pmr::vector<BufferedScoredCursor<pisa::val_t<CursorRange>>> {
+    std::pmr::vector<BufferedScoredCursor<pisa::val_t<CursorRange>>> buffered(resource);
+    buffered.reserve(cursors.size());
+    for (auto& cursor: cursors) {
+        buffered.emplace_back(cursor, max_docid);
+    }
+    return buffered;
+}
+
+}  // namespace pisa
@@ -1,11 +1,31 @@
 #pragma once
 
+#include <concepts>
+#include <memory_resource>
 #include <vector>
 
 #include "query.hpp"
+#include "query/query_context.hpp"
 
 namespace pisa {
 
+/**
+ * Returns the cursor of the given term. If the index can allocate the cursor's buffers from
+ * a memory resource, they are allocated from `resource`.
+ */
+template <typename Index>
+[[nodiscard]] auto
+make_cursor(Index const& index, std::uint32_t term_id, std::pmr::memory_resource* resource) ->
+    typename Index::document_enumerator {
+    if constexpr (requires {
+                      { index.cursor(term_id, resource) } -> std::same_as<decltype(index[term_id])>;
+                  }) {
+        return index.cursor(term_id, resource);
+    } else {
+        return index[term_id];
+    }
+}
+
 /** Creates cursors for query terms.
  *
  * These are frequency-only cursors. If you want to calculate scores, use
@@ -26,4 +46,18 @@ template <typename Index>
     return cursors;
 }
 
+/**
+ * Creates cursors for query terms, allocating them, and their buffers, from the arena of the
+ * context. The cursors must be destroyed before the context is reset.
+ */
+template <typename Index>
+[[nodiscard]] auto make_cursors(Index const& index, Query const& query, QueryContext& context) {
+    std::pmr::vector<typename Index::document_enumerator> cursors(context.resource());
+    cursors.reserve(query.terms().size());
+    for (auto const& term: query.terms()) {
+        cursors.push_back(make_cursor(index, term.id, context.resource()));
+    }
+    return cursors;
+}
+
 }  // namespace pisa
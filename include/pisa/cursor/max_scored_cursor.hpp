@@ -8,14 +8,14 @@
 
 namespace pisa {
 
-template <typename Cursor>
+template <typename Cursor, typename TermScorerType = TermScorer>
     requires(concepts::FrequencyPostingCursor<Cursor> && concepts::SortedPostingCursor<Cursor>)
-class MaxScoredCursor: public ScoredCursor<Cursor> {
+class MaxScoredCursor: public ScoredCursor<Cursor, TermScorerType> {
   public:
     using base_cursor_type = Cursor;
 
-    MaxScoredCursor(Cursor cursor, TermScorer term_scorer, float weight, float max_score)
-        : ScoredCursor<Cursor>(std::move(cursor), std::move(term_scorer), weight),
+    MaxScoredCursor(Cursor cursor, TermScorerType term_scorer, float weight, float max_score)
+        : ScoredCursor<Cursor, TermScorerType>(std::move(cursor), std::move(term_scorer), weight),
           m_max_score(max_score) {
         static_assert((
             concepts::MaxScorePostingCursor<MaxScoredCursor>
@@ -40,16 +40,17 @@ template <typename Index, typename WandType, typename Scorer>
 [[nodiscard]] auto make_max_scored_cursors(
     Index const& index, WandType const& wdata, Scorer const& scorer, Query const& query, bool weighted = false
 ) {
-    std::vector<MaxScoredCursor<typename Index::document_enumerator>> cursors;
+    using cursor_type = MaxScoredCursor<typename Index::document_enumerator, term_scorer_t<Scorer>>;
+    std::vector<cursor_type> cursors;
     cursors.reserve(query.terms().size());
     std::transform(
         query.terms().begin(),
         query.terms().end(),
         std::back_inserter(cursors),
         [&](WeightedTerm const& term) {
-            return MaxScoredCursor<typename Index::document_enumerator>(
+            return cursor_type(
                 index[term.id],
-                scorer.term_scorer(term.id),
+                make_term_scorer(scorer, term.id),
                 weighted ? term.weight : 1.0F,
                 wdata.max_term_weight(term.id)
             );
@@ -58,4 +59,30 @@ template <typename Index, typename WandType, typename Scorer>
     return cursors;
 }
 
+/**
+ * Creates max-scored cursors allocated from the arena of the context; see `make_cursors`.
+ */
+template <typename Index, typename WandType, typename Scorer>
+[[nodiscard]] auto make_max_scored_cursors(
+    Index const& index,
+    WandType const& wdata,
+    Scorer const& scorer,
+    Query const& query,
+    QueryContext& context,
+    bool weighted = false
+) {
+    using cursor_type = MaxScoredCursor<typename Index::document_enumerator, term_scorer_t<Scorer>>;
+    std::pmr::vector<cursor_type> cursors(context.resource());
+    cursors.reserve(query.terms().size());
+    for (WeightedTerm const& term: query.terms()) {
+        cursors.emplace_back(
+            make_cursor(index, term.id, context.resource()),
+            make_term_scorer(scorer, term.id),
+            weighted ? term.weight : 1.0F,
+            wdata.max_term_weight(term.id)
+        );
+    }
+    return cursors;
+}
+
 }  // namespace pisa
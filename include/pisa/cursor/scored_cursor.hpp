@@ -1,6 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <span>
+
 #include "concepts/posting_cursor.hpp"
+#include "cursor/cursor.hpp"
 #include "query.hpp"
 #include "scorer/index_scorer.hpp"
 #include "util/compiler_attribute.hpp"
@@ -16,13 +22,34 @@ auto resolve_term_scorer(Scorer scorer, float weight) -> TermScorer {
     return [scorer, weight](uint32_t doc, uint32_t freq) { return weight * scorer(doc, freq); };
 }
 
-template <typename Cursor>
+/**
+ * Folds the weight into a statically typed term scorer (see `StaticIndexScorer`).
+ */
+template <typename Scorer>
+    requires(requires(Scorer const& scorer, float weight) {
+        { scorer.weighted(weight) } -> std::same_as<Scorer>;
+    })
+auto resolve_term_scorer(Scorer scorer, float weight) -> Scorer {
+    return scorer.weighted(weight);
+}
+
+/**
+ * Cursor returning scores of postings.
+ *
+ * By default, the scorer is a type-erased `TermScorer`. Cursors created with a
+ * `StaticIndexScorer` use its `term_scorer_type` instead, which can be inlined.
+ */
+template <typename Cursor, typename TermScorerType = TermScorer>
     requires(concepts::FrequencyPostingCursor<Cursor> && concepts::SortedPostingCursor<Cursor>)
 class ScoredCursor {
   public:
     using base_cursor_type = Cursor;
+    using term_scorer_type = TermScorerType;
+
+    /** Maximum number of postings scored by a single call to `score_block`. */
+    constexpr static std::size_t max_block_size = 128;
 
-    ScoredCursor(Cursor cursor, TermScorer term_scorer, float weight)
+    ScoredCursor(Cursor cursor, TermScorerType term_scorer, float weight)
         : m_base_cursor(std::move(cursor)),
           m_weight(weight),
           m_term_scorer(resolve_term_scorer(term_scorer, weight)) {
@@ -48,29 +75,85 @@ class ScoredCursor {
         return m_base_cursor.size();
     }
 
+    /** Returns the document ID bitmap of the base cursor; see `concepts::DensePostingCursor`. */
+    [[nodiscard]] auto docid_bitmap() const -> DocidBitmap
+        requires(concepts::DensePostingCursor<Cursor>)
+    {
+        return m_base_cursor.docid_bitmap();
+    }
+
+    /**
+     * Scores the postings of the current block in bulk; see `concepts::BlockScoredPostingCursor`.
+     * At most `max_block_size` postings are scored per call.
+     */
+    auto PISA_ALWAYSINLINE
+    score_block(std::span<DocId> docids, std::span<Score> scores, DocId max_docid) -> std::size_t
+        requires(concepts::BlockPostingCursor<Cursor>)
+    {
+        std::array<std::uint32_t, max_block_size> freqs;
+        auto size = m_base_cursor.read_block(
+            docids.first(std::min(docids.size(), scores.size())), freqs, max_docid
+        );
+        score_postings(
+            m_term_scorer,
+            std::span<std::uint32_t const>(docids.data(), size),
+            std::span<std::uint32_t const>(freqs.data(), size),
+            scores.first(size)
+        );
+        return size;
+    }
+
+  protected:
+    [[nodiscard]] PISA_ALWAYSINLINE auto base_cursor() -> Cursor& { return m_base_cursor; }
+
   private:
     Cursor m_base_cursor;
     float m_weight = 1.0;
-    TermScorer m_term_scorer;
+    TermScorerType m_term_scorer;
 };
 
 template <typename Index, typename Scorer>
 [[nodiscard]] auto make_scored_cursors(
     Index const& index, Scorer const& scorer, Query const& query, bool weighted = false
 ) {
-    std::vector<ScoredCursor<typename Index::document_enumerator>> cursors;
+    using cursor_type = ScoredCursor<typename Index::document_enumerator, term_scorer_t<Scorer>>;
+    std::vector<cursor_type> cursors;
     cursors.reserve(query.terms().size());
     std::transform(
         query.terms().begin(),
         query.terms().end(),
         std::back_inserter(cursors),
         [&](WeightedTerm const& term) {
-            return ScoredCursor<typename Index::document_enumerator>(
-                index[term.id], scorer.term_scorer(term.id), weighted ? term.weight : 1.0
+            return cursor_type(
+                index[term.id], make_term_scorer(scorer, term.id), weighted ? term.weight : 1.0
             );
         }
     );
     return cursors;
 }
 
+/**
+ * Creates scored cursors allocated from the arena of the context; see `make_cursors`.
+ */
+template <typename Index, typename Scorer>
+[[nodiscard]] auto make_scored_cursors(
+    Index const& index,
+    Scorer const& scorer,
+    Query const& query,
+    QueryContext& context,
+    bool weighted = false
+) {
+    using cursor_type = ScoredCursor<typename Index::document_enumerator, term_scorer_t<Scorer>>;
+    std::pmr::vector<cursor_type> cursors(context.resource());
+    cursors.reserve(query.terms().size());
+    for (WeightedTerm const& term: query.terms()) {
+        cursors.emplace_back(
+            make_cursor(index, term.id, context.resource()),
+            make_term_scorer(scorer, term.id),
+            weighted ? term.weight : 1.0F
+        );
+    }
+    return cursors;
+}
+
 }  // namespace pisa
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "util/intrinsics.hpp"
+
+namespace pisa {
+
+/**
+ * Read-only view of a set of document IDs stored as a bitmap: document `d` is in the set if bit
+ * `d % 64` of word `d / 64` is set. The 64-bit words are stored in little-endian order at an
+ * arbitrary alignment, e.g., within an encoded posting list (see `index::block::DENSE`).
+ *
+ * A default-constructed bitmap is empty, which marks a posting list that is not stored as a
+ * bitmap (see `concepts::DensePostingCursor`).
+ */
+class DocidBitmap {
+  public:
+    DocidBitmap() = default;
+    DocidBitmap(std::uint8_t const* data, std::size_t num_words)
+        : m_data(data), m_num_words(num_words) {}
+
+    [[nodiscard]] auto empty() const noexcept -> bool { return m_num_words == 0; }
+
+    /** Returns the number of words, i.e., the bitmap covers the IDs below `64 * num_words()`. */
+    [[nodiscard]] auto num_words() const noexcept -> std::size_t { return m_num_words; }
+
+    [[nodiscard]] auto word(std::size_t pos) const -> std::uint64_t {
+        std::uint64_t word;
+        std::memcpy(&word, m_data + 8 * pos, sizeof(word));
+        return word;
+    }
+
+    [[nodiscard]] auto contains(std::uint64_t docid) const -> bool {
+        return docid < 64 * m_num_words && ((word(docid / 64) >> (docid % 64)) & 1U) != 0;
+    }
+
+    /** Copies the first `words.size()` words, which must not exceed `num_words()`, to `words`. */
+    void copy_to(std::span<std::uint64_t> words) const {
+        std::memcpy(words.data(), m_data, 8 * words.size());
+    }
+
+    /**
+     * Intersects `words` with the first `words.size()` words of the bitmap, which must not
+     * exceed `num_words()`.
+     */
+    void intersect(std::span<std::uint64_t> words) const {
+        intrinsics::and_words(words.data(), m_data, words.size());
+    }
+
+    /**
+     * Writes the `n` smallest IDs in the set that are at least `first`, which must exist, to
+     * `out`.
+     */
+    void decode(std::uint64_t first, std::size_t n, std::uint32_t* out) const {
+        std::size_t pos = first / 64;
+        std::uint64_t bits = word(pos) & (~std::uint64_t(0) << (first % 64));
+        for (std::size_t idx = 0; idx < n; ++idx) {
+            while (bits == 0) {
+                bits = word(++pos);
+            }
+            unsigned long bit;
+            intrinsics::bsf64(&bit, bits);
+            out[idx] = static_cast<std::uint32_t>(64 * pos + bit);
+            bits &= bits - 1;
+        }
+    }
+
+  private:
+    std::uint8_t const* m_data = nullptr;
+    std::size_t m_num_words = 0;
+};
+
+}  // namespace pisa
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <fmt/format.h>
 #include <string_view>
 #include <tbb/parallel_invoke.h>
@@ -158,6 +159,29 @@ class freq_index {
             m_cur_docid = val.second;
         }
 
+        /**
+         * Decodes up to `n` postings in bulk, starting at the current one.
+         *
+         * Writes the document IDs and frequencies of the postings to `out_docs` and `out_freqs`,
+         * and moves the cursor to the posting following the last one written. This is
+         * equivalent to reading `docid()` and `freq()` and calling `next()` that many times,
+         * but decodes each sequence a word at a time instead of one element per call.
+         *
+         * \returns  The number of postings written, which is less than `n` only if the end of
+         *           the list is reached.
+         */
+        uint64_t PISA_FLATTEN_FUNC
+        decode_next(uint64_t n, uint64_t* out_docs, uint64_t* out_freqs) {
+            n = std::min(n, size() - m_cur_pos);
+            if (n == 0) {
+                return 0;
+            }
+            m_docs_enum.decode(m_cur_pos, n, out_docs);
+            m_freqs_enum.decode(m_cur_pos, n, out_freqs);
+            next();
+            return n;
+        }
+
         uint64_t docid() const { return m_cur_docid; }
 
         uint64_t PISA_FLATTEN_FUNC freq() { return m_freqs_enum.move(m_cur_pos).second; }
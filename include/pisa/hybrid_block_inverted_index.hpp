@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "block_inverted_index.hpp"
+#include "codec/block_codec.hpp"
+#include "dec_time_prediction.hpp"
+#include "memory_source.hpp"
+#include "type_alias.hpp"
+
+namespace pisa {
+
+namespace index::block {
+
+    /**
+     * The codecs a hybrid index can choose from. The codec tag of a posting list is the position
+     * of its codec in this array, so new codecs must only be appended.
+     */
+    inline constexpr std::array<std::string_view, 5> HYBRID_CODECS{
+        "block_simdbp",
+        "block_streamvbyte",
+        "block_optpfor",
+        "block_varintgb",
+        "block_interpolative"
+    };
+
+    /** Returns the codecs of `HYBRID_CODECS`, in the same order. */
+    [[nodiscard]] auto hybrid_codecs() -> std::vector<BlockCodecPtr>;
+
+    /**
+     * Chooses the codec of each posting list of a `HybridBlockInvertedIndex`.
+     *
+     * A posting list is encoded with each codec of `HYBRID_CODECS`, and the encoding with the
+     * lowest cost is kept. The cost of an encoding is its size in bytes plus its expected decoding
+     * time in nanoseconds, multiplied by the decode weight:
+     *
+     *     bytes + decode_weight * frequency(term) * decoding_time
+     *
+     * The decoding time is the sum of the predictions for the document gaps and frequencies of
+     * each block, made from the features of `time_prediction::values_statistics` by the predictor
+     * of the codec. Each codec has a rough default predictor, which can be replaced with one
+     * fitted on the target machine (see `read_predictors`).
+     *
+     * The frequency of a term is the number of times it occurs in the query log, if given, and 1
+     * for all terms otherwise. Thus, with a query log, lists that are never queried are encoded
+     * in the smallest space, and frequently queried lists with the fastest codec.
+     */
+    class HybridCodecSelector {
+      public:
+        static constexpr double DEFAULT_DECODE_WEIGHT = 0.1;
+
+        explicit HybridCodecSelector(
+            double decode_weight = DEFAULT_DECODE_WEIGHT,
+            std::vector<std::uint64_t> term_frequencies = {}
+        );
+
+        /** Replaces the decoding time predictor of the given codec of `HYBRID_CODECS`. */
+        void predictor(std::string_view codec, time_prediction::predictor predictor);
+
+        /** Returns the expected decoding time of the posting list with the given codec tag. */
+        [[nodiscard]] auto decoding_time(
+            std::uint32_t codec_tag,
+            std::uint32_t n,
+            std::uint32_t const* docs,
+            std::uint32_t const* freqs
+        ) const -> double;
+
+        /**
+         * Encodes the posting list of `term_id` with the codec of the lowest cost, appending it to
+         * `out`, and returns the tag of the codec. See `write_posting_list` for the other
+         * parameters.
+         */
+        auto write(
+            std::vector<std::uint8_t>& out,
+            TermId term_id,
+            std::uint32_t n,
+            std::uint32_t const* docs,
+            std::uint32_t const* freqs,
+            bool skip_layer = false,
+            bool dense = false,
+            float const* scores = nullptr,
+            std::optional<std::uint32_t> scorer = std::nullopt
+        ) const -> std::uint32_t;
+
+        /**
+         * Reads the query log term frequencies: one number per line, the frequency of the term
+         * whose ID is the line number (starting at 0). Missing terms have frequency 0.
+         */
+        [[nodiscard]] static auto read_term_frequencies(std::istream& in)
+            -> std::vector<std::uint64_t>;
+
+        /**
+         * Reads decoding time predictors and sets them in `selector`.
+         *
+         * Each line has the form `<codec> <feature> <weight>`, where the feature is either one of
+         * the features in `dec_time_prediction.hpp` or `bias`. The predictor of each codec in the
+         * file is replaced by one with the given weights, while the other codecs keep theirs.
+         */
+        static void read_predictors(std::istream& in, HybridCodecSelector& selector);
+
+      private:
+        [[nodiscard]] auto frequency(TermId term_id) const -> double;
+
+        std::vector<BlockCodecPtr> m_codecs;
+        std::array<time_prediction::predictor, HYBRID_CODECS.size()> m_predictors;
+        double m_decode_weight;
+        std::vector<std::uint64_t> m_term_frequencies;
+    };
+
+}  // namespace index::block
+
+/**
+ * Block inverted index in which each posting list is encoded with its own codec.
+ *
+ * The data format is that of `BlockInvertedIndex`, but the header of every posting list carries
+ * the tag of its codec (see `index::block::CODEC_TAG` and `index::block::HYBRID_CODECS`). The
+ * codec is resolved once per list, when its cursor is created, and the cursor type is the same
+ * for all lists, so query processing is compiled once and stays monomorphic within a list.
+ *
+ * Indexes of this type are built by `BlockIndexBuilder::hybrid`.
+ */
+class HybridBlockInvertedIndex: public BlockInvertedIndex {
+    std::vector<BlockCodecPtr> m_codecs;
+
+    HybridBlockInvertedIndex(MemorySource source, std::vector<BlockCodecPtr> codecs);
+
+  public:
+    static constexpr std::string_view encoding = "block_hybrid";
+
+    using document_enumerator = BlockInvertedIndexCursor<>;
+
+    explicit HybridBlockInvertedIndex(MemorySource source);
+
+    [[nodiscard]] auto operator[](std::size_t term_id) const -> BlockInvertedIndexCursor<>;
+
+    /** Returns a cursor whose decoding buffers are allocated from `resource`. */
+    [[nodiscard]] auto cursor(std::size_t term_id, std::pmr::memory_resource* resource) const
+        -> BlockInvertedIndexCursor<>;
+
+    /** Returns the tag of the codec of the given posting list. */
+    [[nodiscard]] auto codec_tag(std::size_t term_id) const -> std::uint32_t;
+
+    [[nodiscard]] auto size_stats() -> SizeStats;
+
+  private:
+    [[nodiscard]] auto list_codec(std::uint8_t const* data) const -> BlockCodec const*;
+};
+
+}  // namespace pisa
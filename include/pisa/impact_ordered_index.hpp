@@ -0,0 +1,112 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "memory_source.hpp"
+#include "type_alias.hpp"
+
+namespace pisa {
+
+/** A run of documents of a posting list that share the same quantized score. */
+struct ImpactSegment {
+    /** The quantized score of all documents in the segment. */
+    std::uint32_t impact;
+    /** The number of documents in the segment. */
+    std::uint32_t size;
+    /** The position of the first document of the segment in the document array. */
+    std::uint64_t offset;
+};
+
+/**
+ * Inverted index with impact-ordered posting lists, for score-at-a-time processing.
+ *
+ * Each posting list is stored as a sequence of segments ordered by decreasing impact; the
+ * documents of a segment are sorted by ID. Therefore, the highest scoring postings of each term
+ * come first, and a query can be processed by reading the segments of all its terms in the order
+ * of their impacts, stopping at any point (see `saat_query`).
+ *
+ * The encoded index consists of a header (magic number, version, and the number of documents,
+ * terms, segments, and postings), followed by the position of the first segment of each term
+ * (plus one past the last), the segments, and the uncompressed document IDs of all segments. The
+ * arrays are read directly from the memory source, so the index can be memory-mapped and used
+ * without parsing.
+ */
+class ImpactOrderedIndex {
+  public:
+    explicit ImpactOrderedIndex(MemorySource source);
+
+    /** The number of documents in the collection. */
+    [[nodiscard]] auto num_docs() const noexcept -> std::size_t;
+
+    /** The number of terms (posting lists). */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    /** The total number of postings in all posting lists. */
+    [[nodiscard]] auto num_postings() const noexcept -> std::size_t;
+
+    /**
+     * The segments of the term's posting list, in decreasing order of impact.
+     *
+     * Throws `std::out_of_range` if the term is not in the index.
+     */
+    [[nodiscard]] auto segments(TermId term) const -> std::span<ImpactSegment const>;
+
+    /** The document IDs of the segment, in increasing order. */
+    [[nodiscard]] auto documents(ImpactSegment const& segment) const noexcept
+        -> std::span<DocId const>;
+
+  private:
+    MemorySource m_source;
+    std::size_t m_num_docs;
+    std::span<std::uint64_t const> m_term_segments;
+    std::span<ImpactSegment const> m_segments;
+    std::span<DocId const> m_documents;
+};
+
+/** Collects impact-ordered posting lists and encodes them in the format of `ImpactOrderedIndex`. */
+class ImpactOrderedIndexBuilder {
+  public:
+    explicit ImpactOrderedIndexBuilder(std::size_t num_docs);
+
+    /**
+     * Adds the next posting list, given by its document IDs and the quantized scores (impacts)
+     * of the corresponding postings. Postings with impact 0 do not contribute to any score, and
+     * are dropped.
+     *
+     * Throws `std::invalid_argument` if the sizes of `documents` and `impacts` differ, or if a
+     * document ID is not less than the number of documents.
+     */
+    void add_posting_list(std::span<DocId const> documents, std::span<std::uint32_t const> impacts);
+
+    /** The number of posting lists added so far. */
+    [[nodiscard]] auto size() const noexcept -> std::size_t;
+
+    void encode(std::ostream& out) const;
+
+  private:
+    std::size_t m_num_docs;
+    std::vector<std::uint64_t> m_term_segments{0};
+    std::vector<ImpactSegment> m_segments;
+    std::vector<DocId> m_documents;
+    std::vector<std::pair<std::uint32_t, DocId>> m_postings;
+};
+
+}  // namespace pisa
@@ -2,7 +2,11 @@
 
 #include "block_inverted_index.hpp"
 #include "codec/block_codec_registry.hpp"
+#include "codec/optpfor.hpp"
+#include "codec/simdbp.hpp"
+#include "codec/streamvbyte.hpp"
 #include "freq_index.hpp"
+#include "hybrid_block_inverted_index.hpp"
 #include "sequence/partitioned_sequence.hpp"
 #include "sequence/positive_sequence.hpp"
 #include "sequence/uniform_partitioned_sequence.hpp"
@@ -19,6 +23,12 @@ using pefuniform_index =
 using pefopt_index =
     freq_index<partitioned_sequence<>, positive_sequence<partitioned_sequence<strict_sequence>>>;
 
+/**
+ * Opens the index with the given encoding and passes it to `fn`.
+ *
+ * The most commonly used block codecs are resolved to a `StaticBlockInvertedIndex`, and so the
+ * queries are compiled separately for each of them. Any other block codec is resolved at runtime.
+ */
 template <typename Fn>
 void run_for_index(std::string_view encoding, MemorySource source, Fn&& fn) {
     if (encoding == "ef") {
@@ -29,6 +39,14 @@ void run_for_index(std::string_view encoding, MemorySource source, Fn&& fn) {
         fn(pefuniform_index(std::move(source)));
     } else if (encoding == "pefopt") {
         fn(pefopt_index(std::move(source)));
+    } else if (encoding == SimdBpBlockCodec::name) {
+        fn(StaticBlockInvertedIndex<SimdBpBlockCodec>(std::move(source)));
+    } else if (encoding == StreamVByteBlockCodec::name) {
+        fn(StaticBlockInvertedIndex<StreamVByteBlockCodec>(std::move(source)));
+    } else if (encoding == OptPForBlockCodec::name) {
+        fn(StaticBlockInvertedIndex<OptPForBlockCodec>(std::move(source)));
+    } else if (encoding == HybridBlockInvertedIndex::encoding) {
+        fn(HybridBlockInvertedIndex(std::move(source)));
     } else if (encoding.rfind("block_", 0) == 0) {
         fn(BlockInvertedIndex(std::move(source), get_block_codec(encoding)));
     } else {
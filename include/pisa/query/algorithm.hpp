@@ -1,9 +1,13 @@
 #pragma once
 
 #include "query/algorithm/and_query.hpp"
+#include "query/algorithm/batched_ranked_or_taat_query.hpp"
+#include "query/algorithm/bitmap_intersection.hpp"
 #include "query/algorithm/block_max_maxscore_query.hpp"
 #include "query/algorithm/block_max_ranked_and_query.hpp"
 #include "query/algorithm/block_max_wand_query.hpp"
+#include "query/algorithm/bootstrap_threshold.hpp"
+#include "query/algorithm/champion_query.hpp"
 #include "query/algorithm/maxscore_query.hpp"
 #include "query/algorithm/or_query.hpp"
 #include "query/algorithm/range_query.hpp"
@@ -11,4 +15,6 @@
 #include "query/algorithm/ranked_and_query.hpp"
 #include "query/algorithm/ranked_or_query.hpp"
 #include "query/algorithm/ranked_or_taat_query.hpp"
+#include "query/algorithm/ranked_or_window_query.hpp"
+#include "query/algorithm/saat_query.hpp"
 #include "query/algorithm/wand_query.hpp"
@@ -2,9 +2,12 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory_resource>
+#include <span>
 #include <vector>
 
 #include "concepts/posting_cursor.hpp"
+#include "query/algorithm/bitmap_intersection.hpp"
 
 namespace pisa {
 
@@ -14,6 +17,8 @@ namespace pisa {
  * Performs an intersection of documents across all query terms. Returns a vector of all IDs
  * in the intersection. This particular algorithm does no scoring. For the scored version,
  * see `scored_and_query`.
+ *
+ * If some of the lists are dense, they are intersected as bitmaps (see `bitmap_intersection`).
  */
 struct and_query {
     template <typename CursorRange>
@@ -39,6 +44,17 @@ struct and_query {
             return lhs->size() < rhs->size();
         });
 
+        if constexpr (concepts::DensePostingCursor<Cursor>) {
+            if (bitmap_intersection(
+                    std::span<Cursor* const>(ordered_cursors),
+                    max_docid,
+                    std::pmr::get_default_resource(),
+                    [&](std::uint64_t docid) { results.push_back(docid); }
+                )) {
+                return results;
+            }
+        }
+
         uint32_t candidate = ordered_cursors[0]->docid();
         size_t i = 1;
 
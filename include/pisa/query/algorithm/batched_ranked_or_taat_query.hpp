@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "accumulator/simple_accumulator.hpp"
+#include "concepts/posting_cursor.hpp"
+#include "cursor/scored_cursor.hpp"
+#include "query.hpp"
+#include "topk_queue.hpp"
+
+namespace pisa {
+
+/**
+ * Disjunctive term-at-a-time processing of a group of queries at once.
+ *
+ * Each distinct term of the group is traversed a single time: its postings are decoded and scored
+ * in blocks, and each block is added to the accumulators of all queries containing the term,
+ * multiplied by the term's weight in that query. The results are the same as running
+ * `ranked_or_taat_query` on each query separately, up to the order of floating point summation,
+ * but posting lists shared by several queries are decoded once. Groups of queries with many
+ * common terms can be formed with `group_queries_by_terms`.
+ *
+ * One accumulator is kept per query in a group, so memory grows with `max_group_size` times the
+ * number of documents.
+ */
+template <typename Accumulator = SimpleAccumulator>
+class batched_ranked_or_taat_query {
+  public:
+    batched_ranked_or_taat_query(std::size_t num_docs, std::size_t max_group_size) {
+        if (max_group_size == 0) {
+            throw std::invalid_argument("maximum query group size must be positive");
+        }
+        m_accumulators.reserve(max_group_size);
+        for (std::size_t idx = 0; idx < max_group_size; ++idx) {
+            m_accumulators.emplace_back(num_docs);
+        }
+    }
+
+    /**
+     * Processes the queries at positions `group` of `queries`, inserting the results of the
+     * query `group[i]` into `topks[i]`. The queues are not finalized.
+     *
+     * Throws `std::invalid_argument` if the group is larger than the maximum group size, or if
+     * the number of queues does not match the group size.
+     */
+    template <typename Index, typename Scorer>
+    void operator()(
+        Index const& index,
+        Scorer const& scorer,
+        std::span<Query const> queries,
+        std::span<std::size_t const> group,
+        std::span<topk_queue> topks,
+        bool weighted = false
+    ) {
+        if (group.size() > m_accumulators.size()) {
+            throw std::invalid_argument("query group exceeds the maximum group size");
+        }
+        if (group.size() != topks.size()) {
+            throw std::invalid_argument("number of queues does not match the query group size");
+        }
+
+        m_subscriptions.clear();
+        for (std::size_t pos = 0; pos < group.size(); ++pos) {
+            m_accumulators[pos].reset();
+            for (auto const& term: queries[group[pos]].terms()) {
+                m_subscriptions.push_back({term.id, pos, weighted ? term.weight : 1.0F});
+            }
+        }
+        std::sort(m_subscriptions.begin(), m_subscriptions.end(), [](auto lhs, auto rhs) {
+            return lhs.term < rhs.term || (lhs.term == rhs.term && lhs.query < rhs.query);
+        });
+
+        using cursor_type =
+            ScoredCursor<typename Index::document_enumerator, term_scorer_t<Scorer>>;
+        auto first = m_subscriptions.begin();
+        while (first != m_subscriptions.end()) {
+            auto last = std::find_if(first, m_subscriptions.end(), [&](auto const& sub) {
+                return sub.term != first->term;
+            });
+            cursor_type cursor(index[first->term], make_term_scorer(scorer, first->term), 1.0F);
+            accumulate(cursor, index.num_docs(), std::span<subscription const>(first, last));
+            first = last;
+        }
+
+        for (std::size_t pos = 0; pos < group.size(); ++pos) {
+            m_accumulators[pos].collect(topks[pos]);
+        }
+    }
+
+  private:
+    /** A query of the group containing a term. */
+    struct subscription {
+        TermId term;
+        std::size_t query;
+        float weight;
+    };
+
+    template <typename Cursor>
+    void accumulate(Cursor& cursor, std::uint64_t max_docid, std::span<subscription const> subs) {
+        if constexpr (concepts::BlockScoredPostingCursor<Cursor>) {
+            std::array<DocId, Cursor::max_block_size> docids;
+            std::array<Score, Cursor::max_block_size> scores;
+            while (auto size = cursor.score_block(docids, scores, max_docid)) {
+                for (auto const& sub: subs) {
+                    auto& accumulator = m_accumulators[sub.query];
+                    for (std::size_t idx = 0; idx < size; ++idx) {
+                        accumulator.accumulate(docids[idx], sub.weight * scores[idx]);
+                    }
+                }
+            }
+        } else {
+            while (cursor.docid() < max_docid) {
+                auto score = cursor.score();
+                for (auto const& sub: subs) {
+                    m_accumulators[sub.query].accumulate(cursor.docid(), sub.weight * score);
+                }
+                cursor.next();
+            }
+        }
+    }
+
+    std::vector<Accumulator> m_accumulators;
+    std::vector<subscription> m_subscriptions;
+};
+
+}  // namespace pisa
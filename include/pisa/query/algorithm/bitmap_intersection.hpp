@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "concepts/posting_cursor.hpp"
+#include "util/intrinsics.hpp"
+#include "util/util.hpp"
+
+namespace pisa {
+
+namespace detail {
+    /**
+     * Returns the first set bit of `words` at position `from` or later, or `64 * words.size()`
+     * if there is none.
+     */
+    [[nodiscard]] inline auto next_set_bit(std::span<std::uint64_t const> words, std::uint64_t from)
+        -> std::uint64_t {
+        std::size_t pos = from / 64;
+        std::uint64_t bits = words[pos] & (~std::uint64_t(0) << (from % 64));
+        while (bits == 0) {
+            if (++pos == words.size()) {
+                return 64 * words.size();
+            }
+            bits = words[pos];
+        }
+        unsigned long bit;
+        intrinsics::bsf64(&bit, bits);
+        return 64 * pos + bit;
+    }
+}  // namespace detail
+
+/**
+ * Intersects posting lists using the document ID bitmaps of the dense ones (see
+ * `concepts::DensePostingCursor`).
+ *
+ * The bitmaps of the dense lists are ANDed word by word into a bitmap allocated from `resource`.
+ * If all lists are dense, the intersection is read off that bitmap. Otherwise, the sparse lists
+ * are intersected in the given order, with the bitmap acting as one more list whose `next_geq`
+ * is a scan for the next set bit, so the dense lists are never decoded to find candidates.
+ *
+ * `on_match` is called with each document ID below `max_docid` in the intersection, in increasing
+ * order. At that point, the sparse cursors are at that document, while the dense cursors have not
+ * been moved; they can be moved to it with `next_geq`, e.g., to be scored.
+ *
+ * Returns false, without calling `on_match` or moving any cursor, if none of the lists is dense.
+ */
+template <typename Cursor, typename Fn>
+    requires(concepts::DensePostingCursor<Cursor>)
+auto bitmap_intersection(
+    std::span<Cursor* const> cursors,
+    std::uint64_t max_docid,
+    std::pmr::memory_resource* resource,
+    Fn&& on_match
+) -> bool {
+    std::pmr::vector<Cursor*> sparse(resource);
+    std::pmr::vector<std::uint64_t> words(resource);
+    bool has_dense = false;
+    for (auto* cursor: cursors) {
+        auto bitmap = cursor->docid_bitmap();
+        if (bitmap.empty()) {
+            sparse.push_back(cursor);
+        } else if (!has_dense) {
+            words.resize(std::min<std::size_t>(bitmap.num_words(), ceil_div(max_docid, 64)));
+            bitmap.copy_to(words);
+            has_dense = true;
+        } else {
+            words.resize(std::min(words.size(), bitmap.num_words()));
+            bitmap.intersect(words);
+        }
+    }
+    if (!has_dense) {
+        return false;
+    }
+
+    std::uint64_t end = std::min<std::uint64_t>(max_docid, 64 * words.size());
+    if (sparse.empty()) {
+        for (std::size_t pos = 0; pos < words.size(); ++pos) {
+            for (std::uint64_t bits = words[pos]; bits != 0; bits &= bits - 1) {
+                unsigned long bit;
+                intrinsics::bsf64(&bit, bits);
+                if (64 * pos + bit >= end) {
+                    return true;
+                }
+                on_match(64 * pos + bit);
+            }
+        }
+        return true;
+    }
+
+    std::uint64_t candidate = sparse[0]->docid();
+    while (candidate < end) {
+        candidate = detail::next_set_bit(words, candidate);
+        if (candidate >= end) {
+            break;
+        }
+        bool found = true;
+        for (auto* cursor: sparse) {
+            cursor->next_geq(candidate);
+            if (cursor->docid() != candidate) {
+                candidate = cursor->docid();
+                found = false;
+                break;
+            }
+        }
+        if (found) {
+            on_match(candidate);
+            sparse[0]->next();
+            candidate = sparse[0]->docid();
+        }
+    }
+    return true;
+}
+
+}  // namespace pisa
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <memory_resource>
 #include <vector>
 
 #include "concepts/posting_cursor.hpp"
+#include "query/query_context.hpp"
 #include "topk_queue.hpp"
 
 namespace pisa {
@@ -10,6 +12,13 @@ namespace pisa {
 struct block_max_maxscore_query {
     explicit block_max_maxscore_query(topk_queue& topk) : m_topk(topk) {}
 
+    /**
+     * Allocates the auxiliary data of a query from the arena of the context, and stops when the
+     * budget of the context runs out.
+     */
+    block_max_maxscore_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_resource(context.resource()), m_budget(&context.budget()) {}
+
     template <typename CursorRange>
         requires(concepts::BlockMaxPostingCursor<pisa::val_t<CursorRange>>)
     void operator()(CursorRange&& cursors, uint64_t max_docid) {
@@ -18,7 +27,7 @@ struct block_max_maxscore_query {
             return;
         }
 
-        std::vector<Cursor*> ordered_cursors;
+        std::pmr::vector<Cursor*> ordered_cursors(m_resource);
         ordered_cursors.reserve(cursors.size());
         for (auto& en: cursors) {
             ordered_cursors.push_back(&en);
@@ -29,7 +38,7 @@ struct block_max_maxscore_query {
             return lhs->max_score() < rhs->max_score();
         });
 
-        std::vector<float> upper_bounds(ordered_cursors.size());
+        std::pmr::vector<float> upper_bounds(ordered_cursors.size(), m_resource);
         upper_bounds[0] = ordered_cursors[0]->max_score();
         for (size_t i = 1; i < ordered_cursors.size(); ++i) {
             upper_bounds[i] = upper_bounds[i - 1] + ordered_cursors[i]->max_score();
@@ -90,6 +99,11 @@ struct block_max_maxscore_query {
                 }
             }
             cur_doc = next_doc;
+            if (m_budget != nullptr
+                && m_budget->charge(ordered_cursors.size() - non_essential_lists)) {
+                m_topk.mark_incomplete();
+                break;
+            }
         }
     }
 
@@ -97,5 +111,7 @@ struct block_max_maxscore_query {
 
   private:
     topk_queue& m_topk;
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
+    QueryBudget* m_budget = nullptr;
 };
 }  // namespace pisa
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <memory_resource>
 #include <vector>
 
 #include "concepts/posting_cursor.hpp"
+#include "query/query_context.hpp"
 #include "topk_queue.hpp"
 
 namespace pisa {
@@ -10,6 +12,19 @@ namespace pisa {
 struct block_max_ranked_and_query {
     explicit block_max_ranked_and_query(topk_queue& topk) : m_topk(topk) {}
 
+    /**
+     * Allocates the auxiliary data of a query from the arena of the context, and stops when the
+     * budget of the context runs out.
+     */
+    block_max_ranked_and_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_resource(context.resource()), m_budget(&context.budget()) {}
+
+    /** Allocates the auxiliary data from `resource`, and stops when `budget` runs out. */
+    block_max_ranked_and_query(
+        topk_queue& topk, std::pmr::memory_resource* resource, QueryBudget& budget
+    )
+        : m_topk(topk), m_resource(resource), m_budget(&budget) {}
+
     template <typename CursorRange>
         requires(concepts::BlockMaxPostingCursor<pisa::val_t<CursorRange>>)
     void operator()(CursorRange&& cursors, uint64_t max_docid) {
@@ -19,7 +34,7 @@ struct block_max_ranked_and_query {
             return;
         }
 
-        std::vector<Cursor*> ordered_cursors;
+        std::pmr::vector<Cursor*> ordered_cursors(m_resource);
         ordered_cursors.reserve(cursors.size());
         for (auto& en: cursors) {
             ordered_cursors.push_back(&en);
@@ -33,6 +48,11 @@ struct block_max_ranked_and_query {
         uint64_t candidate = ordered_cursors[0]->docid();
         size_t candidate_list = 1;
         while (candidate < max_docid) {
+            // each candidate is charged the postings of all lists
+            if (m_budget != nullptr && m_budget->charge(ordered_cursors.size())) {
+                m_topk.mark_incomplete();
+                return;
+            }
             // Get current block UB
             double block_upper_bound = 0;
             for (size_t block = 0; block < ordered_cursors.size(); ++block) {
@@ -84,6 +104,8 @@ struct block_max_ranked_and_query {
 
   private:
     topk_queue& m_topk;
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
+    QueryBudget* m_budget = nullptr;
 };
 
 }  // namespace pisa
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <memory_resource>
 #include <vector>
 
 #include "concepts/posting_cursor.hpp"
+#include "query/query_context.hpp"
 #include "topk_queue.hpp"
 
 namespace pisa {
@@ -10,6 +12,13 @@ namespace pisa {
 struct block_max_wand_query {
     explicit block_max_wand_query(topk_queue& topk) : m_topk(topk) {}
 
+    /**
+     * Allocates the auxiliary data of a query from the arena of the context, and stops when the
+     * budget of the context runs out.
+     */
+    block_max_wand_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_resource(context.resource()), m_budget(&context.budget()) {}
+
     template <typename CursorRange>
         requires(concepts::BlockMaxPostingCursor<pisa::val_t<CursorRange>>)
     void operator()(CursorRange&& cursors, uint64_t max_docid) {
@@ -18,7 +27,7 @@ struct block_max_wand_query {
             return;
         }
 
-        std::vector<Cursor*> ordered_cursors;
+        std::pmr::vector<Cursor*> ordered_cursors(m_resource);
         ordered_cursors.reserve(cursors.size());
         for (auto& en: cursors) {
             ordered_cursors.push_back(&en);
@@ -61,6 +70,11 @@ struct block_max_wand_query {
             if (!found_pivot) {
                 break;
             }
+            // each candidate is charged the postings of the lists up to the pivot
+            if (m_budget != nullptr && m_budget->charge(pivot + 1)) {
+                m_topk.mark_incomplete();
+                break;
+            }
 
             double block_upper_bound = 0;
 
@@ -166,6 +180,8 @@ struct block_max_wand_query {
 
   private:
     topk_queue& m_topk;
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
+    QueryBudget* m_budget = nullptr;
 };
 
 }  // namespace pisa
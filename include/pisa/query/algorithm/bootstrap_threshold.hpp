@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "concepts/posting_cursor.hpp"
+#include "query/algorithm/block_max_ranked_and_query.hpp"
+#include "query/query_budget.hpp"
+#include "query/query_context.hpp"
+#include "topk_queue.hpp"
+#include "type_alias.hpp"
+
+namespace pisa {
+
+/** Default postings budget of the conjunctive pre-pass of `bootstrap_threshold`. */
+constexpr std::size_t default_bootstrap_postings = 8192;
+
+/**
+ * Returns a lower bound on the score of the `k`-th result of the disjunctive query over the given
+ * cursors, or 0 if none is found.
+ *
+ * The bound comes from a conjunctive pre-pass: `block_max_ranked_and_query` is run until it has
+ * processed about `max_postings` postings. Documents matching all terms have the same score in
+ * the conjunction and the disjunction, so if the pre-pass finds `k` of them, the lowest of their
+ * scores cannot exceed the `k`-th disjunctive score. The bound is lowered by the rounding error
+ * that summing the term scores in a different order can introduce, so that seeding a top-k queue
+ * with it leaves the results of a safe algorithm unchanged.
+ *
+ * The cursors are consumed by the pre-pass. It uses the top-k queue of the context, and allocates
+ * from its arena. The pre-pass is part of the query: it processes at most the postings left in
+ * the budget of the context, and charges them to it.
+ */
+template <typename CursorRange>
+    requires(concepts::BlockMaxPostingCursor<pisa::val_t<CursorRange>>)
+[[nodiscard]] auto bootstrap_threshold(
+    CursorRange&& cursors,
+    std::uint64_t max_docid,
+    std::size_t k,
+    QueryContext& context,
+    std::size_t max_postings = default_bootstrap_postings
+) -> Score {
+    if (k == 0 || cursors.empty()) {
+        return 0.0F;
+    }
+    auto& topk = context.topk(k);
+    auto& query_budget = context.budget();
+    auto remaining = query_budget.max_postings()
+        - std::min(query_budget.processed_postings(), query_budget.max_postings());
+    auto budget = QueryBudget::postings(std::min(max_postings, remaining));
+    block_max_ranked_and_query conjunctive_q(topk, context.resource(), budget);
+    conjunctive_q(cursors, max_docid);
+    query_budget.charge(budget.processed_postings());
+    if (topk.size() < k) {
+        return 0.0F;
+    }
+    auto rounding =
+        2.0F * static_cast<Score>(cursors.size()) * std::numeric_limits<Score>::epsilon();
+    return topk.true_threshold() * (1.0F - rounding);
+}
+
+}  // namespace pisa
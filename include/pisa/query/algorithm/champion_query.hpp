@@ -0,0 +1,108 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+
+#include "champion_lists.hpp"
+#include "concepts/posting_cursor.hpp"
+#include "query.hpp"
+#include "query/query_context.hpp"
+#include "topk_queue.hpp"
+#include "type_alias.hpp"
+
+namespace pisa {
+
+/**
+ * Answers a single-term query from the champion list of its term, inserting the results into
+ * `topk`. If `weighted` is `true`, the scores are multiplied by the term weight.
+ *
+ * Returns `false`, leaving `topk` unchanged, if the query does not have exactly one term, or the
+ * champion list of the term does not cover the capacity of `topk` (see `ChampionLists::covers`).
+ */
+[[nodiscard]] inline auto champion_query(
+    ChampionLists const& lists, Query const& query, topk_queue& topk, bool weighted = false
+) -> bool {
+    if (query.terms().size() != 1) {
+        return false;
+    }
+    auto const& term = query.terms().front();
+    if (!lists.covers(term.id, topk.capacity())) {
+        return false;
+    }
+    auto weight = weighted ? term.weight : 1.0F;
+    for (auto const& [docid, score]: lists.champions(term.id)) {
+        if (!topk.insert(score * weight, docid)) {
+            // The entries are sorted by decreasing score, so no other can enter either.
+            break;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns a lower bound on the score of the `k`-th result of the query over the given cursors,
+ * or 0 if none is found.
+ *
+ * The candidates are the documents of the top `k` entries of the champion list of each query
+ * term. They are scored with the cursors, which must be given in the order of the query terms,
+ * and the `k`-th highest of their scores is returned, lowered by the rounding error that summing
+ * the term scores in a different order can introduce. If `conjunctive` is `true`, only the
+ * candidates matching all terms are counted, so that the bound is valid for conjunctive queries.
+ *
+ * The cursors are consumed. The top-k queue of the context is used to select the scores, and the
+ * candidates are allocated from its arena.
+ */
+template <typename CursorRange>
+    requires(
+        concepts::ScoredPostingCursor<pisa::val_t<CursorRange>>
+        && concepts::SortedPostingCursor<pisa::val_t<CursorRange>>
+    )
+[[nodiscard]] auto champion_threshold(
+    CursorRange&& cursors,
+    ChampionLists const& lists,
+    Query const& query,
+    std::size_t k,
+    QueryContext& context,
+    bool conjunctive = false
+) -> Score {
+    if (k == 0 || cursors.empty()) {
+        return 0.0F;
+    }
+    std::pmr::vector<DocId> candidates(context.resource());
+    for (auto const& term: query.terms()) {
+        auto champions = lists.champions(term.id);
+        for (auto const& entry: champions.first(std::min(k, champions.size()))) {
+            candidates.push_back(entry.docid);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    auto& topk = context.topk(k);
+    for (auto docid: candidates) {
+        Score score = 0.0F;
+        bool matches_all = true;
+        for (auto& cursor: cursors) {
+            cursor.next_geq(docid);
+            if (cursor.docid() == docid) {
+                score += cursor.score();
+            } else {
+                matches_all = false;
+            }
+        }
+        if (matches_all || !conjunctive) {
+            topk.insert(score, docid);
+        }
+    }
+    if (topk.size() < k) {
+        return 0.0F;
+    }
+    auto rounding =
+        2.0F * static_cast<Score>(cursors.size()) * std::numeric_limits<Score>::epsilon();
+    return topk.true_threshold() * (1.0F - rounding);
+}
+
+}  // namespace pisa
@@ -3,9 +3,12 @@
 #include <algorithm>
 #include <numeric>
 #include <utility>
+#include <memory_resource>
 #include <vector>
 
 #include "concepts/posting_cursor.hpp"
+#include "cursor/buffered_scored_cursor.hpp"
+#include "query/query_context.hpp"
 #include "topk_queue.hpp"
 #include "util/compiler_attribute.hpp"
 
@@ -14,19 +17,27 @@ namespace pisa {
 struct maxscore_query {
     explicit maxscore_query(topk_queue& topk) : m_topk(topk) {}
 
+    /**
+     * Allocates the auxiliary data of a query from the arena of the context, and stops when the
+     * budget of the context runs out.
+     */
+    maxscore_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_resource(context.resource()), m_budget(&context.budget()) {}
+
     template <typename Cursors>
         requires((
             concepts::MaxScorePostingCursor<pisa::val_t<Cursors>>
             && concepts::SortedPostingCursor<pisa::val_t<Cursors>>
         ))
     [[nodiscard]] PISA_ALWAYSINLINE auto sorted(Cursors&& cursors)
-        -> std::vector<pisa::val_t<Cursors>> {
-        std::vector<std::size_t> term_positions(cursors.size());
+        -> std::pmr::vector<pisa::val_t<Cursors>> {
+        std::pmr::vector<std::size_t> term_positions(cursors.size(), m_resource);
         std::iota(term_positions.begin(), term_positions.end(), 0);
         std::sort(term_positions.begin(), term_positions.end(), [&](auto&& lhs, auto&& rhs) {
             return cursors[lhs].max_score() > cursors[rhs].max_score();
         });
-        std::vector<pisa::val_t<Cursors>> sorted;
+        std::pmr::vector<pisa::val_t<Cursors>> sorted(m_resource);
+        sorted.reserve(cursors.size());
         for (auto pos: term_positions) {
             sorted.push_back(std::move(cursors[pos]));
         };
@@ -35,8 +46,9 @@ struct maxscore_query {
 
     template <typename Cursors>
         requires(concepts::MaxScorePostingCursor<pisa::val_t<Cursors>>)
-    [[nodiscard]] PISA_ALWAYSINLINE auto calc_upper_bounds(Cursors&& cursors) -> std::vector<float> {
-        std::vector<float> upper_bounds(cursors.size());
+    [[nodiscard]] PISA_ALWAYSINLINE auto calc_upper_bounds(Cursors&& cursors)
+        -> std::pmr::vector<float> {
+        std::pmr::vector<float> upper_bounds(cursors.size(), m_resource);
         auto out = upper_bounds.rbegin();
         float bound = 0.0;
         for (auto pos = cursors.rbegin(); pos != cursors.rend(); ++pos) {
@@ -108,6 +120,11 @@ struct maxscore_query {
                     }
                 });
 
+                // each candidate is charged the postings of the essential lists
+                auto essential = std::distance(cursors.begin(), first_lookup);
+                bool exhausted = m_budget != nullptr
+                    && m_budget->charge(static_cast<std::size_t>(essential));
+
                 status = DocumentStatus::Insert;
                 auto lookup_bound = first_upper_bound;
                 for (auto pos = first_lookup; pos != cursors.end(); ++pos, ++lookup_bound) {
@@ -121,6 +138,17 @@ struct maxscore_query {
                         current_score += cursor.score();
                     }
                 }
+                // the candidate is finished first, so that running out of budget on the very last
+                // one leaves nothing undone
+                if (exhausted) [[unlikely]] {
+                    if (status == DocumentStatus::Insert) {
+                        m_topk.insert(current_score, current_docid);
+                    }
+                    if (next_docid < max_docid) {
+                        m_topk.mark_incomplete();
+                    }
+                    return;
+                }
             }
             if (m_topk.insert(current_score, current_docid)
                 && update_non_essential_lists() == UpdateResult::ShortCircuit) {
@@ -136,14 +164,22 @@ struct maxscore_query {
             return;
         }
         auto cursors = sorted(cursors_);
-        run_sorted(cursors, max_docid);
-        std::swap(cursors, cursors_);
+        if constexpr (concepts::BlockScoredPostingCursor<pisa::val_t<Cursors>>) {
+            // Essential lists are traversed with `next()` and scored a block at a time.
+            auto buffered = make_buffered_scored_cursors(cursors, max_docid, m_resource);
+            run_sorted(buffered, max_docid);
+        } else {
+            run_sorted(cursors, max_docid);
+        }
+        std::move(cursors.begin(), cursors.end(), cursors_.begin());
     }
 
     std::vector<typename topk_queue::entry_type> const& topk() const { return m_topk.topk(); }
 
   private:
     topk_queue& m_topk;
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
+    QueryBudget* m_budget = nullptr;
 };
 
 }  // namespace pisa
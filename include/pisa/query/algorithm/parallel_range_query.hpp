@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+
+#include "topk_queue.hpp"
+
+namespace pisa {
+
+/**
+ * Processes a single query in parallel by partitioning the document ID space into ranges.
+ *
+ * Each range is processed by `QueryAlg` on its own cursors: they are created with the cursor
+ * factory passed to `operator()`, and moved to the beginning of the range with `next_geq`.
+ * Each worker thread accumulates results in its own top-k queue, but all the queues share a single
+ * threshold, so that pruning in one range benefits from the progress in the others. The queues
+ * are merged into the queue passed to the constructor at the end; the caller still needs to call
+ * `finalize()` on it.
+ *
+ * Like with a sequential algorithm, the scores of the returned documents are exact, but documents
+ * tied with the k-th score may be resolved differently.
+ */
+template <typename QueryAlg>
+struct parallel_range_query {
+    explicit parallel_range_query(topk_queue& topk) : m_topk(topk) {}
+
+    template <typename CursorFactory>
+    void
+    operator()(CursorFactory&& make_cursors, std::uint64_t max_docid, std::size_t range_count) {
+        range_count =
+            std::clamp<std::uint64_t>(range_count, 1, std::max<std::uint64_t>(max_docid, 1));
+        SharedThreshold threshold;
+        tbb::enumerable_thread_specific<topk_queue> queues([&] {
+            topk_queue topk(m_topk.capacity(), m_topk.initial_threshold());
+            topk.share_threshold(threshold);
+            return topk;
+        });
+        tbb::parallel_for(std::size_t{0}, range_count, [&](std::size_t range) {
+            auto first = max_docid * range / range_count;
+            auto last = max_docid * (range + 1) / range_count;
+            auto cursors = make_cursors();
+            if (cursors.empty()) {
+                return;
+            }
+            for (auto& cursor: cursors) {
+                cursor.next_geq(first);
+            }
+            QueryAlg query_alg(queues.local());
+            query_alg(cursors, last);
+        });
+        for (auto const& queue: queues) {
+            for (auto const& [score, docid]: queue.topk()) {
+                m_topk.insert(score, docid);
+            }
+        }
+    }
+
+    std::vector<typename topk_queue::entry_type> const& topk() const { return m_topk.topk(); }
+
+  private:
+    topk_queue& m_topk;
+};
+
+}  // namespace pisa
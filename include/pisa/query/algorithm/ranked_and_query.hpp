@@ -1,15 +1,29 @@
 #pragma once
 
+#include <memory_resource>
+#include <span>
 #include <vector>
 
 #include "concepts/posting_cursor.hpp"
+#include "query/algorithm/bitmap_intersection.hpp"
+#include "query/query_context.hpp"
 #include "topk_queue.hpp"
 
 namespace pisa {
 
+/**
+ * Ranked conjunctive query: scores the documents in the intersection of all query terms.
+ *
+ * If some of the lists are dense, they are intersected as bitmaps (see `bitmap_intersection`),
+ * and a dense list is only decoded at the documents in the intersection, to score them.
+ */
 struct ranked_and_query {
     explicit ranked_and_query(topk_queue& topk) : m_topk(topk) {}
 
+    /** Allocates the auxiliary data of a query from the arena of the context. */
+    ranked_and_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_resource(context.resource()) {}
+
     template <typename CursorRange>
         requires((
             concepts::ScoredPostingCursor<pisa::val_t<CursorRange>>
@@ -21,7 +35,7 @@ struct ranked_and_query {
             return;
         }
 
-        std::vector<Cursor*> ordered_cursors;
+        std::pmr::vector<Cursor*> ordered_cursors(m_resource);
         ordered_cursors.reserve(cursors.size());
         for (auto& en: cursors) {
             ordered_cursors.push_back(&en);
@@ -32,6 +46,22 @@ struct ranked_and_query {
             return lhs->size() < rhs->size();
         });
 
+        if constexpr (concepts::DensePostingCursor<Cursor>) {
+            auto score_match = [&](std::uint64_t docid) {
+                float score = 0;
+                for (auto* cursor: ordered_cursors) {
+                    cursor->next_geq(docid);
+                    score += cursor->score();
+                }
+                m_topk.insert(score, docid);
+            };
+            if (bitmap_intersection(
+                    std::span<Cursor* const>(ordered_cursors), max_docid, m_resource, score_match
+                )) {
+                return;
+            }
+        }
+
         uint64_t candidate = ordered_cursors[0]->docid();
         size_t i = 1;
         while (candidate < max_docid) {
@@ -64,6 +94,7 @@ struct ranked_and_query {
 
   private:
     topk_queue& m_topk;
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
 };
 
 }  // namespace pisa
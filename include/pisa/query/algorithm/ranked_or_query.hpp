@@ -1,8 +1,11 @@
 #pragma once
 
+#include <memory_resource>
 #include <vector>
 
 #include "concepts/posting_cursor.hpp"
+#include "cursor/buffered_scored_cursor.hpp"
+#include "query/query_context.hpp"
 #include "topk_queue.hpp"
 
 namespace pisa {
@@ -16,16 +19,33 @@ namespace pisa {
 struct ranked_or_query {
     explicit ranked_or_query(topk_queue& topk) : m_topk(topk) {}
 
+    /** Allocates the auxiliary data of a query from the arena of the context. */
+    ranked_or_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_resource(context.resource()) {}
+
     template <typename CursorRange>
         requires((
             concepts::ScoredPostingCursor<pisa::val_t<CursorRange>>
             && concepts::SortedPostingCursor<pisa::val_t<CursorRange>>
         ))
     void operator()(CursorRange&& cursors, uint64_t max_docid) {
-        using Cursor = typename std::decay_t<CursorRange>::value_type;
         if (cursors.empty()) {
             return;
         }
+        if constexpr (concepts::BlockScoredPostingCursor<pisa::val_t<CursorRange>>) {
+            auto buffered = make_buffered_scored_cursors(cursors, max_docid, m_resource);
+            run(buffered, max_docid);
+        } else {
+            run(cursors, max_docid);
+        }
+    }
+
+    std::vector<typename topk_queue::entry_type> const& topk() const { return m_topk.topk(); }
+
+  private:
+    template <typename CursorRange>
+    void run(CursorRange&& cursors, uint64_t max_docid) {
+        using Cursor = typename std::decay_t<CursorRange>::value_type;
         uint64_t cur_doc =
             std::min_element(cursors.begin(), cursors.end(), [](Cursor const& lhs, Cursor const& rhs) {
                 return lhs.docid() < rhs.docid();
@@ -49,10 +69,8 @@ struct ranked_or_query {
         }
     }
 
-    std::vector<typename topk_queue::entry_type> const& topk() const { return m_topk.topk(); }
-
-  private:
     topk_queue& m_topk;
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
 };
 
 }  // namespace pisa
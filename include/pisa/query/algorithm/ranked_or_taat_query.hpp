@@ -1,7 +1,12 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+
 #include "accumulator/partial_score_accumulator.hpp"
+#include "buffered_topk_queue.hpp"
 #include "concepts/posting_cursor.hpp"
+#include "query/query_context.hpp"
 #include "topk_queue.hpp"
 
 namespace pisa {
@@ -10,6 +15,24 @@ class ranked_or_taat_query {
   public:
     explicit ranked_or_taat_query(topk_queue& topk) : m_topk(topk) {}
 
+    /**
+     * Collects the accumulated scores through `buffer`, which inserts them in batches, and then
+     * moves the resulting top-k documents to `topk`.
+     */
+    ranked_or_taat_query(topk_queue& topk, buffered_topk_queue& buffer)
+        : m_topk(topk), m_buffer(&buffer) {}
+
+    /**
+     * Stops accumulating when the budget of the context runs out; the documents accumulated so
+     * far are still collected.
+     */
+    ranked_or_taat_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_budget(&context.budget()) {}
+
+    /** Collects through `buffer`, and stops accumulating when the context's budget runs out. */
+    ranked_or_taat_query(topk_queue& topk, buffered_topk_queue& buffer, QueryContext& context)
+        : m_topk(topk), m_buffer(&buffer), m_budget(&context.budget()) {}
+
     template <typename CursorRange, typename Acc>
         requires((
             PartialScoreAccumulator<Acc> && concepts::ScoredPostingCursor<pisa::val_t<CursorRange>>
@@ -21,19 +44,75 @@ class ranked_or_taat_query {
         }
         accumulator.reset();
 
-        for (auto&& cursor: cursors) {
+        for (auto cursor = cursors.begin(); cursor != cursors.end(); ++cursor) {
+            if (!accumulate(*cursor, max_docid, accumulator)) {
+                // the budget may run out on the very last posting, which leaves nothing undone
+                if (std::any_of(cursor, cursors.end(), [max_docid](auto const& remaining) {
+                        return remaining.docid() < max_docid;
+                    })) {
+                    m_topk.mark_incomplete();
+                }
+                break;
+            }
+        }
+        if (m_buffer != nullptr) {
+            // any score that cannot enter `m_topk`, e.g., below a shared threshold, is skipped
+            m_buffer->reset(m_topk.capacity(), m_topk.effective_threshold());
+            accumulator.collect(*m_buffer);
+            m_buffer->finalize();
+            for (auto const& [score, docid]: m_buffer->topk()) {
+                m_topk.insert(score, docid);
+            }
+        } else {
+            accumulator.collect(m_topk);
+        }
+    }
+
+    std::vector<typename topk_queue::entry_type> const& topk() const { return m_topk.topk(); }
+
+  private:
+    /**
+     * Accumulates the postings of the cursor, and returns `false` if the budget ran out first.
+     * The budget is charged once per block of postings.
+     */
+    template <typename Cursor, typename Acc>
+    auto accumulate(Cursor& cursor, uint64_t max_docid, Acc& accumulator) -> bool {
+        if constexpr (concepts::BlockScoredPostingCursor<Cursor>) {
+            std::array<DocId, Cursor::max_block_size> docids;
+            std::array<Score, Cursor::max_block_size> scores;
+            while (auto size = cursor.score_block(docids, scores, max_docid)) {
+                for (std::size_t idx = 0; idx < size; ++idx) {
+                    accumulator.accumulate(docids[idx], scores[idx]);
+                }
+                if (m_budget != nullptr && m_budget->charge(size)) {
+                    return false;
+                }
+            }
+        } else {
+            std::size_t postings = 0;
             while (cursor.docid() < max_docid) {
                 accumulator.accumulate(cursor.docid(), cursor.score());
                 cursor.next();
+                if (++postings == charge_interval) {
+                    if (m_budget != nullptr && m_budget->charge(postings)) {
+                        return false;
+                    }
+                    postings = 0;
+                }
+            }
+            if (m_budget != nullptr && m_budget->charge(postings)) {
+                return false;
             }
         }
-        accumulator.collect(m_topk);
+        return true;
     }
 
-    std::vector<typename topk_queue::entry_type> const& topk() const { return m_topk.topk(); }
+    /** The number of postings charged at once by cursors that are not scored in blocks. */
+    constexpr static std::size_t charge_interval = 128;
 
-  private:
     topk_queue& m_topk;
+    buffered_topk_queue* m_buffer = nullptr;
+    QueryBudget* m_budget = nullptr;
 };
 
 };  // namespace pisa
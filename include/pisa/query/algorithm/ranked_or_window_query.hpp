@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "concepts/posting_cursor.hpp"
+#include "query/query_context.hpp"
+#include "topk_queue.hpp"
+
+namespace pisa {
+
+/**
+ * Top-k disjunctive retrieval processing the document ID space in windows.
+ *
+ * The lists are split into essential and non-essential ones like in `maxscore_query`. For each
+ * window of `range_size` documents, all postings of the essential lists are scored into a
+ * window-local array of scores and a bitset of the documents found (term-at-a-time within the
+ * window), which fit in cache for the default window size. Then, the documents are collected in
+ * order, and their scores are completed with the non-essential lists while they can still enter
+ * the top-k.
+ *
+ * Before a window is processed, the sum of the maximum scores of the lists within the window is
+ * compared with the threshold; if the window cannot contain a top-k document, it is skipped. For
+ * cursors with block-max scores, the maximum score of a list within a window is the highest
+ * block-max score of the blocks overlapping the window; otherwise, it is the max score of the list.
+ */
+struct ranked_or_window_query {
+    constexpr static std::size_t default_range_size = 4096;
+
+    explicit ranked_or_window_query(topk_queue& topk) : m_topk(topk) {}
+
+    /** Allocates the auxiliary data of a query from the arena of the context. */
+    ranked_or_window_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_resource(context.resource()) {}
+
+    template <typename CursorRange>
+        requires((
+            concepts::MaxScorePostingCursor<pisa::val_t<CursorRange>>
+            && concepts::SortedPostingCursor<pisa::val_t<CursorRange>>
+        ))
+    void operator()(
+        CursorRange&& cursors, std::uint64_t max_docid, std::size_t range_size = default_range_size
+    ) {
+        using Cursor = pisa::val_t<CursorRange>;
+        if (cursors.empty()) {
+            return;
+        }
+
+        std::pmr::vector<Cursor*> ordered_cursors(m_resource);
+        ordered_cursors.reserve(cursors.size());
+        for (auto& cursor: cursors) {
+            ordered_cursors.push_back(&cursor);
+        }
+        std::sort(ordered_cursors.begin(), ordered_cursors.end(), [](Cursor* lhs, Cursor* rhs) {
+            return lhs->max_score() < rhs->max_score();
+        });
+
+        std::pmr::vector<float> upper_bounds(ordered_cursors.size(), m_resource);
+        upper_bounds[0] = ordered_cursors[0]->max_score();
+        for (std::size_t i = 1; i < ordered_cursors.size(); ++i) {
+            upper_bounds[i] = upper_bounds[i - 1] + ordered_cursors[i]->max_score();
+        }
+
+        std::pmr::vector<float> window_scores(range_size, 0.0F, m_resource);
+        std::pmr::vector<std::uint64_t> window_docs((range_size + 63) / 64, 0, m_resource);
+
+        std::size_t non_essential_lists = 0;
+        auto update_non_essential_lists = [&] {
+            while (non_essential_lists < ordered_cursors.size()
+                   && !m_topk.would_enter(upper_bounds[non_essential_lists])) {
+                non_essential_lists += 1;
+            }
+        };
+        update_non_essential_lists();
+
+        for (std::uint64_t begin = 0;
+             begin < max_docid && non_essential_lists < ordered_cursors.size();
+             begin += range_size) {
+            auto end = std::min<std::uint64_t>(begin + range_size, max_docid);
+
+            float window_bound = 0.0F;
+            for (auto* cursor: ordered_cursors) {
+                cursor->next_geq(begin);
+                if (cursor->docid() < end) {
+                    window_bound += window_max_score(*cursor, begin, end);
+                }
+            }
+            if (!m_topk.would_enter(window_bound)) {
+                continue;
+            }
+
+            // Lists that become non-essential while collecting have been scored already.
+            auto window_non_essential_lists = non_essential_lists;
+            for (std::size_t i = window_non_essential_lists; i < ordered_cursors.size(); ++i) {
+                accumulate(*ordered_cursors[i], begin, end, window_scores, window_docs);
+            }
+
+            for (std::size_t word = 0; word < window_docs.size(); ++word) {
+                auto bits = window_docs[word];
+                window_docs[word] = 0;
+                while (bits != 0) {
+                    auto pos = word * 64 + std::countr_zero(bits);
+                    bits &= bits - 1;
+                    auto docid = static_cast<std::uint32_t>(begin + pos);
+                    float score = std::exchange(window_scores[pos], 0.0F);
+                    for (auto i = window_non_essential_lists; i > 0; --i) {
+                        if (!m_topk.would_enter(score + upper_bounds[i - 1])) {
+                            break;
+                        }
+                        ordered_cursors[i - 1]->next_geq(docid);
+                        if (ordered_cursors[i - 1]->docid() == docid) {
+                            score += ordered_cursors[i - 1]->score();
+                        }
+                    }
+                    if (m_topk.insert(score, docid)) {
+                        update_non_essential_lists();
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<typename topk_queue::entry_type> const& topk() const { return m_topk.topk(); }
+
+  private:
+    /** Scores all postings of the cursor in `[begin, end)` into the window. */
+    template <typename Cursor>
+    static void accumulate(
+        Cursor& cursor,
+        std::uint64_t begin,
+        std::uint64_t end,
+        std::pmr::vector<float>& window_scores,
+        std::pmr::vector<std::uint64_t>& window_docs
+    ) {
+        auto add = [&](std::uint64_t docid, float score) {
+            auto pos = docid - begin;
+            window_scores[pos] += score;
+            window_docs[pos / 64] |= std::uint64_t(1) << (pos % 64);
+        };
+        if constexpr (concepts::BlockScoredPostingCursor<Cursor>) {
+            std::array<DocId, Cursor::max_block_size> docids;
+            std::array<Score, Cursor::max_block_size> scores;
+            while (auto size = cursor.score_block(docids, scores, static_cast<DocId>(end))) {
+                for (std::size_t idx = 0; idx < size; ++idx) {
+                    add(docids[idx], scores[idx]);
+                }
+            }
+        } else {
+            while (cursor.docid() < end) {
+                add(cursor.docid(), cursor.score());
+                cursor.next();
+            }
+        }
+    }
+
+    /** Returns an upper bound on the scores of the cursor's postings in `[begin, end)`. */
+    template <typename Cursor>
+    [[nodiscard]] static auto
+    window_max_score(Cursor& cursor, std::uint64_t begin, std::uint64_t end) -> float {
+        if constexpr (concepts::BlockMaxPostingCursor<Cursor>) {
+            if (cursor.block_max_docid() < begin) {
+                cursor.block_max_next_geq(begin);
+            }
+            float score = cursor.block_max_score();
+            while (cursor.block_max_docid() + 1 < end) {
+                auto last = cursor.block_max_docid();
+                cursor.block_max_next_geq(last + 1);
+                if (cursor.block_max_docid() == last) {
+                    break;
+                }
+                score = std::max(score, cursor.block_max_score());
+            }
+            return score;
+        } else {
+            return cursor.max_score();
+        }
+    }
+
+    topk_queue& m_topk;
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
+};
+
+}  // namespace pisa
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <vector>
+
+#include "accumulator/partial_score_accumulator.hpp"
+#include "impact_ordered_index.hpp"
+#include "query.hpp"
+#include "query/query_context.hpp"
+#include "topk_queue.hpp"
+
+namespace pisa {
+
+/**
+ * Score-at-a-time disjunctive retrieval over an `ImpactOrderedIndex`.
+ *
+ * The segments of all query terms are merged in decreasing order of their (weighted) impacts, and
+ * the impact of each segment is added to the scores of its documents in the accumulator. Because
+ * the highest impacts are processed first, the scores converge to the final ranking early, and
+ * processing can be stopped when the budget of the query context runs out, with a good
+ * approximation of the top-k documents (anytime ranking). The budget is charged after each
+ * segment, so a started segment is always processed entirely. Without a budget, the results are
+ * exactly the ones of a disjunctive query with the quantized scores.
+ *
+ * Impacts are integers, so `QuantizedAccumulator` is a natural choice of accumulator; it sums the
+ * scores exactly with `std::uint32_t` lanes, as long as the query term weights are integers.
+ */
+class saat_query {
+  public:
+    explicit saat_query(topk_queue& topk) : m_topk(topk) {}
+
+    /**
+     * Allocates the merged segment order from the arena of the context, and stops when the
+     * budget of the context runs out.
+     */
+    saat_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_resource(context.resource()), m_budget(&context.budget()) {}
+
+    template <typename Acc>
+        requires(PartialScoreAccumulator<Acc>)
+    void operator()(
+        ImpactOrderedIndex const& index,
+        Query const& query,
+        Acc&& accumulator,
+        bool weighted = false
+    ) {
+        m_processed_postings = 0;
+        if (query.terms().empty()) {
+            return;
+        }
+        accumulator.reset();
+
+        std::pmr::vector<WeightedSegment> segments(m_resource);
+        for (WeightedTerm const& term: query.terms()) {
+            float weight = weighted ? term.weight : 1.0F;
+            for (auto const& segment: index.segments(term.id)) {
+                segments.push_back({static_cast<float>(segment.impact) * weight, &segment});
+            }
+        }
+        std::sort(segments.begin(), segments.end(), [](auto const& lhs, auto const& rhs) {
+            return lhs.score > rhs.score;
+        });
+
+        for (auto pos = segments.begin(); pos != segments.end(); ++pos) {
+            for (auto docid: index.documents(*pos->segment)) {
+                accumulator.accumulate(docid, pos->score);
+            }
+            m_processed_postings += pos->segment->size;
+            if (m_budget != nullptr && m_budget->charge(pos->segment->size)
+                && std::next(pos) != segments.end()) {
+                m_topk.mark_incomplete();
+                break;
+            }
+        }
+        accumulator.collect(m_topk);
+    }
+
+    /** The number of postings processed by the last query. */
+    [[nodiscard]] auto processed_postings() const noexcept -> std::size_t {
+        return m_processed_postings;
+    }
+
+    std::vector<typename topk_queue::entry_type> const& topk() const { return m_topk.topk(); }
+
+  private:
+    struct WeightedSegment {
+        float score;
+        ImpactSegment const* segment;
+    };
+
+    topk_queue& m_topk;
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
+    QueryBudget* m_budget = nullptr;
+    std::size_t m_processed_postings = 0;
+};
+
+}  // namespace pisa
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <memory_resource>
 #include <vector>
 
 #include "concepts/posting_cursor.hpp"
+#include "query/query_context.hpp"
 #include "topk_queue.hpp"
 
 namespace pisa {
@@ -10,6 +13,13 @@ namespace pisa {
 struct wand_query {
     explicit wand_query(topk_queue& topk) : m_topk(topk) {}
 
+    /**
+     * Allocates the auxiliary data of a query from the arena of the context, and stops when the
+     * budget of the context runs out.
+     */
+    wand_query(topk_queue& topk, QueryContext& context)
+        : m_topk(topk), m_resource(context.resource()), m_budget(&context.budget()) {}
+
     template <typename CursorRange>
         requires((
             concepts::MaxScorePostingCursor<pisa::val_t<CursorRange>>
@@ -21,7 +31,7 @@ struct wand_query {
             return;
         }
 
-        std::vector<Cursor*> ordered_cursors;
+        std::pmr::vector<Cursor*> ordered_cursors(m_resource);
         ordered_cursors.reserve(cursors.size());
         for (auto& en: cursors) {
             ordered_cursors.push_back(&en);
@@ -34,6 +44,15 @@ struct wand_query {
             });
         };
 
+        // the budget may run out on the very last posting, which leaves nothing undone
+        auto mark_if_unfinished = [&]() {
+            if (std::any_of(ordered_cursors.begin(), ordered_cursors.end(), [&](Cursor* cursor) {
+                    return cursor->docid() < max_docid;
+                })) {
+                m_topk.mark_incomplete();
+            }
+        };
+
         sort_enums();
         while (true) {
             // find pivot
@@ -60,15 +79,21 @@ struct wand_query {
             uint64_t pivot_id = ordered_cursors[pivot]->docid();
             if (pivot_id == ordered_cursors[0]->docid()) {
                 float score = 0;
+                std::size_t postings = 0;
                 for (Cursor* en: ordered_cursors) {
                     if (en->docid() != pivot_id) {
                         break;
                     }
                     score += en->score();
                     en->next();
+                    ++postings;
                 }
 
                 m_topk.insert(score, pivot_id);
+                if (m_budget != nullptr && m_budget->charge(postings)) {
+                    mark_if_unfinished();
+                    break;
+                }
                 // resort by docid
                 sort_enums();
             } else {
@@ -77,6 +102,10 @@ struct wand_query {
                 for (; ordered_cursors[next_list]->docid() == pivot_id; --next_list) {
                 }
                 ordered_cursors[next_list]->next_geq(pivot_id);
+                if (m_budget != nullptr && m_budget->charge(1)) {
+                    mark_if_unfinished();
+                    break;
+                }
                 // bubble down the advanced list
                 for (size_t i = next_list + 1; i < ordered_cursors.size(); ++i) {
                     if (ordered_cursors[i]->docid() < ordered_cursors[i - 1]->docid()) {
@@ -93,6 +122,8 @@ struct wand_query {
 
   private:
     topk_queue& m_topk;
+    std::pmr::memory_resource* m_resource = std::pmr::get_default_resource();
+    QueryBudget* m_budget = nullptr;
 };
 
 }  // namespace pisa
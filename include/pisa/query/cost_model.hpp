@@ -0,0 +1,163 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "query.hpp"
+
+namespace pisa {
+
+/**
+ * Features of a query that can be computed before processing it, from the sizes of its posting
+ * lists and the maximum scores of its terms.
+ *
+ * - `terms`: number of terms,
+ * - `sum_postings`, `min_postings`, `max_postings`: total, smallest, and largest list size,
+ * - `conjunctive_postings`: smallest list size times the number of terms, which approximates the
+ *   cost of an intersection,
+ * - `sum_of_logs` and `max_b`: sum of `log2(size + 1)` and bit width of the largest size, as
+ *   defined for the decoding time features in `dec_time_prediction.hpp`,
+ * - `score_skew`: the largest maximum term score divided by their sum; close to 1 when a single
+ *   term dominates the scores, which favors dynamic pruning.
+ */
+struct QueryFeatures {
+    constexpr static std::array<std::string_view, 8> names{
+        "terms",
+        "sum_postings",
+        "min_postings",
+        "max_postings",
+        "conjunctive_postings",
+        "sum_of_logs",
+        "max_b",
+        "score_skew",
+    };
+    constexpr static std::size_t size = names.size();
+
+    std::array<double, size> values{};
+};
+
+/**
+ * Computes the features of a query with the given list sizes and maximum term scores, one per
+ * query term.
+ *
+ * Throws `std::invalid_argument` if the spans differ in size.
+ */
+[[nodiscard]] auto query_features(
+    std::span<std::uint32_t const> list_sizes, std::span<float const> max_term_scores
+) -> QueryFeatures;
+
+/**
+ * Computes the features of a query, reading the list sizes from the index cursors and the maximum
+ * term scores from the WAND data. If `weighted` is `true`, the maximum scores are multiplied by
+ * the term weights.
+ */
+template <typename Index, typename Wand>
+[[nodiscard]] auto
+query_features(Index const& index, Wand const& wdata, Query const& query, bool weighted = false)
+    -> QueryFeatures {
+    std::vector<std::uint32_t> list_sizes;
+    std::vector<float> max_term_scores;
+    list_sizes.reserve(query.terms().size());
+    max_term_scores.reserve(query.terms().size());
+    for (auto const& term: query.terms()) {
+        list_sizes.push_back(static_cast<std::uint32_t>(index[term.id].size()));
+        max_term_scores.push_back(
+            wdata.max_term_weight(term.id) * (weighted ? term.weight : 1.0F)
+        );
+    }
+    return query_features(list_sizes, max_term_scores);
+}
+
+/**
+ * Linear model predicting the cost of processing a query with a particular algorithm from its
+ * features: `bias + sum(weights[i] * features[i])`.
+ */
+class CostPredictor {
+  public:
+    using weights_type = std::array<double, QueryFeatures::size>;
+
+    CostPredictor() = default;
+    CostPredictor(double bias, weights_type weights);
+
+    /**
+     * Fits a predictor to observed costs by ridge regression on standardized features.
+     *
+     * Throws `std::invalid_argument` if there are no observations or the numbers of features and
+     * costs differ.
+     */
+    [[nodiscard]] static auto
+    fit(std::span<QueryFeatures const> features, std::span<double const> costs, double ridge = 1e-6)
+        -> CostPredictor;
+
+    [[nodiscard]] auto operator()(QueryFeatures const& features) const -> double;
+    [[nodiscard]] auto bias() const noexcept -> double { return m_bias; }
+    [[nodiscard]] auto weights() const noexcept -> weights_type const& { return m_weights; }
+
+  private:
+    double m_bias = 0.0;
+    weights_type m_weights{};
+};
+
+/**
+ * Per-algorithm cost predictors used to choose the algorithm expected to process a query the
+ * fastest.
+ *
+ * A model is stored as text, one coefficient per line: the algorithm name, the feature name (or
+ * `bias`), and the value, separated by whitespace. Coefficients that are not listed are 0.
+ */
+class CostModel {
+  public:
+    /** Sets the predictor of the algorithm, replacing the existing one, if any. */
+    void add(std::string algorithm, CostPredictor predictor);
+
+    /** The algorithms in the order in which they were added. */
+    [[nodiscard]] auto algorithms() const -> std::vector<std::string>;
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return m_predictors.size(); }
+    [[nodiscard]] auto empty() const noexcept -> bool { return m_predictors.empty(); }
+
+    /**
+     * Returns the predicted cost of processing a query with the given algorithm.
+     *
+     * Throws `std::invalid_argument` if the model has no predictor for the algorithm.
+     */
+    [[nodiscard]] auto predict(std::string_view algorithm, QueryFeatures const& features) const
+        -> double;
+
+    /**
+     * Returns the position (in `algorithms()`) of the algorithm with the lowest predicted cost.
+     * Ties are resolved in favor of the algorithm added first.
+     *
+     * Throws `std::logic_error` if the model is empty.
+     */
+    [[nodiscard]] auto select(QueryFeatures const& features) const -> std::size_t;
+
+    /** Throws `std::invalid_argument` if the input is not a valid model. */
+    [[nodiscard]] static auto read(std::istream& in) -> CostModel;
+    void write(std::ostream& out) const;
+
+  private:
+    std::vector<std::pair<std::string, CostPredictor>> m_predictors;
+};
+
+}  // namespace pisa
@@ -0,0 +1,127 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <optional>
+
+namespace pisa {
+
+/**
+ * Cooperative limit on the work done by a single query.
+ *
+ * Query algorithms report the postings they process with `charge()`, and stop as soon as it
+ * returns `true`, leaving the best results found so far in the top-k queue (which they then mark
+ * as incomplete). A query is stopped once it has processed `max_postings()` postings, or once the
+ * time limit has passed since `start()`. Reading the clock is comparatively expensive, so it is
+ * only done every `clock_interval` postings; a query can therefore overrun its deadline by the
+ * time it takes to process that many postings.
+ *
+ * A default-constructed budget is unlimited, and charging it costs one addition and comparison.
+ */
+class QueryBudget {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    /** The number of postings processed between reads of the clock. */
+    constexpr static std::size_t clock_interval = 1024;
+
+    QueryBudget() = default;
+
+    explicit QueryBudget(
+        std::size_t max_postings, std::optional<clock::duration> time_limit = std::nullopt
+    )
+        : m_max_postings(max_postings), m_time_limit(time_limit) {
+        start();
+    }
+
+    /** Returns a budget with only a time limit. */
+    [[nodiscard]] static auto time(clock::duration time_limit) -> QueryBudget {
+        return QueryBudget(std::numeric_limits<std::size_t>::max(), time_limit);
+    }
+
+    /** Returns a budget with only a postings limit. */
+    [[nodiscard]] static auto postings(std::size_t max_postings) -> QueryBudget {
+        return QueryBudget(max_postings);
+    }
+
+    /** Starts a new query: clears the processed postings and starts the time limit. */
+    void start() {
+        m_processed_postings = 0;
+        m_exhausted = false;
+        m_next_check = m_max_postings;
+        if (m_time_limit) {
+            m_deadline = clock::now() + *m_time_limit;
+            m_next_check = std::min(clock_interval, m_max_postings);
+        }
+    }
+
+    /**
+     * Records that `postings` more postings have been processed, and returns `true` if the
+     * query must stop.
+     */
+    auto charge(std::size_t postings) -> bool {
+        m_processed_postings += postings;
+        if (m_processed_postings >= m_next_check) [[unlikely]] {
+            check();
+        }
+        return m_exhausted;
+    }
+
+    /** Returns `true` if the budget ran out during the current query. */
+    [[nodiscard]] auto exhausted() const noexcept -> bool { return m_exhausted; }
+
+    /** The number of postings charged since the start of the current query. */
+    [[nodiscard]] auto processed_postings() const noexcept -> std::size_t {
+        return m_processed_postings;
+    }
+
+    [[nodiscard]] auto max_postings() const noexcept -> std::size_t { return m_max_postings; }
+
+    [[nodiscard]] auto time_limit() const noexcept -> std::optional<clock::duration> {
+        return m_time_limit;
+    }
+
+    /** Returns `false` if neither the postings nor the time are limited. */
+    [[nodiscard]] auto is_limited() const noexcept -> bool {
+        return m_max_postings != std::numeric_limits<std::size_t>::max() || m_time_limit;
+    }
+
+  private:
+    void check() {
+        if (m_processed_postings >= m_max_postings
+            || (m_time_limit && clock::now() >= m_deadline)) {
+            m_exhausted = true;
+            m_next_check = std::numeric_limits<std::size_t>::max();
+            return;
+        }
+        m_next_check = m_max_postings;
+        if (m_time_limit) {
+            m_next_check = std::min(m_processed_postings + clock_interval, m_max_postings);
+        }
+    }
+
+    std::size_t m_max_postings = std::numeric_limits<std::size_t>::max();
+    std::optional<clock::duration> m_time_limit = std::nullopt;
+    clock::time_point m_deadline{};
+    std::size_t m_processed_postings = 0;
+    std::size_t m_next_check = std::numeric_limits<std::size_t>::max();
+    bool m_exhausted = false;
+};
+
+}  // namespace pisa
@@ -0,0 +1,113 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+
+#include "query/query_budget.hpp"
+#include "topk_queue.hpp"
+#include "type_alias.hpp"
+
+namespace pisa {
+
+/**
+ * Memory reused by the queries processed in a single thread.
+ *
+ * Cursors, their decoding buffers, and the auxiliary vectors of query algorithms are allocated
+ * from an arena owned by the context (see `resource()`). The arena is released at the start of
+ * each query with `reset()`; if the previous query did not fit, the arena first grows by the
+ * amount it had to borrow from the upstream resource. Therefore, once the context has seen its
+ * largest query, processing a query performs no heap allocation.
+ *
+ * The context also holds the budget of its queries (see `QueryBudget`), which is restarted by
+ * `reset()`. Algorithms constructed with a context stop when the budget runs out.
+ *
+ * Everything allocated from `resource()` must be destroyed before the next call to `reset()`.
+ * A context must not be used by multiple threads at once; a copy of a context is a new, empty
+ * context with the same capacity and budget, so that each copy of a query processor has its own.
+ */
+class QueryContext {
+  public:
+    constexpr static std::size_t default_capacity = 64 * 1024;
+
+    explicit QueryContext(
+        std::size_t capacity = default_capacity,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()
+    );
+    QueryContext(QueryContext const& other);
+    QueryContext& operator=(QueryContext const& other);
+    ~QueryContext();
+
+    /** The arena to allocate the memory of the current query from. */
+    [[nodiscard]] auto resource() noexcept -> std::pmr::memory_resource*;
+
+    /**
+     * Releases the memory of the previous query, and grows the arena if it was too small. Starts
+     * the budget of the next query.
+     */
+    void reset();
+
+    /** The size of the arena. */
+    [[nodiscard]] auto capacity() const noexcept -> std::size_t;
+
+    /**
+     * Returns the top-k queue of the context, emptied and set up for `k` results. The storage of
+     * the queue is kept between queries.
+     */
+    [[nodiscard]] auto topk(std::size_t k, Score initial_threshold = 0.0F) -> topk_queue&;
+
+    /** The budget of the current query; unlimited by default. */
+    [[nodiscard]] auto budget() noexcept -> QueryBudget&;
+
+    /** Sets the limits of the budget of the following queries. */
+    void set_budget(QueryBudget budget);
+
+  private:
+    /** Passes allocations to the upstream resource and counts the allocated bytes. */
+    class OverflowResource: public std::pmr::memory_resource {
+      public:
+        explicit OverflowResource(std::pmr::memory_resource* upstream) : m_upstream(upstream) {}
+
+        [[nodiscard]] auto upstream() const noexcept -> std::pmr::memory_resource* {
+            return m_upstream;
+        }
+        [[nodiscard]] auto allocated() const noexcept -> std::size_t { return m_allocated; }
+        void clear() noexcept { m_allocated = 0; }
+
+      private:
+        auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override;
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override;
+        [[nodiscard]] auto do_is_equal(std::pmr::memory_resource const& other) const noexcept
+            -> bool override;
+
+        std::pmr::memory_resource* m_upstream;
+        std::size_t m_allocated = 0;
+    };
+
+    void allocate_arena(std::size_t capacity);
+    void release_arena();
+
+    std::size_t m_capacity = 0;
+    OverflowResource m_overflow;
+    std::byte* m_buffer = nullptr;
+    std::optional<std::pmr::monotonic_buffer_resource> m_arena;
+    topk_queue m_topk{0};
+    QueryBudget m_budget{};
+};
+
+}  // namespace pisa
@@ -0,0 +1,42 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "query.hpp"
+
+namespace pisa {
+
+/**
+ * Partitions queries into groups of at most `max_group_size` queries that share terms, so that
+ * each group can be processed with a single scan of each of its posting lists (see
+ * `batched_ranked_or_taat_query`).
+ *
+ * Groups are formed greedily: the first query that is not yet grouped starts a new group, which
+ * is filled with the ungrouped queries sharing the most distinct terms with it (ties are broken by
+ * query position). Queries that share no terms with any other ungrouped query form groups of one.
+ * Every query belongs to exactly one group, and each group lists the positions of its queries in
+ * increasing order.
+ *
+ * Throws `std::invalid_argument` if `max_group_size` is 0.
+ */
+[[nodiscard]] auto
+group_queries_by_terms(std::span<Query const> queries, std::size_t max_group_size)
+    -> std::vector<std::vector<std::size_t>>;
+
+}  // namespace pisa
@@ -0,0 +1,484 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "accumulator/block_max_accumulator.hpp"
+#include "accumulator/lazy_accumulator.hpp"
+#include "accumulator/quantized_accumulator.hpp"
+#include "accumulator/simple_accumulator.hpp"
+#include "buffered_topk_queue.hpp"
+#include "champion_lists.hpp"
+#include "cursor/block_max_scored_cursor.hpp"
+#include "cursor/max_scored_cursor.hpp"
+#include "cursor/scored_cursor.hpp"
+#include "query.hpp"
+#include "query/algorithm/block_max_maxscore_query.hpp"
+#include "query/algorithm/block_max_ranked_and_query.hpp"
+#include "query/algorithm/block_max_wand_query.hpp"
+#include "query/algorithm/bootstrap_threshold.hpp"
+#include "query/algorithm/champion_query.hpp"
+#include "query/algorithm/maxscore_query.hpp"
+#include "query/algorithm/parallel_range_query.hpp"
+#include "query/algorithm/ranked_and_query.hpp"
+#include "query/algorithm/ranked_or_query.hpp"
+#include "query/algorithm/ranked_or_taat_query.hpp"
+#include "query/algorithm/ranked_or_window_query.hpp"
+#include "query/algorithm/wand_query.hpp"
+#include "query/cost_model.hpp"
+#include "query/query_context.hpp"
+#include "scorer/quantized.hpp"
+#include "topk_queue.hpp"
+
+namespace pisa {
+
+/**
+ * Executes a ranked query, inserting the results into the given queue.
+ *
+ * The queue is not finalized, so that the caller can decide what to do with it afterwards.
+ */
+using QueryProcessor = std::function<void(Query const&, topk_queue&)>;
+
+/**
+ * Returns true if the ranked algorithm of the given name is conjunctive, i.e., it only returns
+ * documents containing all query terms, or if it is "auto" and `model` contains a conjunctive
+ * algorithm.
+ *
+ * The k-th highest scores of subsets of the query terms, such as those of a `ThresholdStore`, are
+ * lower bounds only for disjunctive algorithms: a conjunctive algorithm seeded with them may miss
+ * results.
+ */
+[[nodiscard]] inline auto
+is_conjunctive(std::string_view algorithm, CostModel const* model = nullptr) -> bool {
+    if (algorithm == "auto" && model != nullptr) {
+        auto algorithms = model->algorithms();
+        return std::any_of(algorithms.begin(), algorithms.end(), [](auto const& name) {
+            return is_conjunctive(name);
+        });
+    }
+    return algorithm == "ranked_and" || algorithm == "block_max_ranked_and";
+}
+
+/**
+ * Runs a ranked query with `Algorithm`. If `range_count` is greater than 1, the document ID space
+ * is split into that many ranges, which are processed in parallel (see `parallel_range_query`).
+ *
+ * `make_cursors` is called with the context to allocate the cursors from, or without arguments
+ * to allocate them on the heap. The latter is the case for parallel ranges, because a context
+ * cannot be shared between threads.
+ *
+ * The context is not reset, so that the work done for the query before, such as seeding its
+ * threshold, counts against the same budget; callers reset it once at the start of each query.
+ */
+template <typename Algorithm, typename CursorFactory>
+void run_ranked_query(
+    topk_queue& topk,
+    CursorFactory&& make_cursors,
+    std::uint64_t max_docid,
+    std::size_t range_count,
+    QueryContext& context
+) {
+    if (range_count > 1) {
+        parallel_range_query<Algorithm> query(topk);
+        query(make_cursors, max_docid, range_count);
+    } else {
+        Algorithm query(topk, context);
+        query(make_cursors(context), max_docid);
+    }
+}
+
+/**
+ * Calls `fn` with a factory of block-max scored cursors, which is called like the one of
+ * `run_ranked_query`. If the posting lists of the index store their own block-max scores (see
+ * `index::block::BLOCK_MAX_SCORES`) and they were computed with `scorer` (see
+ * `BlockInvertedIndex::block_max_scorer`), the cursors read them (see
+ * `EmbeddedBlockMaxScoredCursor`); otherwise, they read the block-max scores of `wdata`.
+ */
+template <typename Index, typename Wand, typename Scorer, typename Fn>
+void with_block_max_cursors(
+    Index const& index,
+    Wand const& wdata,
+    Scorer const& scorer,
+    Query const& query,
+    bool weighted,
+    Fn&& fn
+) {
+    if constexpr (concepts::EmbeddedBlockMaxPostingCursor<typename Index::document_enumerator>) {
+        // a fingerprint of 0 is unknown, and never trusted
+        if (auto block_max_scorer = index.block_max_scorer();
+            block_max_scorer != 0 && block_max_scorer == scorer.fingerprint()) {
+            fn([&](auto&... query_context) {
+                return make_embedded_block_max_scored_cursors(
+                    index, scorer, query, query_context..., weighted
+                );
+            });
+            return;
+        }
+    }
+    fn([&](auto&... query_context) {
+        return make_block_max_scored_cursors(
+            index, wdata, scorer, query, query_context..., weighted
+        );
+    });
+}
+
+/**
+ * Raises the initial threshold of `topk` to the bound found by a conjunctive pre-pass over the
+ * query terms (see `bootstrap_threshold`). Queries with a single term are left unchanged, because
+ * the pre-pass would repeat the work of the query itself.
+ *
+ * The pre-pass is charged to the budget of `context`, which is not reset (see `run_ranked_query`).
+ */
+template <typename Index, typename Wand, typename Scorer>
+void seed_threshold(
+    topk_queue& topk,
+    Index const& index,
+    Wand const& wdata,
+    Scorer const& scorer,
+    Query const& query,
+    bool weighted,
+    QueryContext& context
+) {
+    if (query.terms().size() < 2) {
+        return;
+    }
+    Score threshold = 0.0F;
+    with_block_max_cursors(index, wdata, scorer, query, weighted, [&](auto&& make_cursors) {
+        threshold =
+            bootstrap_threshold(make_cursors(context), index.num_docs(), topk.capacity(), context);
+    });
+    if (threshold > topk.initial_threshold()) {
+        topk.reset(topk.capacity(), threshold);
+    }
+}
+
+/**
+ * Returns true if `scorer` returns the quantized scores stored in the index as they are, i.e., it
+ * is the `quantized` scorer.
+ */
+template <typename Wand, typename Scorer>
+[[nodiscard]] auto is_quantized_scorer(Scorer const& scorer) -> bool {
+    return dynamic_cast<quantized<Wand> const*>(&scorer) != nullptr;
+}
+
+/**
+ * Returns a processor executing ranked queries with the algorithm of the given name.
+ *
+ * The index, WAND data, and scorer are captured by reference. Each processor owns a
+ * `QueryContext`, and term-at-a-time processors also own their accumulators and collection
+ * buffers; all are reused between queries, so a processor must not be called concurrently, and
+ * each thread should use its own copy.
+ *
+ * `intra_query_ranges` is only used by algorithms that support `parallel_range_query`: wand,
+ * block_max_wand, maxscore, and block_max_maxscore, and their bootstrapped variants.
+ *
+ * block_max_wand_bootstrap and maxscore_bootstrap first seed the threshold of the queue with
+ * `seed_threshold`; their results are the same as those of block_max_wand and maxscore.
+ *
+ * `budget` limits each query (see `QueryBudget`); a query that runs out of budget leaves the best
+ * results found so far in the queue and marks it as incomplete. The budget is checked by wand,
+ * block_max_wand, maxscore, block_max_maxscore, block_max_ranked_and, and the ranked_or_taat
+ * variants, unless the query is split into parallel ranges.
+ *
+ * Throws `std::invalid_argument` if the algorithm is not a known ranked algorithm, or if it is
+ * ranked_or_taat_quantized and the scorer is not `quantized`: its accumulator truncates the
+ * scores to integers, which would silently discard most partial scores of other scorers.
+ */
+template <typename Index, typename Wand, typename Scorer>
+[[nodiscard]] auto make_query_processor(
+    std::string_view algorithm,
+    Index const& index,
+    Wand const& wdata,
+    Scorer const& scorer,
+    bool weighted,
+    std::size_t intra_query_ranges = 1,
+    QueryBudget const& budget = {}
+) -> QueryProcessor {
+    QueryContext initial_context;
+    initial_context.set_budget(budget);
+    if (algorithm == "wand") {
+        return [&, weighted, intra_query_ranges, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            run_ranked_query<wand_query>(
+                topk,
+                [&](auto&... query_context) {
+                    return make_max_scored_cursors(
+                        index, wdata, scorer, query, query_context..., weighted
+                    );
+                },
+                index.num_docs(),
+                intra_query_ranges,
+                context
+            );
+        };
+    }
+    if (algorithm == "block_max_wand") {
+        return [&, weighted, intra_query_ranges, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            with_block_max_cursors(index, wdata, scorer, query, weighted, [&](auto&& make_cursors) {
+                run_ranked_query<block_max_wand_query>(
+                    topk, make_cursors, index.num_docs(), intra_query_ranges, context
+                );
+            });
+        };
+    }
+    if (algorithm == "block_max_maxscore") {
+        return [&, weighted, intra_query_ranges, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            with_block_max_cursors(index, wdata, scorer, query, weighted, [&](auto&& make_cursors) {
+                run_ranked_query<block_max_maxscore_query>(
+                    topk, make_cursors, index.num_docs(), intra_query_ranges, context
+                );
+            });
+        };
+    }
+    if (algorithm == "maxscore") {
+        return [&, weighted, intra_query_ranges, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            run_ranked_query<maxscore_query>(
+                topk,
+                [&](auto&... query_context) {
+                    return make_max_scored_cursors(
+                        index, wdata, scorer, query, query_context..., weighted
+                    );
+                },
+                index.num_docs(),
+                intra_query_ranges,
+                context
+            );
+        };
+    }
+    if (algorithm == "block_max_wand_bootstrap") {
+        return [&, weighted, intra_query_ranges, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            seed_threshold(topk, index, wdata, scorer, query, weighted, context);
+            with_block_max_cursors(index, wdata, scorer, query, weighted, [&](auto&& make_cursors) {
+                run_ranked_query<block_max_wand_query>(
+                    topk, make_cursors, index.num_docs(), intra_query_ranges, context
+                );
+            });
+        };
+    }
+    if (algorithm == "maxscore_bootstrap") {
+        return [&, weighted, intra_query_ranges, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            seed_threshold(topk, index, wdata, scorer, query, weighted, context);
+            run_ranked_query<maxscore_query>(
+                topk,
+                [&](auto&... query_context) {
+                    return make_max_scored_cursors(
+                        index, wdata, scorer, query, query_context..., weighted
+                    );
+                },
+                index.num_docs(),
+                intra_query_ranges,
+                context
+            );
+        };
+    }
+    if (algorithm == "block_max_ranked_and") {
+        return [&, weighted, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            block_max_ranked_and_query block_max_ranked_and_q(topk, context);
+            with_block_max_cursors(index, wdata, scorer, query, weighted, [&](auto&& make_cursors) {
+                block_max_ranked_and_q(make_cursors(context), index.num_docs());
+            });
+        };
+    }
+    if (algorithm == "ranked_and") {
+        return [&, weighted, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            ranked_and_query ranked_and_q(topk, context);
+            ranked_and_q(
+                make_scored_cursors(index, scorer, query, context, weighted), index.num_docs()
+            );
+        };
+    }
+    if (algorithm == "ranked_or") {
+        return [&, weighted, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            ranked_or_query ranked_or_q(topk, context);
+            ranked_or_q(
+                make_scored_cursors(index, scorer, query, context, weighted), index.num_docs()
+            );
+        };
+    }
+    if (algorithm == "ranked_or_window") {
+        return [&, weighted, context = initial_context](
+                   Query const& query, topk_queue& topk
+               ) mutable {
+            context.reset();
+            ranked_or_window_query ranked_or_window_q(topk, context);
+            with_block_max_cursors(index, wdata, scorer, query, weighted, [&](auto&& make_cursors) {
+                ranked_or_window_q(make_cursors(context), index.num_docs());
+            });
+        };
+    }
+    if (algorithm == "ranked_or_taat") {
+        return [&,
+                weighted,
+                accumulator = SimpleAccumulator(index.num_docs()),
+                buffer = buffered_topk_queue(0),
+                context = initial_context](Query const& query, topk_queue& topk) mutable {
+            context.reset();
+            ranked_or_taat_query ranked_or_taat_q(topk, buffer, context);
+            ranked_or_taat_q(
+                make_scored_cursors(index, scorer, query, context, weighted),
+                index.num_docs(),
+                accumulator
+            );
+        };
+    }
+    if (algorithm == "ranked_or_taat_lazy") {
+        return [&,
+                weighted,
+                accumulator = LazyAccumulator<4>(index.num_docs()),
+                buffer = buffered_topk_queue(0),
+                context = initial_context](Query const& query, topk_queue& topk) mutable {
+            context.reset();
+            ranked_or_taat_query ranked_or_taat_q(topk, buffer, context);
+            ranked_or_taat_q(
+                make_scored_cursors(index, scorer, query, context, weighted),
+                index.num_docs(),
+                accumulator
+            );
+        };
+    }
+    if (algorithm == "ranked_or_taat_block_max") {
+        return [&,
+                weighted,
+                accumulator = BlockMaxAccumulator<>(index.num_docs()),
+                buffer = buffered_topk_queue(0),
+                context = initial_context](Query const& query, topk_queue& topk) mutable {
+            context.reset();
+            ranked_or_taat_query ranked_or_taat_q(topk, buffer, context);
+            ranked_or_taat_q(
+                make_scored_cursors(index, scorer, query, context, weighted),
+                index.num_docs(),
+                accumulator
+            );
+        };
+    }
+    if (algorithm == "ranked_or_taat_quantized") {
+        if (!is_quantized_scorer<Wand>(scorer)) {
+            throw std::invalid_argument("ranked_or_taat_quantized requires the quantized scorer");
+        }
+        return [&,
+                weighted,
+                accumulator = QuantizedAccumulator<>(index.num_docs()),
+                context = initial_context](Query const& query, topk_queue& topk) mutable {
+            context.reset();
+            ranked_or_taat_query ranked_or_taat_q(topk, context);
+            ranked_or_taat_q(
+                make_scored_cursors(index, scorer, query, context, weighted),
+                index.num_docs(),
+                accumulator
+            );
+        };
+    }
+    throw std::invalid_argument(fmt::format("Unsupported query type: {}", algorithm));
+}
+
+/**
+ * Returns a processor that runs each query with the algorithm that `model` predicts to be the
+ * fastest for it, given the query's features (see `query_features`). A processor is created for
+ * every algorithm of the model, with the same arguments as `make_query_processor`.
+ *
+ * Note that the results depend on the selected algorithm if the model mixes conjunctive and
+ * disjunctive algorithms.
+ *
+ * Throws `std::invalid_argument` if the model is empty or contains an unknown algorithm.
+ */
+template <typename Index, typename Wand, typename Scorer>
+[[nodiscard]] auto make_auto_query_processor(
+    Index const& index,
+    Wand const& wdata,
+    Scorer const& scorer,
+    bool weighted,
+    CostModel const& model,
+    std::size_t intra_query_ranges = 1,
+    QueryBudget const& budget = {}
+) -> QueryProcessor {
+    if (model.empty()) {
+        throw std::invalid_argument("Cost model has no algorithms");
+    }
+    std::vector<QueryProcessor> processors;
+    for (auto const& algorithm: model.algorithms()) {
+        processors.push_back(make_query_processor(
+            algorithm, index, wdata, scorer, weighted, intra_query_ranges, budget
+        ));
+    }
+    return [&, weighted, model, processors = std::move(processors)](
+               Query const& query, topk_queue& topk
+           ) {
+        processors[model.select(query_features(index, wdata, query, weighted))](query, topk);
+    };
+}
+
+/**
+ * Wraps a query processor so that it makes use of champion lists (see `ChampionLists`).
+ *
+ * Single-term queries covered by the lists are answered from them without processing (see
+ * `champion_query`). For other queries, the initial threshold of the queue is raised to the bound
+ * found by scoring the champions of the query terms (see `champion_threshold`) before processing.
+ * `conjunctive` must be set if `process` runs a conjunctive algorithm.
+ *
+ * The returned processor owns a query context, so each thread should use its own copy.
+ */
+template <typename Index, typename Scorer>
+[[nodiscard]] auto with_champion_lists(
+    QueryProcessor process,
+    ChampionLists const& lists,
+    Index const& index,
+    Scorer const& scorer,
+    bool weighted,
+    bool conjunctive = false
+) -> QueryProcessor {
+    return [&, process = std::move(process), weighted, conjunctive, context = QueryContext{}](
+               Query const& query, topk_queue& topk
+           ) mutable {
+        if (champion_query(lists, query, topk, weighted)) {
+            return;
+        }
+        if (query.terms().size() > 1) {
+            context.reset();
+            auto threshold = champion_threshold(
+                make_scored_cursors(index, scorer, query, context, weighted),
+                lists,
+                query,
+                topk.capacity(),
+                context,
+                conjunctive
+            );
+            if (threshold > topk.initial_threshold()) {
+                topk.reset(topk.capacity(), threshold);
+            }
+        }
+        process(query, topk);
+    };
+}
+
+}  // namespace pisa
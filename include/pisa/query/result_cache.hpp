@@ -0,0 +1,155 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "query.hpp"
+#include "query/query_processor.hpp"
+#include "topk_queue.hpp"
+
+namespace pisa {
+
+/**
+ * Identifies the results of a query, apart from their number.
+ *
+ * The terms are sorted by ID, and the weights of duplicate terms are summed, so that queries that
+ * only differ in the order of their terms share a key.
+ */
+struct ResultCacheKey {
+    std::vector<WeightedTerm> terms;
+    std::string algorithm;
+    std::string scorer;
+
+    [[nodiscard]] static auto from(Query const& query, std::string algorithm, std::string scorer)
+        -> ResultCacheKey;
+
+    [[nodiscard]] auto hash() const noexcept -> std::size_t;
+};
+
+[[nodiscard]] auto operator==(ResultCacheKey const& lhs, ResultCacheKey const& rhs) noexcept
+    -> bool;
+
+/** Decides which entry is evicted when a cache shard is over its budget. */
+enum class CachePolicy {
+    /** Least recently used. */
+    LRU,
+    /** Least frequently used; ties are broken by recency. */
+    LFU,
+};
+
+[[nodiscard]] auto parse_cache_policy(std::string_view name) -> CachePolicy;
+
+struct ResultCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t insertions = 0;
+    std::uint64_t evictions = 0;
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+};
+
+/**
+ * Thread-safe cache of finalized top-k results.
+ *
+ * The cache is split into shards by key hash, each guarded by its own mutex and given an equal part
+ * of the byte budget. The size of an entry is estimated from the memory it owns, including the key.
+ *
+ * An entry stores the `k` it was computed for, and serves any request for at most that many
+ * results; inserting results for a greater `k` replaces it.
+ *
+ * Results computed with an initial threshold may miss documents, and must not be inserted.
+ */
+class ResultCache {
+  public:
+    using entry_type = topk_queue::entry_type;
+
+    explicit ResultCache(
+        std::size_t capacity_bytes, CachePolicy policy = CachePolicy::LRU, std::size_t shards = 16
+    );
+
+    /** Returns the top `k` results for the key, or `std::nullopt` if they are not cached. */
+    [[nodiscard]] auto find(ResultCacheKey const& key, std::size_t k)
+        -> std::optional<std::vector<entry_type>>;
+
+    /** Caches the results of a top-`k` query, sorted by decreasing score. */
+    void insert(ResultCacheKey key, std::size_t k, std::vector<entry_type> results);
+
+    /** Removes all entries; the counters are not reset. */
+    void clear();
+
+    [[nodiscard]] auto stats() const -> ResultCacheStats;
+
+  private:
+    struct KeyHash {
+        auto operator()(ResultCacheKey const& key) const noexcept -> std::size_t {
+            return key.hash();
+        }
+    };
+
+    /** Position in the eviction order: the entry with the lowest rank is evicted first. */
+    using Rank = std::pair<std::uint64_t, std::uint64_t>;
+
+    struct Entry {
+        std::size_t k;
+        std::vector<entry_type> results;
+        std::size_t bytes;
+        std::uint64_t frequency;
+        Rank rank;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<ResultCacheKey, Entry, KeyHash> entries;
+        std::map<Rank, ResultCacheKey const*> eviction_order;
+        std::size_t bytes = 0;
+        std::uint64_t tick = 0;
+    };
+
+    [[nodiscard]] auto shard(ResultCacheKey const& key) -> Shard&;
+    [[nodiscard]] auto rank(Shard& shard, Entry const& entry) const -> Rank;
+    void touch(Shard& shard, ResultCacheKey const& key, Entry& entry);
+    void evict(Shard& shard, std::size_t budget);
+
+    std::size_t m_shard_capacity;
+    CachePolicy m_policy;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::atomic<std::uint64_t> m_hits = 0;
+    std::atomic<std::uint64_t> m_misses = 0;
+    std::atomic<std::uint64_t> m_insertions = 0;
+    std::atomic<std::uint64_t> m_evictions = 0;
+};
+
+/**
+ * Wraps a query processor with a cache lookup.
+ *
+ * On a hit, the cached results are inserted into the queue instead of processing the query;
+ * on a miss, the results of `process` are cached, unless they are incomplete because the query
+ * ran out of budget. Queries with a non-zero initial threshold bypass the cache.
+ */
+[[nodiscard]] auto make_cached_query_processor(
+    QueryProcessor process, ResultCache& cache, std::string algorithm, std::string scorer
+) -> QueryProcessor;
+
+}  // namespace pisa
@@ -3,8 +3,14 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <span>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#endif
 
 #include "index_scorer.hpp"
+#include "util/compiler_attribute.hpp"
 
 namespace pisa {
 
@@ -34,13 +40,76 @@ struct bm25: public WandIndexScorer<Wand> {
         return std::max(epsilon_score, idf) * (1.0F + m_k1);
     }
 
-    TermScorer term_scorer(uint64_t term_id) const override {
+    /// Scores postings of a single term; the query term weight is folded into the IDF component.
+    class term_scorer_type {
+      public:
+        term_scorer_type(Wand const* wdata, float term_weight, float b, float k1)
+            : m_wdata(wdata), m_term_weight(term_weight), m_b(b), m_k1(k1) {}
+
+        [[nodiscard]] auto weighted(float weight) const -> term_scorer_type {
+            return term_scorer_type(m_wdata, m_term_weight * weight, m_b, m_k1);
+        }
+
+        PISA_ALWAYSINLINE auto operator()(uint32_t doc, uint32_t freq) const -> float {
+            auto f = static_cast<float>(freq);
+            float norm_len = m_wdata->norm_len(doc);
+            return m_term_weight * (f / (f + m_k1 * (1.0F - m_b + m_b * norm_len)));
+        }
+
+        /// Scores a block of postings. If the WAND data exposes the document length array and
+        /// AVX2 is available, eight postings are scored at a time.
+        void score_block(
+            std::span<std::uint32_t const> docids,
+            std::span<std::uint32_t const> freqs,
+            std::span<float> scores
+        ) const {
+            std::size_t idx = 0;
+#if defined(__AVX2__)
+            if constexpr (requires { m_wdata->doc_lens().data(); }) {
+                auto const* doc_lens = reinterpret_cast<int const*>(m_wdata->doc_lens().data());
+                __m256 const avg_len = _mm256_set1_ps(m_wdata->avg_len());
+                __m256 const term_weight = _mm256_set1_ps(m_term_weight);
+                __m256 const b = _mm256_set1_ps(m_b);
+                __m256 const k1 = _mm256_set1_ps(m_k1);
+                __m256 const one_minus_b = _mm256_set1_ps(1.0F - m_b);
+                for (; idx + 8 <= docids.size(); idx += 8) {
+                    __m256i docs =
+                        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&docids[idx]));
+                    __m256 f = _mm256_cvtepi32_ps(
+                        _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&freqs[idx]))
+                    );
+                    __m256 norm_len = _mm256_div_ps(
+                        _mm256_cvtepi32_ps(_mm256_i32gather_epi32(doc_lens, docs, 4)), avg_len
+                    );
+                    __m256 len_component =
+                        _mm256_mul_ps(k1, _mm256_add_ps(one_minus_b, _mm256_mul_ps(b, norm_len)));
+                    __m256 tf = _mm256_div_ps(f, _mm256_add_ps(f, len_component));
+                    _mm256_storeu_ps(&scores[idx], _mm256_mul_ps(term_weight, tf));
+                }
+            }
+#endif
+            for (; idx < docids.size(); ++idx) {
+                scores[idx] = (*this)(docids[idx], freqs[idx]);
+            }
+        }
+
+      private:
+        Wand const* m_wdata;
+        float m_term_weight;
+        float m_b;
+        float m_k1;
+    };
+
+    [[nodiscard]] auto static_term_scorer(uint64_t term_id) const -> term_scorer_type {
         auto term_len = this->m_wdata.term_posting_count(term_id);
         auto term_weight = query_term_weight(term_len, this->m_wdata.num_docs());
-        auto s = [&, term_weight](uint32_t doc, uint32_t freq) {
-            return term_weight * doc_term_weight(freq, this->m_wdata.norm_len(doc));
-        };
-        return s;
+        return term_scorer_type(&this->m_wdata, term_weight, m_b, m_k1);
+    }
+
+    TermScorer term_scorer(uint64_t term_id) const override { return static_term_scorer(term_id); }
+
+    [[nodiscard]] auto fingerprint() const -> std::uint32_t override {
+        return scorer_fingerprint("bm25", {m_b, m_k1});
     }
 
   private:
@@ -6,6 +6,7 @@
 #include <cstdint>
 
 #include "index_scorer.hpp"
+#include "util/compiler_attribute.hpp"
 
 namespace pisa {
 
@@ -18,20 +19,46 @@ template <typename Wand>
 struct dph: public WandIndexScorer<Wand> {
     using WandIndexScorer<Wand>::WandIndexScorer;
 
-    TermScorer term_scorer(uint64_t term_id) const override {
-        auto s = [&, term_id](uint32_t doc, uint32_t freq) {
-            float f = (float)freq / this->m_wdata.doc_len(doc);
+    /// Scores postings of a single term; the collection component is computed only once.
+    class term_scorer_type {
+      public:
+        term_scorer_type(Wand const* wdata, float term_component, float weight = 1.0F)
+            : m_wdata(wdata),
+              m_avg_len(wdata->avg_len()),
+              m_term_component(term_component),
+              m_weight(weight) {}
+
+        [[nodiscard]] auto weighted(float weight) const -> term_scorer_type {
+            auto scorer = *this;
+            scorer.m_weight *= weight;
+            return scorer;
+        }
+
+        PISA_ALWAYSINLINE auto operator()(uint32_t doc, uint32_t freq) const -> float {
+            float f = (float)freq / m_wdata->doc_len(doc);
             float norm = (1.F - f) * (1.F - f) / (freq + 1.F);
-            return norm
-                * (freq
-                       * std::log2(
-                           (freq * this->m_wdata.avg_len() / this->m_wdata.doc_len(doc))
-                           * ((float)this->m_wdata.num_docs()
-                              / this->m_wdata.term_occurrence_count(term_id))
-                       )
+            return m_weight * norm
+                * (freq * std::log2((freq * m_avg_len / m_wdata->doc_len(doc)) * m_term_component)
                    + .5F * std::log2(2.F * M_PI * freq * (1.F - f)));
-        };
-        return s;
+        }
+
+      private:
+        Wand const* m_wdata;
+        float m_avg_len;
+        float m_term_component;
+        float m_weight;
+    };
+
+    [[nodiscard]] auto static_term_scorer(uint64_t term_id) const -> term_scorer_type {
+        float term_component =
+            (float)this->m_wdata.num_docs() / this->m_wdata.term_occurrence_count(term_id);
+        return term_scorer_type(&this->m_wdata, term_component);
+    }
+
+    TermScorer term_scorer(uint64_t term_id) const override { return static_term_scorer(term_id); }
+
+    [[nodiscard]] auto fingerprint() const -> std::uint32_t override {
+        return scorer_fingerprint("dph", {});
     }
 };
 
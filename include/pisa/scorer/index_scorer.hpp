@@ -1,12 +1,42 @@
 #pragma once
 
+#include <concepts>
 #include <cstdint>
+#include <cstring>
 #include <functional>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+
+#include "util/compiler_attribute.hpp"
 
 namespace pisa {
 
 using TermScorer = std::function<float(uint32_t, uint32_t)>;
 
+/**
+ * Returns a fingerprint of a scoring function and its parameters, which identifies the scorer
+ * that precomputed scores (such as the block max scores of an index) were computed with.
+ * It is never 0, which stands for an unknown scorer.
+ */
+[[nodiscard]] inline auto
+scorer_fingerprint(std::string_view name, std::initializer_list<float> params) -> std::uint32_t {
+    // 32-bit FNV-1a
+    std::uint32_t hash = 2166136261U;
+    auto add = [&hash](std::uint8_t byte) { hash = (hash ^ byte) * 16777619U; };
+    for (char c: name) {
+        add(static_cast<std::uint8_t>(c));
+    }
+    for (float param: params) {
+        std::uint32_t bits = 0;
+        std::memcpy(&bits, &param, sizeof(bits));
+        for (int shift = 0; shift < 32; shift += 8) {
+            add(static_cast<std::uint8_t>(bits >> shift));
+        }
+    }
+    return hash == 0 ? 1 : hash;
+}
+
 /** Index scorer construct scorers for terms in the index. */
 class IndexScorer {
   public:
@@ -17,6 +47,9 @@ class IndexScorer {
     IndexScorer& operator=(IndexScorer&&) noexcept = delete;
     virtual ~IndexScorer() = default;
     virtual TermScorer term_scorer(std::uint64_t term_id) const = 0;
+
+    /** Returns the fingerprint of the scorer (see `scorer_fingerprint`), or 0 if unknown. */
+    [[nodiscard]] virtual auto fingerprint() const -> std::uint32_t { return 0; }
 };
 
 /** Index scorer using WAND metadata for scoring. */
@@ -34,4 +67,72 @@ struct WandIndexScorer: public IndexScorer {
     virtual ~WandIndexScorer() = default;
 };
 
+/**
+ * An index scorer that can produce term scorers of a concrete type.
+ *
+ * Unlike the type-erased `TermScorer`, `term_scorer_type` can be inlined into the query processing
+ * loop. The query term weight is folded into the scorer with `weighted`, so that weighted queries
+ * do not need to wrap the scorer in another function.
+ */
+template <typename S>
+concept StaticIndexScorer = requires(S const& scorer, std::uint64_t term_id, float weight) {
+    typename S::term_scorer_type;
+    { scorer.static_term_scorer(term_id) } -> std::same_as<typename S::term_scorer_type>;
+    {
+        scorer.static_term_scorer(term_id).weighted(weight)
+    } -> std::same_as<typename S::term_scorer_type>;
+    {
+        scorer.static_term_scorer(term_id)(std::uint32_t{}, std::uint32_t{})
+    } -> std::convertible_to<float>;
+};
+
+/** Term scorer type used by scored cursors created with an index scorer of type `Scorer`. */
+template <typename Scorer>
+struct term_scorer_of {
+    using type = TermScorer;
+};
+
+template <StaticIndexScorer Scorer>
+struct term_scorer_of<Scorer> {
+    using type = typename Scorer::term_scorer_type;
+};
+
+template <typename Scorer>
+using term_scorer_t = typename term_scorer_of<Scorer>::type;
+
+/**
+ * Returns the term scorer for the given term, statically typed whenever `Scorer` supports it.
+ */
+template <typename Scorer>
+[[nodiscard]] auto make_term_scorer(Scorer const& scorer, std::uint64_t term_id)
+    -> term_scorer_t<Scorer> {
+    if constexpr (StaticIndexScorer<Scorer>) {
+        return scorer.static_term_scorer(term_id);
+    } else {
+        return scorer.term_scorer(term_id);
+    }
+}
+
+/**
+ * Writes `scores[i] = term_scorer(docids[i], freqs[i])` for each posting of a block.
+ *
+ * Term scorers that define `score_block` with the same parameters score the entire block in
+ * a single call, which lets them use SIMD kernels; other scorers are called once per posting.
+ */
+template <typename TermScorerType>
+PISA_ALWAYSINLINE void score_postings(
+    TermScorerType const& term_scorer,
+    std::span<std::uint32_t const> docids,
+    std::span<std::uint32_t const> freqs,
+    std::span<float> scores
+) {
+    if constexpr (requires { term_scorer.score_block(docids, freqs, scores); }) {
+        term_scorer.score_block(docids, freqs, scores);
+    } else {
+        for (std::size_t idx = 0; idx < docids.size(); ++idx) {
+            scores[idx] = term_scorer(docids[idx], freqs[idx]);
+        }
+    }
+}
+
 }  // namespace pisa
@@ -8,6 +8,7 @@
 #include <cstdint>
 
 #include "index_scorer.hpp"
+#include "util/compiler_attribute.hpp"
 
 namespace pisa {
 
@@ -21,19 +22,49 @@ struct pl2: public WandIndexScorer<Wand> {
 
     pl2(const Wand& wdata, const float c) : WandIndexScorer<Wand>(wdata), m_c(c) {}
 
-    TermScorer term_scorer(uint64_t term_id) const override {
-        auto s = [&, term_id](uint32_t doc, uint32_t freq) {
-            float tfn =
-                freq * std::log2(1.F + (m_c * this->m_wdata.avg_len()) / this->m_wdata.doc_len(doc));
+    /// Scores postings of a single term; the collection frequency component is computed only once.
+    class term_scorer_type {
+      public:
+        term_scorer_type(Wand const* wdata, float c, float f, float weight = 1.0F)
+            : m_wdata(wdata),
+              m_c_avg_len(c * wdata->avg_len()),
+              m_f(f),
+              m_f_component(std::log2(1.F / f)),
+              m_weight(weight) {}
+
+        [[nodiscard]] auto weighted(float weight) const -> term_scorer_type {
+            auto scorer = *this;
+            scorer.m_weight *= weight;
+            return scorer;
+        }
+
+        PISA_ALWAYSINLINE auto operator()(uint32_t doc, uint32_t freq) const -> float {
+            float tfn = freq * std::log2(1.F + m_c_avg_len / m_wdata->doc_len(doc));
             float norm = 1.F / (tfn + 1.F);
-            float f = (1.F * this->m_wdata.term_occurrence_count(term_id))
-                / (1.F * this->m_wdata.num_docs());
             float e = std::log(1 / 2.F);
-            return norm
-                * (tfn * std::log2(1.F / f) + f * e + 0.5F * std::log2(2 * M_PI * tfn)
+            return m_weight * norm
+                * (tfn * m_f_component + m_f * e + 0.5F * std::log2(2 * M_PI * tfn)
                    + tfn * (std::log2(tfn) - e));
-        };
-        return s;
+        }
+
+      private:
+        Wand const* m_wdata;
+        float m_c_avg_len;
+        float m_f;
+        float m_f_component;
+        float m_weight;
+    };
+
+    [[nodiscard]] auto static_term_scorer(uint64_t term_id) const -> term_scorer_type {
+        float f = (1.F * this->m_wdata.term_occurrence_count(term_id))
+            / (1.F * this->m_wdata.num_docs());
+        return term_scorer_type(&this->m_wdata, m_c, f);
+    }
+
+    TermScorer term_scorer(uint64_t term_id) const override { return static_term_scorer(term_id); }
+
+    [[nodiscard]] auto fingerprint() const -> std::uint32_t override {
+        return scorer_fingerprint("pl2", {m_c});
     }
 
   private:
@@ -5,6 +5,7 @@
 #include <cstdint>
 
 #include "index_scorer.hpp"
+#include "util/compiler_attribute.hpp"
 
 namespace pisa {
 
@@ -22,19 +23,42 @@ struct qld: public WandIndexScorer<Wand> {
 
     qld(const Wand& wdata, const float mu) : WandIndexScorer<Wand>(wdata), m_mu(mu) {}
 
-    TermScorer term_scorer(uint64_t term_id) const override {
+    /// Scores postings of a single term.
+    class term_scorer_type {
+      public:
+        term_scorer_type(Wand const* wdata, float mu, float term_component, float weight = 1.0F)
+            : m_wdata(wdata), m_mu(mu), m_term_component(term_component), m_weight(weight) {}
+
+        [[nodiscard]] auto weighted(float weight) const -> term_scorer_type {
+            return term_scorer_type(m_wdata, m_mu, m_term_component, m_weight * weight);
+        }
+
+        PISA_ALWAYSINLINE auto operator()(uint32_t doc, uint32_t freq) const -> float {
+            float doclen = m_wdata->doc_len(doc);
+            float a = std::log(m_mu / (doclen + m_mu));
+            float b = std::log1p(freq * m_term_component);
+            return m_weight * std::max(0.F, a + b);
+        }
+
+      private:
+        Wand const* m_wdata;
+        float m_mu;
+        float m_term_component;
+        float m_weight;
+    };
+
+    [[nodiscard]] auto static_term_scorer(uint64_t term_id) const -> term_scorer_type {
         float mu = this->m_mu;
         float collection_len = this->m_wdata.collection_len();
         float term_occurrences = this->m_wdata.term_occurrence_count(term_id);
         float term_component = collection_len / (mu * term_occurrences);
+        return term_scorer_type(&this->m_wdata, mu, term_component);
+    }
+
+    TermScorer term_scorer(uint64_t term_id) const override { return static_term_scorer(term_id); }
 
-        auto s = [this, mu, term_component](uint32_t doc, uint32_t freq) {
-            float doclen = this->m_wdata.doc_len(doc);
-            float a = std::log(mu / (doclen + mu));
-            float b = std::log1p(freq * term_component);
-            return std::max(0.F, a + b);
-        };
-        return s;
+    [[nodiscard]] auto fingerprint() const -> std::uint32_t override {
+        return scorer_fingerprint("qld", {m_mu});
     }
 
   private:
@@ -6,6 +6,7 @@
 
 #include "index_scorer.hpp"
 #include "linear_quantizer.hpp"
+#include "util/compiler_attribute.hpp"
 
 namespace pisa {
 
@@ -13,9 +14,36 @@ template <typename Wand>
 struct quantized: public WandIndexScorer<Wand> {
     using WandIndexScorer<Wand>::WandIndexScorer;
 
+    /// Returns the stored quantized score, multiplied by the query term weight.
+    class term_scorer_type {
+      public:
+        explicit term_scorer_type(float weight = 1.0F) : m_weight(weight) {}
+
+        [[nodiscard]] auto weighted(float weight) const -> term_scorer_type {
+            return term_scorer_type(m_weight * weight);
+        }
+
+        PISA_ALWAYSINLINE auto operator()([[maybe_unused]] uint32_t doc, uint32_t freq) const
+            -> float {
+            return m_weight * freq;
+        }
+
+      private:
+        float m_weight;
+    };
+
+    [[nodiscard]] auto static_term_scorer([[maybe_unused]] uint64_t term_id) const
+        -> term_scorer_type {
+        return term_scorer_type();
+    }
+
     TermScorer term_scorer([[maybe_unused]] uint64_t term_id) const {
         return []([[maybe_unused]] uint32_t doc, uint32_t freq) { return freq; };
     }
+
+    [[nodiscard]] auto fingerprint() const -> std::uint32_t override {
+        return scorer_fingerprint("quantized", {});
+    }
 };
 
 /**
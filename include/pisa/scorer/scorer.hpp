@@ -45,4 +45,29 @@ namespace pisa { namespace scorer {
         spdlog::error("Unknown scorer {}", params.name);
         std::abort();
     };
+
+    /**
+     * Resolves the scorer from the parameters and passes the concrete scorer object to `fn`.
+     *
+     * As opposed to `from_params`, the scorer type is known statically inside `fn`, so that
+     * cursors created with it can inline the scoring function. Note that `fn` is instantiated
+     * once for each scorer type.
+     */
+    template <typename Wand, typename Fn>
+    void run_for_scorer(ScorerParams const& params, Wand const& wdata, Fn&& fn) {
+        if (params.name == "bm25") {
+            fn(bm25<Wand>(wdata, params.bm25_b, params.bm25_k1));
+        } else if (params.name == "qld") {
+            fn(qld<Wand>(wdata, params.qld_mu));
+        } else if (params.name == "pl2") {
+            fn(pl2<Wand>(wdata, params.pl2_c));
+        } else if (params.name == "dph") {
+            fn(dph<Wand>(wdata));
+        } else if (params.name == "quantized") {
+            fn(quantized<Wand>(wdata));
+        } else {
+            spdlog::error("Unknown scorer {}", params.name);
+            std::abort();
+        }
+    }
 }}  // namespace pisa::scorer
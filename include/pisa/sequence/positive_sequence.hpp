@@ -62,6 +62,27 @@ struct positive_sequence {
             return value_type(position, m_cur - prev);
         }
 
+        // write the values at positions [position, position + n), which must not exceed the
+        // size of the sequence, to out, leaving the enumerator at position + n - 1
+        void decode(uint64_t position, uint64_t n, uint64_t* out) {
+            if (n == 0) {
+                return;
+            }
+            uint64_t prev = 0;
+            if (position == m_position + 1) {
+                prev = m_cur;
+            } else if (position != 0) {
+                prev = m_base_enum.move(position - 1).second;
+            }
+            m_base_enum.decode(position, n, out);
+            m_cur = out[n - 1];
+            m_position = position + n - 1;
+            for (uint64_t i = n - 1; i > 0; --i) {
+                out[i] -= out[i - 1];
+            }
+            out[0] -= prev;
+        }
+
         base_sequence_enumerator const& base() const { return m_base_enum; }
 
       private:
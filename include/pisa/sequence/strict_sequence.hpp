@@ -130,6 +130,10 @@ struct strict_sequence {
             return std::visit([](auto&& e) { return e.next(); }, m_enumerator);
         }
 
+        void decode(uint64_t position, uint64_t n, uint64_t* out) {
+            std::visit([&](auto&& e) { e.decode(position, n, out); }, m_enumerator);
+        }
+
         uint64_t size() const {
             return std::visit([](auto&& e) { return e.size(); }, m_enumerator);
         }
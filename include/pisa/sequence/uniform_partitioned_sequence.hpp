@@ -187,6 +187,30 @@ struct uniform_partitioned_sequence {
             return slow_next();
         }
 
+        // write the values at positions [position, position + n), which must not exceed size(),
+        // to out, decoding each partition in bulk; leaves the enumerator at position + n - 1
+        void decode(uint64_t position, uint64_t n, uint64_t* out) {
+            assert(position + n <= size());
+            if (n == 0) {
+                return;
+            }
+            move(position);
+            while (true) {
+                uint64_t count = std::min(n, m_cur_end - m_position);
+                m_partition_enum.decode(m_position - m_cur_begin, count, out);
+                for (uint64_t i = 0; i < count; ++i) {
+                    out[i] += m_cur_base;
+                }
+                m_position += count - 1;
+                out += count;
+                n -= count;
+                if (n == 0) {
+                    return;
+                }
+                next();
+            }
+        }
+
         uint64_t size() const { return m_size; }
 
         uint64_t prev_value() const {
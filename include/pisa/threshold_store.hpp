@@ -0,0 +1,108 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "memory_source.hpp"
+#include "query.hpp"
+#include "type_alias.hpp"
+
+namespace pisa {
+
+namespace ts {
+
+    template <std::size_t N>
+    struct Entry {
+        std::array<TermId, N> terms;
+        Score score;
+    };
+
+    using PairEntry = Entry<2>;
+    using TripleEntry = Entry<3>;
+
+}  // namespace ts
+
+/**
+ * Precomputed k-th highest scores of single terms, and optionally term pairs and triples.
+ *
+ * Because partial scores are non-negative, the k-th highest score of any subset of the query terms
+ * is a lower bound on the k-th highest score of the disjunctive query, and thus can be used as the
+ * initial threshold of the top-k queue. This does not hold for conjunctive queries, whose results
+ * may all score below the k-th score of a single term. The store is only valid for the index and
+ * scorer it was built with, and for queries with weights of at least 1 (as is the case for term
+ * counts).
+ *
+ * The encoded store consists of a header (magic number, version, k, and the number of terms,
+ * pairs, and triples), followed by the term scores indexed by term ID, and the pair and triple
+ * entries sorted by their terms. The entries are read directly from the memory source, so the
+ * store can be memory-mapped and used without parsing.
+ */
+class ThresholdStore {
+  public:
+    explicit ThresholdStore(MemorySource source);
+
+    /** The number of results the scores were computed for. */
+    [[nodiscard]] auto k() const noexcept -> std::size_t;
+
+    /** The k-th highest score of the term, or 0 if it has fewer than k postings. */
+    [[nodiscard]] auto term(TermId term) const noexcept -> Score;
+
+    /** The k-th highest score of the pair, or 0 if the pair is not stored. */
+    [[nodiscard]] auto pair(TermId first, TermId second) const noexcept -> Score;
+
+    /** The k-th highest score of the triple, or 0 if the triple is not stored. */
+    [[nodiscard]] auto triple(TermId first, TermId second, TermId third) const noexcept -> Score;
+
+    /**
+     * Returns the highest stored score among the subsets of the query terms, or 0 if none is
+     * stored, `k` is greater than the `k` of the store, the query is `conjunctive`, or any query
+     * term has a weight below 1.
+     */
+    [[nodiscard]] auto
+    threshold(Query const& query, std::size_t k, bool conjunctive = false) const -> Score;
+
+  private:
+    MemorySource m_source;
+    std::size_t m_k;
+    std::span<Score const> m_terms;
+    std::span<ts::PairEntry const> m_pairs;
+    std::span<ts::TripleEntry const> m_triples;
+};
+
+/** Collects the scores of a threshold store and encodes them in the format of `ThresholdStore`. */
+class ThresholdStoreBuilder {
+  public:
+    explicit ThresholdStoreBuilder(std::size_t k, std::size_t num_terms);
+
+    void term(TermId term, Score score);
+    void pair(TermId first, TermId second, Score score);
+    void triple(TermId first, TermId second, TermId third, Score score);
+
+    /** Writes the store; the pairs and triples are sorted first. */
+    void encode(std::ostream& out);
+
+  private:
+    std::size_t m_k;
+    std::vector<Score> m_terms;
+    std::vector<ts::PairEntry> m_pairs;
+    std::vector<ts::TripleEntry> m_triples;
+};
+
+}  // namespace pisa
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <utility>
 #include <vector>
@@ -9,6 +10,30 @@
 
 namespace pisa {
 
+/// A top-k threshold shared by multiple queues that process the same query concurrently.
+///
+/// The value can only grow: each queue raises it to its own threshold once it is full, so that
+/// the threshold is a lower bound on the score of the k-th highest scored document overall.
+class SharedThreshold {
+  public:
+    explicit SharedThreshold(Score initial_value = 0.0F) : m_value(initial_value) {}
+
+    [[nodiscard]] auto load() const noexcept -> Score {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+    /// Sets the value to `score` if it is greater than the current one.
+    void raise(Score score) noexcept {
+        Score current = m_value.load(std::memory_order_relaxed);
+        while (current < score
+               && !m_value.compare_exchange_weak(current, score, std::memory_order_relaxed)) {
+        }
+    }
+
+  private:
+    std::atomic<Score> m_value;
+};
+
 /// Top-k document priority queue.
 ///
 /// Accumulates (document, score) pairs during a retrieval algorithm.
@@ -51,20 +76,26 @@ struct topk_queue {
         if (m_q.size() <= m_k) [[unlikely]] {
             std::push_heap(m_q.begin(), m_q.end(), min_heap_order);
             if (m_q.size() == m_k) [[unlikely]] {
-                m_effective_threshold = m_q.front().first;
+                update_threshold(m_q.front().first);
             }
         } else {
             std::iter_swap(m_q.begin(), std::prev(m_q.end()));
             m_q.pop_back();
             sift_down(m_q.begin(), m_q.end());
-            m_effective_threshold = m_q.front().first;
+            update_threshold(m_q.front().first);
         }
         return true;
     }
 
     /// Checks if an entry with the given score would be inserted to the queue, according
     /// to the current threshold.
-    bool would_enter(float score) const { return score > m_effective_threshold; }
+    bool would_enter(float score) const { return score > effective_threshold(); }
+
+    /// Shares the threshold with other queues processing the same query.
+    ///
+    /// From now on, the threshold of this queue is published to `threshold` whenever the queue
+    /// is full, and `effective_threshold()` takes the shared value into account.
+    void share_threshold(SharedThreshold& threshold) noexcept { m_shared_threshold = &threshold; }
 
     /// Sorts the results in the heap container in the descending score order.
     ///
@@ -96,8 +127,12 @@ struct topk_queue {
     /// Returns the threshold set at the start (by default 0.0).
     [[nodiscard]] auto initial_threshold() const noexcept -> Score { return m_initial_threshold; }
 
-    /// Returns the maximum of `true_threshold()` and `initial_threshold()`.
+    /// Returns the maximum of `true_threshold()` and `initial_threshold()`, and of the shared
+    /// threshold, if any (see `share_threshold()`).
     [[nodiscard]] auto effective_threshold() const noexcept -> Score {
+        if (m_shared_threshold != nullptr) [[unlikely]] {
+            return std::max(m_effective_threshold, m_shared_threshold->load());
+        }
         return m_effective_threshold;
     }
 
@@ -108,13 +143,34 @@ struct topk_queue {
         return m_effective_threshold >= m_initial_threshold;
     }
 
+    /// Marks the results as incomplete: the query was stopped before processing all postings
+    /// (see `QueryBudget`), so the queue only holds the best results found up to that point.
+    void mark_incomplete() noexcept { m_complete = false; }
+
+    /// Returns `false` if the query was stopped before processing all postings.
+    [[nodiscard]] auto is_complete() const noexcept -> bool { return m_complete; }
+
     /// Empties the queue and resets the threshold to 0 (or the given value).
     void clear(Score initial_threshold = 0.0) noexcept {
         m_q.clear();
+        m_complete = true;
         m_effective_threshold = std::nextafter(m_initial_threshold, 0.0);
         m_initial_threshold = initial_threshold;
     }
 
+    /// Empties the queue and sets it up for `k` entries and the given initial threshold, as if
+    /// newly constructed, but keeps the allocated storage, so that it can be reused for another
+    /// query.
+    void reset(std::size_t k, Score initial_threshold = 0.0F) {
+        m_k = k;
+        m_initial_threshold = initial_threshold;
+        m_effective_threshold = std::nextafter(m_initial_threshold, 0.0F);
+        m_shared_threshold = nullptr;
+        m_complete = true;
+        m_q.clear();
+        m_q.reserve(m_k + 1);
+    }
+
     /// The maximum number of entries that can fit in the queue.
     [[nodiscard]] auto capacity() const noexcept -> std::size_t { return m_k; }
 
@@ -122,6 +178,13 @@ struct topk_queue {
     [[nodiscard]] auto size() const noexcept -> std::size_t { return m_q.size(); }
 
   private:
+    void update_threshold(Score threshold) noexcept {
+        m_effective_threshold = threshold;
+        if (m_shared_threshold != nullptr) [[unlikely]] {
+            m_shared_threshold->raise(threshold);
+        }
+    }
+
     [[nodiscard]] constexpr static auto
     min_heap_order(entry_type const& lhs, entry_type const& rhs) noexcept -> bool {
         return lhs.first > rhs.first;
@@ -169,6 +232,8 @@ struct topk_queue {
     float m_initial_threshold;
     std::vector<entry_type> m_q;
     float m_effective_threshold;
+    SharedThreshold* m_shared_threshold = nullptr;
+    bool m_complete = true;
 };
 
 }  // namespace pisa
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <x86intrin.h>
 #if defined(__SSE4_2__)
     #define USE_POPCNT 1
@@ -72,4 +74,132 @@ namespace pisa { namespace intrinsics {
 
 #endif /* USE_POPCNT */
 
+    /**
+     * Replaces `n` document ID gaps with absolute document IDs in place, where the first ID is
+     * `base + values[0]`, and each following one is `values[i] + 1` greater than its predecessor.
+     */
+    __INTRIN_INLINE void gaps_to_docids(uint32_t* values, size_t n, uint32_t base) {
+        size_t pos = 0;
+        uint32_t prev = base - 1;
+#if defined(__SSE2__)
+        __m128i const ones = _mm_set1_epi32(1);
+        __m128i carry = _mm_set1_epi32(static_cast<int>(prev));
+        for (; pos + 4 <= n; pos += 4) {
+            auto* ptr = reinterpret_cast<__m128i*>(values + pos);
+            __m128i x = _mm_add_epi32(_mm_loadu_si128(ptr), ones);
+            x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+            x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+            x = _mm_add_epi32(x, carry);
+            _mm_storeu_si128(ptr, x);
+            carry = _mm_shuffle_epi32(x, 0xFF);
+        }
+        prev = static_cast<uint32_t>(_mm_cvtsi128_si32(carry));
+#endif
+        for (; pos < n; ++pos) {
+            prev += values[pos] + 1;
+            values[pos] = prev;
+        }
+    }
+
+    /**
+     * Returns the position of the first of `n` sorted values that is greater than or equal to
+     * `lower_bound`, or `n` if there is none.
+     */
+    __INTRIN_INLINE size_t find_geq(uint32_t const* values, size_t n, uint32_t lower_bound) {
+        size_t pos = 0;
+#if defined(__AVX2__)
+        __m256i const bound = _mm256_set1_epi32(static_cast<int>(lower_bound));
+        for (; pos + 8 <= n; pos += 8) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(values + pos));
+            __m256i geq = _mm256_cmpeq_epi32(_mm256_max_epu32(x, bound), x);
+            auto mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(geq)));
+            if (unsigned long idx; bsf64(&idx, mask)) {
+                return pos + idx;
+            }
+        }
+#elif defined(__SSE4_1__)
+        __m128i const bound = _mm_set1_epi32(static_cast<int>(lower_bound));
+        for (; pos + 4 <= n; pos += 4) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(values + pos));
+            __m128i geq = _mm_cmpeq_epi32(_mm_max_epu32(x, bound), x);
+            auto mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(geq)));
+            if (unsigned long idx; bsf64(&idx, mask)) {
+                return pos + idx;
+            }
+        }
+#endif
+        while (pos < n && values[pos] < lower_bound) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    /**
+     * Computes the bitwise AND of the `n` words of `dst` and the `n` 64-bit words stored at
+     * `src`, which need not be aligned, and writes it to `dst`.
+     */
+    __INTRIN_INLINE void and_words(uint64_t* dst, uint8_t const* src, size_t n) {
+        size_t pos = 0;
+#if defined(__AVX2__)
+        for (; pos + 4 <= n; pos += 4) {
+            auto* out = reinterpret_cast<__m256i*>(dst + pos);
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + 8 * pos));
+            _mm256_storeu_si256(out, _mm256_and_si256(_mm256_loadu_si256(out), x));
+        }
+#elif defined(__SSE2__)
+        for (; pos + 2 <= n; pos += 2) {
+            auto* out = reinterpret_cast<__m128i*>(dst + pos);
+            __m128i x = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + 8 * pos));
+            _mm_storeu_si128(out, _mm_and_si128(_mm_loadu_si128(out), x));
+        }
+#endif
+        for (; pos < n; ++pos) {
+            uint64_t word;
+            std::memcpy(&word, src + 8 * pos, sizeof(word));
+            dst[pos] &= word;
+        }
+    }
+
+    /**
+     * Sets, in each of the `n` words of `dst`, the bits of the `width`-bit field starting at bit
+     * `offset + i * width` of the little-endian bit stream at `src`, where `width` is at most 56.
+     * As with `bit_vector::get_word56`, up to 8 bytes starting at the byte of each field are read.
+     */
+    __INTRIN_INLINE void
+    or_packed_bits(uint64_t* dst, uint8_t const* src, uint64_t offset, uint64_t width, size_t n) {
+        if (width == 0) {
+            return;
+        }
+        uint64_t const mask = (uint64_t(1) << width) - 1;
+        size_t pos = 0;
+#if defined(__AVX2__)
+        __m256i const field_mask = _mm256_set1_epi64x(static_cast<long long>(mask));
+        __m256i const byte_mask = _mm256_set1_epi64x(7);
+        __m256i const step = _mm256_set1_epi64x(static_cast<long long>(4 * width));
+        __m256i bits = _mm256_set_epi64x(
+            static_cast<long long>(offset + 3 * width),
+            static_cast<long long>(offset + 2 * width),
+            static_cast<long long>(offset + width),
+            static_cast<long long>(offset)
+        );
+        for (; pos + 4 <= n; pos += 4) {
+            __m256i words = _mm256_i64gather_epi64(
+                reinterpret_cast<long long const*>(src), _mm256_srli_epi64(bits, 3), 1
+            );
+            __m256i fields = _mm256_and_si256(
+                _mm256_srlv_epi64(words, _mm256_and_si256(bits, byte_mask)), field_mask
+            );
+            auto* out = reinterpret_cast<__m256i*>(dst + pos);
+            _mm256_storeu_si256(out, _mm256_or_si256(_mm256_loadu_si256(out), fields));
+            bits = _mm256_add_epi64(bits, step);
+        }
+#endif
+        for (; pos < n; ++pos) {
+            uint64_t bit = offset + pos * width;
+            uint64_t word;
+            std::memcpy(&word, src + bit / 8, sizeof(word));
+            dst[pos] |= (word >> (bit % 8)) & mask;
+        }
+    }
+
 }}  // namespace pisa::intrinsics
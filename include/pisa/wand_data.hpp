@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <span>
 #include <unordered_set>
 
 #include "spdlog/spdlog.h"
@@ -118,6 +119,8 @@ class wand_data {
 
     size_t doc_len(uint64_t doc_id) const { return m_doc_lens[doc_id]; }
 
+    std::span<uint32_t const> doc_lens() const { return {m_doc_lens.data(), m_doc_lens.size()}; }
+
     size_t term_occurrence_count(uint64_t term_id) const {
         return m_term_occurrence_counts[term_id];
     }
@@ -5,6 +5,7 @@
 
 #include <benchmark/benchmark.h>
 
+#include <pisa/buffered_topk_queue.hpp>
 #include <pisa/topk_queue.hpp>
 
 using Entry = std::pair<float, std::uint32_t>;
@@ -52,21 +53,24 @@ auto generate_entries(std::size_t length, Series series) {
     throw std::logic_error("unreachable");
 }
 
-void insert_all(pisa::topk_queue& queue, std::vector<Entry> const& entries) {
+template <typename Queue>
+void insert_all(Queue& queue, std::vector<Entry> const& entries) {
     for (auto const& [score, docid]: entries) {
         benchmark::DoNotOptimize(queue.insert(score, docid));
     }
 }
 
+template <typename Queue>
 static void bm_topk_queue(benchmark::State& state) {
     auto entries = generate_entries(state.range(0), Series{state.range(2)});
     for (auto _: state) {
-        pisa::topk_queue queue(state.range(1));
+        Queue queue(state.range(1));
 
         auto start = std::chrono::high_resolution_clock::now();
 
         benchmark::DoNotOptimize(queue.topk().data());
         insert_all(queue, entries);
+        queue.finalize();
 
         auto end = std::chrono::high_resolution_clock::now();
         auto elapsed_seconds = std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
@@ -76,9 +80,48 @@ static void bm_topk_queue(benchmark::State& state) {
     }
 }
 
-BENCHMARK(bm_topk_queue)
+/// Inserts the scores as a single batch, as collected from an accumulator array.
+static void bm_buffered_topk_queue_batch(benchmark::State& state) {
+    auto entries = generate_entries(state.range(0), Series{state.range(2)});
+    std::vector<float> scores;
+    std::transform(entries.begin(), entries.end(), std::back_inserter(scores), [](auto entry) {
+        return entry.first;
+    });
+    for (auto _: state) {
+        pisa::buffered_topk_queue queue(state.range(1));
+
+        auto start = std::chrono::high_resolution_clock::now();
+
+        benchmark::DoNotOptimize(queue.topk().data());
+        benchmark::DoNotOptimize(queue.insert_batch(scores, 0));
+        queue.finalize();
+
+        auto end = std::chrono::high_resolution_clock::now();
+        auto elapsed_seconds =
+            std::chrono::duration_cast<std::chrono::duration<double>>(end - start);
+
+        state.SetIterationTime(elapsed_seconds.count());
+        benchmark::ClobberMemory();
+    }
+}
+
+BENCHMARK(bm_topk_queue<pisa::topk_queue>)
+    ->ArgNames({"len", "k", "series"})
+    ->ArgsProduct({{1'000'000}, {10, 100, 1000}, {INCREASING, DECREASING, RANDOM}})
+    ->Unit(benchmark::kMicrosecond)
+    ->Repetitions(20)
+    ->DisplayAggregatesOnly();
+
+BENCHMARK(bm_topk_queue<pisa::buffered_topk_queue>)
+    ->ArgNames({"len", "k", "series"})
+    ->ArgsProduct({{1'000'000}, {10, 100, 1000}, {INCREASING, DECREASING, RANDOM}})
+    ->Unit(benchmark::kMicrosecond)
+    ->Repetitions(20)
+    ->DisplayAggregatesOnly();
+
+BENCHMARK(bm_buffered_topk_queue_batch)
     ->ArgNames({"len", "k", "series"})
-    ->ArgsProduct({{1'000'000}, {10}, {INCREASING, DECREASING, RANDOM}})
+    ->ArgsProduct({{1'000'000}, {10, 100, 1000}, {INCREASING, DECREASING, RANDOM}})
     ->Unit(benchmark::kMicrosecond)
     ->Repetitions(20)
     ->DisplayAggregatesOnly();
@@ -1,6 +1,7 @@
 #include "block_inverted_index.hpp"
 #include "bit_vector_builder.hpp"
 #include "codec/compact_elias_fano.hpp"
+#include "hybrid_block_inverted_index.hpp"
 #include "mappable/mapper.hpp"
 #include "util/index_build_utils.hpp"
 #include "util/progress.hpp"
@@ -20,12 +21,23 @@ BlockInvertedIndex::BlockInvertedIndex(BlockCodecPtr block_codec)
 }
 
 auto BlockInvertedIndex::operator[](std::size_t term_id) const -> BlockInvertedIndexCursor<> {
+    return BlockInvertedIndexCursor(
+        m_block_codec.get(), posting_list_data(term_id), num_docs(), term_id
+    );
+}
+
+auto BlockInvertedIndex::cursor(std::size_t term_id, std::pmr::memory_resource* resource) const
+    -> BlockInvertedIndexCursor<> {
+    return BlockInvertedIndexCursor(
+        m_block_codec.get(), posting_list_data(term_id), num_docs(), term_id, resource
+    );
+}
+
+auto BlockInvertedIndex::posting_list_data(std::size_t term_id) const -> std::uint8_t const* {
     check_term_range(term_id);
     compact_elias_fano::enumerator endpoints(m_endpoints, 0, m_lists.size(), m_size, m_params);
     auto endpoint = endpoints.move(term_id).second;
-    return BlockInvertedIndexCursor(
-        m_block_codec.get(), m_lists.data() + endpoint, num_docs(), term_id
-    );
+    return m_lists.data() + endpoint;
 }
 
 void BlockInvertedIndex::check_term_range(std::size_t term_id) const {
@@ -53,22 +65,30 @@ void BlockInvertedIndex::warmup(std::size_t term_id) const {
     (void)tmp;
 }
 
-auto BlockInvertedIndex::size_stats() -> SizeStats {
-    SizeStats stats;
-    stats.size_tree = mapper::size_tree_of(*this);
-
-    for (auto const& node: stats.size_tree->children) {
-        if (node->name == "m_lists") {
-            stats.docs = node->size;
-        }
+auto BlockInvertedIndex::has_block_max_scores() const -> bool {
+    if (size() == 0) {
+        return false;
     }
+    std::uint32_t n = 0;
+    std::uint32_t flags = 0;
+    index::block::decode_posting_list_header(posting_list_data(0), n, flags);
+    return (flags & index::block::BLOCK_MAX_SCORES) != 0U;
+}
 
-    for (size_t i = 0; i < size(); ++i) {
-        stats.freqs += (*this)[i].stats_freqs_size();
+auto BlockInvertedIndex::block_max_scorer() const -> std::uint32_t {
+    if (size() == 0) {
+        return 0;
     }
-    stats.docs -= stats.freqs;
+    std::uint32_t n = 0;
+    std::uint32_t flags = 0;
+    std::uint32_t codec_tag = 0;
+    std::uint32_t scorer = 0;
+    index::block::decode_posting_list_header(posting_list_data(0), n, flags, codec_tag, scorer);
+    return (flags & index::block::BLOCK_MAX_SCORES) != 0U ? scorer : 0;
+}
 
-    return stats;
+auto BlockInvertedIndex::size_stats() -> SizeStats {
+    return collect_size_stats(*this);
 }
 
 ProfilingBlockInvertedIndex::ProfilingBlockInvertedIndex(MemorySource source, BlockCodecPtr block_codec)
@@ -79,27 +99,86 @@ ProfilingBlockInvertedIndex::ProfilingBlockInvertedIndex(MemorySource source, Bl
 }
 
 index::block::PostingAccumulator::PostingAccumulator(
-    BlockCodecPtr block_codec, std::size_t num_docs, std::string output_filename
+    BlockCodecPtr block_codec, std::size_t num_docs, std::string output_filename, bool skip_layer
 )
     : m_block_codec(std::move(block_codec)),
       m_num_docs(num_docs),
-      m_output_filename(std::move(output_filename)) {}
+      m_output_filename(std::move(output_filename)),
+      m_skip_layer(skip_layer) {}
+
+namespace {
+
+    /**
+     * Writes the maximum of `scores` followed by an upper bound of the scores of each block,
+     * quantized to one byte; see `index::block::BLOCK_MAX_SCORES`.
+     */
+    void write_block_max_scores(
+        std::uint8_t* out, std::uint32_t n, std::uint64_t block_size, float const* scores
+    ) {
+        float max_score = std::max(0.0F, *std::max_element(scores, scores + n));
+        std::memcpy(out, &max_score, sizeof(max_score));
+        float step = index::block::block_max_score_step(max_score);
+        for (std::uint64_t begin = 0, block = 0; begin < n; begin += block_size, ++block) {
+            auto end = std::min<std::uint64_t>(begin + block_size, n);
+            float block_max = std::max(0.0F, *std::max_element(scores + begin, scores + end));
+            std::uint32_t quant = 0;
+            if (step > 0.0F) {
+                quant = std::min(255U, static_cast<std::uint32_t>(std::ceil(block_max / step)));
+                while (quant < 255U && static_cast<float>(quant) * step < block_max) {
+                    ++quant;
+                }
+            }
+            out[4 + block] = static_cast<std::uint8_t>(quant);
+        }
+    }
+
+}  // namespace
 
 void index::block::write_posting_list(
     BlockCodec const* codec,
     std::vector<uint8_t>& out,
     std::uint32_t n,
     std::uint32_t const* docs,
-    std::uint32_t const* freqs
+    std::uint32_t const* freqs,
+    bool skip_layer,
+    std::optional<std::uint32_t> codec_tag,
+    bool dense,
+    float const* scores,
+    std::optional<std::uint32_t> scorer
 ) {
+    if (scores == nullptr) {
+        scorer = std::nullopt;
+    }
+    std::uint32_t flags = (skip_layer ? SKIP_LAYER : 0U) | (codec_tag ? CODEC_TAG : 0U)
+        | (dense ? DENSE : 0U) | (scores != nullptr ? BLOCK_MAX_SCORES : 0U)
+        | (scorer ? BLOCK_MAX_SCORER : 0U);
+    if (flags != 0U) {
+        TightVariableByte::encode_single(0, out);
+        TightVariableByte::encode_single(flags, out);
+        if (codec_tag) {
+            TightVariableByte::encode_single(*codec_tag, out);
+        }
+        if (scorer) {
+            TightVariableByte::encode_single(*scorer, out);
+        }
+    }
     TightVariableByte::encode_single(n, out);
 
     uint64_t block_size = codec->block_size();
     uint64_t blocks = ceil_div(n, block_size);
+    uint64_t skips = skip_layer ? ceil_div(blocks, SKIP_INTERVAL) : 0;
     size_t begin_block_maxs = out.size();
     size_t begin_block_endpoints = begin_block_maxs + 4 * blocks;
-    size_t begin_blocks = begin_block_endpoints + 4 * (blocks - 1);
+    size_t begin_skips = begin_block_endpoints + 4 * (blocks - 1);
+    size_t begin_block_scores = begin_skips + 4 * skips;
+    size_t begin_bitmap = begin_block_scores + (scores != nullptr ? 4 + blocks : 0);
+    size_t begin_blocks = begin_bitmap + (dense ? 8 * dense_bitmap_words(docs[n - 1]) : 0);
     out.resize(begin_blocks);
+    if (dense) {
+        for (size_t i = 0; i < n; ++i) {
+            out[begin_bitmap + docs[i] / 8] |= uint8_t(1) << (docs[i] % 8);
+        }
+    }
 
     std::vector<uint32_t> docs_buf(block_size);
     std::vector<uint32_t> freqs_buf(block_size);
@@ -117,9 +196,11 @@ void index::block::write_posting_list(
         }
         std::memcpy(out.data() + begin_block_maxs + 4 * b, &last_doc, sizeof(last_doc));
 
-        codec->encode(
-            docs_buf.data(), last_doc - block_base - (cur_block_size - 1), cur_block_size, out
-        );
+        if (!dense) {
+            codec->encode(
+                docs_buf.data(), last_doc - block_base - (cur_block_size - 1), cur_block_size, out
+            );
+        }
         codec->encode(freqs_buf.data(), uint32_t(-1), cur_block_size, out);
         if (b != blocks - 1) {
             std::uint32_t endpoint = out.size() - begin_blocks;
@@ -127,12 +208,60 @@ void index::block::write_posting_list(
         }
         block_base = last_doc + 1;
     }
+    if (scores != nullptr) {
+        write_block_max_scores(out.data() + begin_block_scores, n, block_size, scores);
+    }
+    for (size_t skip = 0; skip < skips; ++skip) {
+        size_t last_block = std::min<size_t>((skip + 1) * SKIP_INTERVAL, blocks) - 1;
+        std::memcpy(
+            out.data() + begin_skips + 4 * skip, out.data() + begin_block_maxs + 4 * last_block, 4
+        );
+    }
+}
+
+void index::block::PostingAccumulator::select_codecs(
+    std::shared_ptr<HybridCodecSelector const> selector
+) {
+    m_codec_selector = std::move(selector);
+}
+
+void index::block::PostingAccumulator::dense_cutoff(std::optional<double> cutoff) {
+    m_dense_cutoff = cutoff;
+}
+
+void index::block::PostingAccumulator::block_max_scorer(std::uint32_t scorer) {
+    m_block_max_scorer = scorer;
 }
 
 void index::block::PostingAccumulator::write(
-    std::vector<uint8_t>& out, std::uint32_t n, std::uint32_t const* docs, std::uint32_t const* freqs
+    std::vector<uint8_t>& out,
+    std::uint32_t n,
+    std::uint32_t const* docs,
+    std::uint32_t const* freqs,
+    float const* scores
 ) {
-    write_posting_list(m_block_codec.get(), out, n, docs, freqs);
+    bool dense = m_dense_cutoff.has_value()
+        && static_cast<double>(n) >= *m_dense_cutoff * static_cast<double>(m_num_docs);
+    auto scorer = m_term_id == 0 ? m_block_max_scorer : std::nullopt;
+    if (m_codec_selector != nullptr) {
+        m_codec_selector->write(
+            out, m_term_id, n, docs, freqs, m_skip_layer, dense, scores, scorer
+        );
+    } else {
+        write_posting_list(
+            m_block_codec.get(),
+            out,
+            n,
+            docs,
+            freqs,
+            m_skip_layer,
+            std::nullopt,
+            dense,
+            scores,
+            scorer
+        );
+    }
+    ++m_term_id;
 }
 
 BlockIndexBuilder::BlockIndexBuilder(BlockCodecPtr block_codec, ScorerParams scorer_params)
@@ -148,16 +277,44 @@ auto BlockIndexBuilder::in_memory(bool in_mem) -> BlockIndexBuilder& {
     return *this;
 }
 
+auto BlockIndexBuilder::skip_layer(bool skip_layer) -> BlockIndexBuilder& {
+    m_skip_layer = skip_layer;
+    return *this;
+}
+
+auto BlockIndexBuilder::hybrid(std::shared_ptr<index::block::HybridCodecSelector const> selector)
+    -> BlockIndexBuilder& {
+    m_codec_selector = std::move(selector);
+    return *this;
+}
+
+auto BlockIndexBuilder::dense_cutoff(std::optional<double> cutoff) -> BlockIndexBuilder& {
+    m_dense_cutoff = cutoff;
+    return *this;
+}
+
 auto BlockIndexBuilder::resolve_accumulator(std::size_t num_docs, std::string const& index_path)
     -> std::unique_ptr<index::block::PostingAccumulator> {
+    std::unique_ptr<index::block::PostingAccumulator> accumulator;
     if (m_in_memory) {
-        return std::make_unique<index::block::InMemoryPostingAccumulator>(
-            m_block_codec, num_docs, index_path
+        accumulator = std::make_unique<index::block::InMemoryPostingAccumulator>(
+            m_block_codec, num_docs, index_path, m_skip_layer
+        );
+    } else {
+        accumulator = std::make_unique<index::block::StreamPostingAccumulator>(
+            m_block_codec, num_docs, index_path, m_skip_layer
         );
     }
-    return std::make_unique<index::block::StreamPostingAccumulator>(
-        m_block_codec, num_docs, index_path
-    );
+    accumulator->select_codecs(m_codec_selector);
+    accumulator->dense_cutoff(m_dense_cutoff);
+    if (m_block_max_scorer != nullptr) {
+        // quantized indexes store the block max scores of the quantized scores
+        accumulator->block_max_scorer(
+            m_quantizing_scorer.has_value() ? scorer_fingerprint("quantized", {})
+                                            : m_block_max_scorer->fingerprint()
+        );
+    }
+    return accumulator;
 }
 
 void BlockIndexBuilder::build(binary_freq_collection const& input, std::string const& index_path) {
@@ -183,37 +340,44 @@ void BlockIndexBuilder::build(binary_freq_collection const& input, std::string c
     double elapsed_secs = (get_time_usecs() - tick) / 1000000;
     spdlog::info("Index compressed in {} seconds", elapsed_secs);
 
+    std::string type = m_codec_selector != nullptr ? std::string(HybridBlockInvertedIndex::encoding)
+                                                    : std::string(m_block_codec->get_name());
     std::cout << pisa::json_stats()
-                     .add("type", m_block_codec->get_name())
+                     .add("type", type)
                      .add("worker_threads", std::thread::hardware_concurrency())
                      .add("construction_time", elapsed_secs)
                      .str();
 
     if (m_check) {
-        BlockInvertedIndex index(
-            MemorySource::mapped_file(std::filesystem::path(index_path)), m_block_codec
-        );
-        dump_stats(index.size_stats(), postings);
-        verify_collection<binary_freq_collection, BlockInvertedIndex>(
-            input, index, std::move(m_quantizing_scorer)
-        );
+        auto verify = [&](auto index) {
+            dump_stats(index.size_stats(), postings);
+            verify_collection(input, index, std::move(m_quantizing_scorer));
+        };
+        auto source = MemorySource::mapped_file(std::filesystem::path(index_path));
+        if (m_codec_selector != nullptr) {
+            verify(HybridBlockInvertedIndex(std::move(source)));
+        } else {
+            verify(BlockInvertedIndex(std::move(source), m_block_codec));
+        }
     }
 }
 
 index::block::InMemoryPostingAccumulator::InMemoryPostingAccumulator(
-    BlockCodecPtr block_codec, std::size_t num_docs, std::string output_filename
+    BlockCodecPtr block_codec, std::size_t num_docs, std::string output_filename, bool skip_layer
 )
-    : index::block::PostingAccumulator(block_codec, num_docs, std::move(output_filename)) {
+    : index::block::PostingAccumulator(
+          block_codec, num_docs, std::move(output_filename), skip_layer
+      ) {
     m_endpoints.push_back(0);
 }
 
 void index::block::InMemoryPostingAccumulator::accumulate_posting_list(
-    std::uint64_t n, std::uint32_t const* docs, std::uint32_t const* freqs
+    std::uint64_t n, std::uint32_t const* docs, std::uint32_t const* freqs, float const* scores
 ) {
     if (n == 0U) {
         throw std::invalid_argument("List must be nonempty");
     }
-    write(m_lists, n, docs, freqs);
+    write(m_lists, n, docs, freqs, scores);
     m_endpoints.push_back(m_lists.size());
 }
 
@@ -238,21 +402,21 @@ void index::block::InMemoryPostingAccumulator::finish() {
 }
 
 index::block::StreamPostingAccumulator::StreamPostingAccumulator(
-    BlockCodecPtr block_codec, std::size_t num_docs, std::string output_filename
+    BlockCodecPtr block_codec, std::size_t num_docs, std::string output_filename, bool skip_layer
 )
-    : index::block::PostingAccumulator(block_codec, num_docs, output_filename),
+    : index::block::PostingAccumulator(block_codec, num_docs, output_filename, skip_layer),
       m_tmp(std::filesystem::path(output_filename).parent_path()),
       m_tmp_file(m_tmp.path() / "buffer"),
       m_postings_output(m_tmp_file) {}
 
 void index::block::StreamPostingAccumulator::accumulate_posting_list(
-    std::uint64_t n, std::uint32_t const* docs, std::uint32_t const* freqs
+    std::uint64_t n, std::uint32_t const* docs, std::uint32_t const* freqs, float const* scores
 ) {
     if (n == 0) {
         throw std::invalid_argument("List must be nonempty");
     }
     std::vector<std::uint8_t> buf;
-    write(buf, n, docs, freqs);
+    write(buf, n, docs, freqs, scores);
     m_postings_bytes_written += buf.size();
     m_postings_output.write(reinterpret_cast<char const*>(buf.data()), buf.size());
     m_endpoints.push_back(m_postings_bytes_written);
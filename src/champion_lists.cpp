@@ -0,0 +1,133 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "champion_lists.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "span.hpp"
+
+namespace pisa {
+
+namespace {
+
+    constexpr std::uint32_t MAGIC = 0x50434C31;  // "PCL1"
+    constexpr std::uint32_t VERSION = 1;
+
+    static_assert(sizeof(ChampionEntry) == 8);
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t depth;
+        std::uint64_t num_terms;
+        std::uint64_t num_entries;
+    };
+
+    template <typename T>
+    [[nodiscard]] auto cast_span(std::span<char const> bytes, std::size_t offset, std::size_t count)
+        -> std::span<T const> {
+        auto sub = pisa::subspan_or_throw(
+            bytes, offset, count * sizeof(T), "champion lists are truncated"
+        );
+        return std::span<T const>(reinterpret_cast<T const*>(sub.data()), count);
+    }
+
+    template <typename T>
+    void write(std::ostream& out, T const* data, std::size_t count) {
+        out.write(reinterpret_cast<char const*>(data), count * sizeof(T));
+    }
+
+}  // namespace
+
+ChampionLists::ChampionLists(MemorySource source) : m_source(std::move(source)) {
+    auto bytes = m_source.span();
+    if (bytes.size() < sizeof(Header)) {
+        throw std::invalid_argument("champion lists are truncated");
+    }
+    Header header{};
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    if (header.magic != MAGIC) {
+        throw std::invalid_argument("not champion lists");
+    }
+    if (header.version != VERSION) {
+        throw std::invalid_argument(
+            fmt::format("unsupported champion lists version: {}", header.version)
+        );
+    }
+    m_depth = header.depth;
+    std::size_t offset = sizeof(Header);
+    m_term_entries = cast_span<std::uint64_t>(bytes, offset, header.num_terms + 1);
+    offset += m_term_entries.size_bytes();
+    m_entries = cast_span<ChampionEntry>(bytes, offset, header.num_entries);
+}
+
+auto ChampionLists::depth() const noexcept -> std::size_t {
+    return m_depth;
+}
+
+auto ChampionLists::size() const noexcept -> std::size_t {
+    return m_term_entries.size() - 1;
+}
+
+auto ChampionLists::champions(TermId term) const noexcept -> std::span<ChampionEntry const> {
+    if (term >= size()) {
+        return {};
+    }
+    auto first = m_term_entries[term];
+    return m_entries.subspan(first, m_term_entries[term + 1] - first);
+}
+
+auto ChampionLists::covers(TermId term, std::size_t k) const noexcept -> bool {
+    auto size = champions(term).size();
+    return term < this->size() && (size >= k || size < m_depth);
+}
+
+ChampionListsBuilder::ChampionListsBuilder(std::size_t depth, std::size_t num_terms)
+    : m_depth(depth), m_lists(num_terms) {}
+
+void ChampionListsBuilder::term(TermId term, std::vector<ChampionEntry> postings) {
+    auto& list = m_lists.at(term);
+    std::erase_if(postings, [](auto const& entry) { return entry.score <= 0.0F; });
+    auto by_score = [](auto const& lhs, auto const& rhs) {
+        return lhs.score > rhs.score || (lhs.score == rhs.score && lhs.docid < rhs.docid);
+    };
+    auto last = std::next(
+        postings.begin(), static_cast<std::ptrdiff_t>(std::min(m_depth, postings.size()))
+    );
+    std::partial_sort(postings.begin(), last, postings.end(), by_score);
+    postings.erase(last, postings.end());
+    postings.shrink_to_fit();
+    list = std::move(postings);
+}
+
+void ChampionListsBuilder::encode(std::ostream& out) const {
+    std::vector<std::uint64_t> term_entries{0};
+    term_entries.reserve(m_lists.size() + 1);
+    for (auto const& list: m_lists) {
+        term_entries.push_back(term_entries.back() + list.size());
+    }
+    Header header{MAGIC, VERSION, m_depth, m_lists.size(), term_entries.back()};
+    write(out, &header, 1);
+    write(out, term_entries.data(), term_entries.size());
+    for (auto const& list: m_lists) {
+        write(out, list.data(), list.size());
+    }
+}
+
+}  // namespace pisa
@@ -0,0 +1,70 @@
+#include "codec/adaptive.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+#include "codec/block_codecs.hpp"
+
+namespace pisa {
+
+AdaptiveBlockCodec::AdaptiveBlockCodec(double space_slack) : m_space_slack(space_slack) {
+    if (space_slack < 0.0) {
+        throw std::invalid_argument("space slack must be non-negative");
+    }
+}
+
+void AdaptiveBlockCodec::encode(
+    uint32_t const* in, uint32_t sum_of_values, size_t n, std::vector<uint8_t>& out
+) const {
+    assert(n <= m_block_size);
+    if (n > 0 && std::all_of(in, in + n, [value = in[0]](auto v) { return v == value; })) {
+        out.push_back(static_cast<uint8_t>(Encoding::Constant));
+        TightVariableByte::encode_single(in[0], out);
+        return;
+    }
+
+    // Indexed by `Encoding`; the constant encoding does not apply at this point.
+    thread_local std::array<std::vector<uint8_t>, 4> buffers;
+    std::array<BlockCodec const*, 4> codecs{nullptr, &m_simdbp, &m_streamvbyte, &m_optpfor};
+    std::size_t min_size = std::numeric_limits<std::size_t>::max();
+    for (std::size_t encoding = 1; encoding < codecs.size(); ++encoding) {
+        buffers[encoding].clear();
+        codecs[encoding]->encode(in, sum_of_values, n, buffers[encoding]);
+        min_size = std::min(min_size, buffers[encoding].size());
+    }
+    auto max_size = static_cast<double>(min_size) * (1.0 + m_space_slack);
+    for (std::size_t encoding = 1; encoding < codecs.size(); ++encoding) {
+        if (static_cast<double>(buffers[encoding].size()) <= max_size) {
+            out.push_back(static_cast<uint8_t>(encoding));
+            out.insert(out.end(), buffers[encoding].begin(), buffers[encoding].end());
+            return;
+        }
+    }
+}
+
+uint8_t const* AdaptiveBlockCodec::decode(
+    uint8_t const* in, uint32_t* out, uint32_t sum_of_values, size_t n
+) const {
+    assert(n <= m_block_size);
+    switch (encoding(in++)) {
+    case Encoding::Constant: {
+        std::uint32_t value = 0;
+        in = TightVariableByte::decode(in, &value, 1);
+        std::fill_n(out, n, value);
+        return in;
+    }
+    case Encoding::SimdBp: return m_simdbp.decode(in, out, sum_of_values, n);
+    case Encoding::StreamVByte: return m_streamvbyte.decode(in, out, sum_of_values, n);
+    case Encoding::OptPFor: return m_optpfor.decode(in, out, sum_of_values, n);
+    }
+    throw std::runtime_error("invalid adaptive block encoding");
+}
+
+auto AdaptiveBlockCodec::encoding(uint8_t const* in) -> Encoding {
+    return static_cast<Encoding>(*in);
+}
+
+}  // namespace pisa
@@ -6,6 +6,7 @@
 
 #include <fmt/format.h>
 
+#include "codec/adaptive.hpp"
 #include "codec/block_codec.hpp"
 #include "codec/interpolative.hpp"
 #include "codec/maskedvbyte.hpp"
@@ -21,6 +22,7 @@
 namespace pisa {
 
 using BlockCodecs = BlockCodecRegistry<
+    AdaptiveBlockCodec,
     InterpolativeBlockCodec,
     MaskedVByteBlockCodec,
     OptPForBlockCodec,
@@ -1,4 +1,7 @@
+#include <fstream>
+#include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
 
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -8,6 +11,7 @@
 #include "codec/block_codec.hpp"
 #include "codec/block_codec_registry.hpp"
 #include "compress.hpp"
+#include "hybrid_block_inverted_index.hpp"
 #include "index_types.hpp"
 #include "linear_quantizer.hpp"
 #include "type_safe.hpp"
@@ -198,6 +202,41 @@ void compress_index(
     }
 }
 
+namespace {
+
+    static_assert(
+        HybridCompressOptions{}.decode_weight
+        == index::block::HybridCodecSelector::DEFAULT_DECODE_WEIGHT
+    );
+
+    [[nodiscard]] auto open_input(std::string const& path) -> std::ifstream {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error(fmt::format("cannot open {}", path));
+        }
+        return in;
+    }
+
+    [[nodiscard]] auto hybrid_codec_selector(HybridCompressOptions const& options)
+        -> std::shared_ptr<index::block::HybridCodecSelector const> {
+        using index::block::HybridCodecSelector;
+        std::vector<std::uint64_t> term_frequencies;
+        if (options.term_frequencies_file) {
+            auto in = open_input(*options.term_frequencies_file);
+            term_frequencies = HybridCodecSelector::read_term_frequencies(in);
+        }
+        auto selector = std::make_shared<HybridCodecSelector>(
+            options.decode_weight, std::move(term_frequencies)
+        );
+        if (options.decode_model_file) {
+            auto in = open_input(*options.decode_model_file);
+            HybridCodecSelector::read_predictors(in, *selector);
+        }
+        return selector;
+    }
+
+}  // namespace
+
 void compress(
     std::string const& input_basename,
     std::optional<std::string> const& wand_data_filename,
@@ -206,24 +245,52 @@ void compress(
     ScorerParams const& scorer_params,
     std::optional<Size> quantization_bits,
     bool check,
-    bool in_memory
+    bool in_memory,
+    bool skip_layer,
+    HybridCompressOptions const& hybrid_options,
+    std::optional<double> dense_cutoff,
+    bool block_max_scores
 ) {
     binary_freq_collection input(input_basename.c_str());
     global_parameters params;
 
     auto block_codec = get_block_codec(index_encoding);
+    std::shared_ptr<index::block::HybridCodecSelector const> codec_selector;
+    if (index_encoding == HybridBlockInvertedIndex::encoding) {
+        codec_selector = hybrid_codec_selector(hybrid_options);
+        block_codec = index::block::hybrid_codecs().front();
+    }
     if (block_codec != nullptr) {
         BlockIndexBuilder builder(std::move(block_codec), scorer_params);
-        builder.check(check).in_memory(in_memory);
+        builder.check(check).in_memory(in_memory).skip_layer(skip_layer).hybrid(codec_selector);
+        builder.dense_cutoff(dense_cutoff);
         std::optional<wand_data<wand_data_raw>> wdata{};
-        if (quantization_bits.has_value()) {
+        if (quantization_bits.has_value() || block_max_scores) {
+            if (!wand_data_filename.has_value()) {
+                throw std::invalid_argument("scoring postings requires WAND data");
+            }
             wdata.emplace(MemorySource::mapped_file(*wand_data_filename));
+        }
+        if (quantization_bits.has_value()) {
             builder.quantize(*quantization_bits, *wdata);
         }
+        if (block_max_scores) {
+            builder.block_max_scores(*wdata);
+        }
         builder.build(input, output_filename);
         return;
     }
 
+    if (skip_layer) {
+        spdlog::warn("Skip layer is only supported by block indexes, ignoring");
+    }
+    if (dense_cutoff.has_value()) {
+        // Their sequences already switch to a bitvector where it is smaller.
+        spdlog::warn("Dense cutoff is only supported by block indexes, ignoring");
+    }
+    if (block_max_scores) {
+        spdlog::warn("Block max scores are only supported by block indexes, ignoring");
+    }
     resolve_freq_index_type(index_encoding, [&](auto index_traits) {
         using Index = typename std::decay_t<decltype(index_traits)>::type;
         compress_index<Index, wand_data<wand_data_raw>>(
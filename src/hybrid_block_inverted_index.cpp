@@ -0,0 +1,259 @@
+#include "hybrid_block_inverted_index.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "codec/block_codec_registry.hpp"
+#include "util/util.hpp"
+
+namespace pisa {
+
+namespace {
+
+    using time_prediction::feature_vector;
+    using time_prediction::predictor;
+
+    /**
+     * Rough decoding times in nanoseconds: a constant cost per block and a cost per value, which
+     * for interpolative coding also grows with the number of bits of the values.
+     */
+    [[nodiscard]] auto default_predictor(std::string_view codec) -> predictor {
+        if (codec == "block_simdbp") {
+            return predictor({{"bias", 10.0}, {"n", 0.25}});
+        }
+        if (codec == "block_streamvbyte") {
+            return predictor({{"bias", 10.0}, {"n", 0.35}});
+        }
+        if (codec == "block_optpfor") {
+            return predictor({{"bias", 20.0}, {"n", 0.6}});
+        }
+        if (codec == "block_varintgb") {
+            return predictor({{"bias", 10.0}, {"n", 0.7}});
+        }
+        return predictor({{"bias", 20.0}, {"n", 1.0}, {"sum_of_logs", 0.5}});
+    }
+
+    [[nodiscard]] auto codec_position(std::string_view codec) -> std::size_t {
+        auto pos = std::find(
+            index::block::HYBRID_CODECS.begin(), index::block::HYBRID_CODECS.end(), codec
+        );
+        if (pos == index::block::HYBRID_CODECS.end()) {
+            throw std::invalid_argument(fmt::format("not a hybrid index codec: {}", codec));
+        }
+        return static_cast<std::size_t>(std::distance(index::block::HYBRID_CODECS.begin(), pos));
+    }
+
+    /**
+     * Returns the features of the document gaps and the frequencies of each block, in the form
+     * they are encoded in (see `index::block::write_posting_list`).
+     */
+    [[nodiscard]] auto block_features(
+        std::size_t block_size,
+        std::uint32_t n,
+        std::uint32_t const* docs,
+        std::uint32_t const* freqs
+    ) -> std::vector<feature_vector> {
+        std::vector<feature_vector> features;
+        features.reserve(2 * ceil_div(n, block_size));
+        std::vector<std::uint32_t> docs_buf;
+        std::vector<std::uint32_t> freqs_buf;
+        std::int64_t last_doc = -1;
+        for (std::size_t begin = 0; begin < n; begin += block_size) {
+            auto end = std::min<std::size_t>(begin + block_size, n);
+            docs_buf.clear();
+            freqs_buf.clear();
+            for (auto pos = begin; pos < end; ++pos) {
+                docs_buf.push_back(docs[pos] - last_doc - 1);
+                last_doc = docs[pos];
+                freqs_buf.push_back(freqs[pos] - 1);
+            }
+            time_prediction::values_statistics(std::move(docs_buf), features.emplace_back());
+            time_prediction::values_statistics(std::move(freqs_buf), features.emplace_back());
+        }
+        return features;
+    }
+
+    [[nodiscard]] auto
+    predict(predictor const& model, std::vector<feature_vector> const& features) -> double {
+        double time = 0.0;
+        for (auto const& block: features) {
+            time += model(block);
+        }
+        return time;
+    }
+
+}  // namespace
+
+auto index::block::hybrid_codecs() -> std::vector<BlockCodecPtr> {
+    std::vector<BlockCodecPtr> codecs;
+    for (auto name: HYBRID_CODECS) {
+        codecs.push_back(get_block_codec(name));
+    }
+    return codecs;
+}
+
+index::block::HybridCodecSelector::HybridCodecSelector(
+    double decode_weight, std::vector<std::uint64_t> term_frequencies
+)
+    : m_codecs(hybrid_codecs()),
+      m_decode_weight(decode_weight),
+      m_term_frequencies(std::move(term_frequencies)) {
+    if (decode_weight < 0.0) {
+        throw std::invalid_argument("decode weight must be non-negative");
+    }
+    for (std::size_t tag = 0; tag < m_codecs.size(); ++tag) {
+        if (m_codecs[tag]->block_size() != m_codecs.front()->block_size()) {
+            throw std::logic_error("hybrid index codecs must have the same block size");
+        }
+        m_predictors[tag] = default_predictor(HYBRID_CODECS[tag]);
+    }
+}
+
+void index::block::HybridCodecSelector::predictor(
+    std::string_view codec, time_prediction::predictor predictor
+) {
+    m_predictors[codec_position(codec)] = predictor;
+}
+
+auto index::block::HybridCodecSelector::frequency(TermId term_id) const -> double {
+    if (m_term_frequencies.empty()) {
+        return 1.0;
+    }
+    return term_id < m_term_frequencies.size() ? static_cast<double>(m_term_frequencies[term_id])
+                                               : 0.0;
+}
+
+auto index::block::HybridCodecSelector::decoding_time(
+    std::uint32_t codec_tag, std::uint32_t n, std::uint32_t const* docs, std::uint32_t const* freqs
+) const -> double {
+    auto features = block_features(m_codecs.front()->block_size(), n, docs, freqs);
+    return predict(m_predictors.at(codec_tag), features);
+}
+
+auto index::block::HybridCodecSelector::write(
+    std::vector<std::uint8_t>& out,
+    TermId term_id,
+    std::uint32_t n,
+    std::uint32_t const* docs,
+    std::uint32_t const* freqs,
+    bool skip_layer,
+    bool dense,
+    float const* scores,
+    std::optional<std::uint32_t> scorer
+) const -> std::uint32_t {
+    auto weight = m_decode_weight * frequency(term_id);
+    std::vector<feature_vector> features;
+    if (weight > 0.0) {
+        features = block_features(m_codecs.front()->block_size(), n, docs, freqs);
+    }
+    std::vector<std::uint8_t> best;
+    std::vector<std::uint8_t> candidate;
+    std::uint32_t best_tag = 0;
+    double best_cost = std::numeric_limits<double>::infinity();
+    for (std::uint32_t tag = 0; tag < m_codecs.size(); ++tag) {
+        candidate.clear();
+        write_posting_list(
+            m_codecs[tag].get(), candidate, n, docs, freqs, skip_layer, tag, dense, scores, scorer
+        );
+        double cost = static_cast<double>(candidate.size());
+        if (weight > 0.0) {
+            cost += weight * predict(m_predictors[tag], features);
+        }
+        if (cost < best_cost) {
+            best_cost = cost;
+            best_tag = tag;
+            std::swap(best, candidate);
+        }
+    }
+    out.insert(out.end(), best.begin(), best.end());
+    return best_tag;
+}
+
+auto index::block::HybridCodecSelector::read_term_frequencies(std::istream& in)
+    -> std::vector<std::uint64_t> {
+    std::vector<std::uint64_t> frequencies;
+    std::string line;
+    while (std::getline(in, line)) {
+        frequencies.push_back(std::stoull(line));
+    }
+    return frequencies;
+}
+
+void index::block::HybridCodecSelector::read_predictors(
+    std::istream& in, HybridCodecSelector& selector
+) {
+    std::map<std::string, std::vector<std::pair<std::string, float>>> weights;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string codec;
+        std::string feature;
+        float weight = 0.0;
+        if (!(fields >> codec)) {
+            continue;
+        }
+        if (!(fields >> feature >> weight)) {
+            throw std::invalid_argument(fmt::format("invalid predictor line: {}", line));
+        }
+        weights[codec].emplace_back(feature, weight);
+    }
+    for (auto const& [codec, values]: weights) {
+        selector.predictor(codec, time_prediction::predictor(values));
+    }
+}
+
+HybridBlockInvertedIndex::HybridBlockInvertedIndex(
+    MemorySource source, std::vector<BlockCodecPtr> codecs
+)
+    : BlockInvertedIndex(std::move(source), codecs.front()), m_codecs(std::move(codecs)) {
+    static_assert((
+        concepts::SortedInvertedIndex<HybridBlockInvertedIndex, BlockInvertedIndexCursor<>>
+    ));
+}
+
+HybridBlockInvertedIndex::HybridBlockInvertedIndex(MemorySource source)
+    : HybridBlockInvertedIndex(std::move(source), index::block::hybrid_codecs()) {}
+
+auto HybridBlockInvertedIndex::list_codec(std::uint8_t const* data) const -> BlockCodec const* {
+    std::uint32_t n = 0;
+    std::uint32_t flags = 0;
+    std::uint32_t codec_tag = 0;
+    index::block::decode_posting_list_header(data, n, flags, codec_tag);
+    if (codec_tag >= m_codecs.size()) {
+        throw std::runtime_error(fmt::format("unknown codec tag: {}", codec_tag));
+    }
+    return m_codecs[codec_tag].get();
+}
+
+auto HybridBlockInvertedIndex::operator[](std::size_t term_id) const -> BlockInvertedIndexCursor<> {
+    auto const* data = posting_list_data(term_id);
+    return BlockInvertedIndexCursor(list_codec(data), data, num_docs(), term_id);
+}
+
+auto HybridBlockInvertedIndex::cursor(
+    std::size_t term_id, std::pmr::memory_resource* resource
+) const -> BlockInvertedIndexCursor<> {
+    auto const* data = posting_list_data(term_id);
+    return BlockInvertedIndexCursor(list_codec(data), data, num_docs(), term_id, resource);
+}
+
+auto HybridBlockInvertedIndex::codec_tag(std::size_t term_id) const -> std::uint32_t {
+    std::uint32_t n = 0;
+    std::uint32_t flags = 0;
+    std::uint32_t codec_tag = 0;
+    index::block::decode_posting_list_header(posting_list_data(term_id), n, flags, codec_tag);
+    return codec_tag;
+}
+
+auto HybridBlockInvertedIndex::size_stats() -> SizeStats {
+    return collect_size_stats(*this);
+}
+
+}  // namespace pisa
@@ -0,0 +1,166 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "impact_ordered_index.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "span.hpp"
+
+namespace pisa {
+
+namespace {
+
+    constexpr std::uint32_t MAGIC = 0x50494F31;  // "PIO1"
+    constexpr std::uint32_t VERSION = 1;
+
+    static_assert(sizeof(ImpactSegment) == 16);
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t num_docs;
+        std::uint64_t num_terms;
+        std::uint64_t num_segments;
+        std::uint64_t num_postings;
+    };
+
+    template <typename T>
+    [[nodiscard]] auto cast_span(std::span<char const> bytes, std::size_t offset, std::size_t count)
+        -> std::span<T const> {
+        auto sub = pisa::subspan_or_throw(
+            bytes, offset, count * sizeof(T), "impact-ordered index is truncated"
+        );
+        return std::span<T const>(reinterpret_cast<T const*>(sub.data()), count);
+    }
+
+    template <typename T>
+    void write(std::ostream& out, T const* data, std::size_t count) {
+        out.write(reinterpret_cast<char const*>(data), count * sizeof(T));
+    }
+
+}  // namespace
+
+ImpactOrderedIndex::ImpactOrderedIndex(MemorySource source) : m_source(std::move(source)) {
+    auto bytes = m_source.span();
+    if (bytes.size() < sizeof(Header)) {
+        throw std::invalid_argument("impact-ordered index is truncated");
+    }
+    Header header{};
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    if (header.magic != MAGIC) {
+        throw std::invalid_argument("not an impact-ordered index");
+    }
+    if (header.version != VERSION) {
+        throw std::invalid_argument(
+            fmt::format("unsupported impact-ordered index version: {}", header.version)
+        );
+    }
+    m_num_docs = header.num_docs;
+    std::size_t offset = sizeof(Header);
+    m_term_segments = cast_span<std::uint64_t>(bytes, offset, header.num_terms + 1);
+    offset += m_term_segments.size_bytes();
+    m_segments = cast_span<ImpactSegment>(bytes, offset, header.num_segments);
+    offset += m_segments.size_bytes();
+    m_documents = cast_span<DocId>(bytes, offset, header.num_postings);
+}
+
+auto ImpactOrderedIndex::num_docs() const noexcept -> std::size_t {
+    return m_num_docs;
+}
+
+auto ImpactOrderedIndex::size() const noexcept -> std::size_t {
+    return m_term_segments.size() - 1;
+}
+
+auto ImpactOrderedIndex::num_postings() const noexcept -> std::size_t {
+    return m_documents.size();
+}
+
+auto ImpactOrderedIndex::segments(TermId term) const -> std::span<ImpactSegment const> {
+    if (term >= size()) {
+        throw std::out_of_range(
+            fmt::format("term {} out of range of impact-ordered index of size {}", term, size())
+        );
+    }
+    auto first = m_term_segments[term];
+    return m_segments.subspan(first, m_term_segments[term + 1] - first);
+}
+
+auto ImpactOrderedIndex::documents(ImpactSegment const& segment) const noexcept
+    -> std::span<DocId const> {
+    return m_documents.subspan(segment.offset, segment.size);
+}
+
+ImpactOrderedIndexBuilder::ImpactOrderedIndexBuilder(std::size_t num_docs)
+    : m_num_docs(num_docs) {}
+
+void ImpactOrderedIndexBuilder::add_posting_list(
+    std::span<DocId const> documents, std::span<std::uint32_t const> impacts
+) {
+    if (documents.size() != impacts.size()) {
+        throw std::invalid_argument(fmt::format(
+            "posting list has {} documents but {} impacts", documents.size(), impacts.size()
+        ));
+    }
+    m_postings.clear();
+    for (std::size_t pos = 0; pos < documents.size(); ++pos) {
+        if (documents[pos] >= m_num_docs) {
+            throw std::invalid_argument(fmt::format(
+                "document {} out of range of collection of size {}", documents[pos], m_num_docs
+            ));
+        }
+        if (impacts[pos] > 0) {
+            m_postings.emplace_back(impacts[pos], documents[pos]);
+        }
+    }
+    std::sort(m_postings.begin(), m_postings.end(), [](auto const& lhs, auto const& rhs) {
+        return lhs.first > rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    });
+    for (auto const& [impact, docid]: m_postings) {
+        if (m_segments.size() == m_term_segments.back() || m_segments.back().impact != impact
+            || m_segments.back().size == std::numeric_limits<std::uint32_t>::max()) {
+            m_segments.push_back(ImpactSegment{impact, 0, m_documents.size()});
+        }
+        m_segments.back().size += 1;
+        m_documents.push_back(docid);
+    }
+    m_term_segments.push_back(m_segments.size());
+}
+
+auto ImpactOrderedIndexBuilder::size() const noexcept -> std::size_t {
+    return m_term_segments.size() - 1;
+}
+
+void ImpactOrderedIndexBuilder::encode(std::ostream& out) const {
+    Header header{
+        MAGIC,
+        VERSION,
+        m_num_docs,
+        size(),
+        m_segments.size(),
+        m_documents.size(),
+    };
+    write(out, &header, 1);
+    write(out, m_term_segments.data(), m_term_segments.size());
+    write(out, m_segments.data(), m_segments.size());
+    write(out, m_documents.data(), m_documents.size());
+}
+
+}  // namespace pisa
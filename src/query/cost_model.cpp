@@ -0,0 +1,290 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "query/cost_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <numeric>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "dec_time_prediction.hpp"
+
+namespace pisa {
+
+namespace {
+
+    enum class Feature : std::size_t {
+        terms,
+        sum_postings,
+        min_postings,
+        max_postings,
+        conjunctive_postings,
+        sum_of_logs,
+        max_b,
+        score_skew,
+    };
+
+    auto& at(QueryFeatures& features, Feature feature) {
+        return features.values[static_cast<std::size_t>(feature)];
+    }
+
+    /** Returns the position of the feature named `name`, or `QueryFeatures::size` for bias. */
+    [[nodiscard]] auto parse_feature(std::string_view name) -> std::size_t {
+        if (name == "bias") {
+            return QueryFeatures::size;
+        }
+        auto pos = std::find(QueryFeatures::names.begin(), QueryFeatures::names.end(), name);
+        if (pos == QueryFeatures::names.end()) {
+            throw std::invalid_argument(fmt::format("Invalid query feature name: {}", name));
+        }
+        return static_cast<std::size_t>(std::distance(QueryFeatures::names.begin(), pos));
+    }
+
+    /**
+     * Solves `matrix * x = rhs` by Gaussian elimination with partial pivoting, overwriting `rhs`
+     * with the solution. The matrix is square and stored by rows.
+     */
+    void solve(std::vector<double>& matrix, std::vector<double>& rhs) {
+        auto n = rhs.size();
+        for (std::size_t col = 0; col < n; ++col) {
+            std::size_t pivot = col;
+            for (std::size_t row = col + 1; row < n; ++row) {
+                if (std::abs(matrix[row * n + col]) > std::abs(matrix[pivot * n + col])) {
+                    pivot = row;
+                }
+            }
+            for (std::size_t idx = 0; idx < n; ++idx) {
+                std::swap(matrix[col * n + idx], matrix[pivot * n + idx]);
+            }
+            std::swap(rhs[col], rhs[pivot]);
+            for (std::size_t row = col + 1; row < n; ++row) {
+                auto factor = matrix[row * n + col] / matrix[col * n + col];
+                for (std::size_t idx = col; idx < n; ++idx) {
+                    matrix[row * n + idx] -= factor * matrix[col * n + idx];
+                }
+                rhs[row] -= factor * rhs[col];
+            }
+        }
+        for (std::size_t col = n; col-- > 0;) {
+            for (std::size_t idx = col + 1; idx < n; ++idx) {
+                rhs[col] -= matrix[col * n + idx] * rhs[idx];
+            }
+            rhs[col] /= matrix[col * n + col];
+        }
+    }
+
+}  // namespace
+
+auto query_features(
+    std::span<std::uint32_t const> list_sizes, std::span<float const> max_term_scores
+) -> QueryFeatures {
+    if (list_sizes.size() != max_term_scores.size()) {
+        throw std::invalid_argument("number of list sizes and maximum term scores differ");
+    }
+    QueryFeatures features;
+    if (list_sizes.empty()) {
+        return features;
+    }
+    time_prediction::feature_vector size_statistics;
+    time_prediction::values_statistics(
+        std::vector<std::uint32_t>(list_sizes.begin(), list_sizes.end()), size_statistics
+    );
+    auto [min_size, max_size] = std::minmax_element(list_sizes.begin(), list_sizes.end());
+    auto sum_scores = std::accumulate(max_term_scores.begin(), max_term_scores.end(), 0.0);
+    auto max_score = *std::max_element(max_term_scores.begin(), max_term_scores.end());
+
+    at(features, Feature::terms) = static_cast<double>(list_sizes.size());
+    at(features, Feature::sum_postings) =
+        std::accumulate(list_sizes.begin(), list_sizes.end(), 0.0);
+    at(features, Feature::min_postings) = *min_size;
+    at(features, Feature::max_postings) = *max_size;
+    at(features, Feature::conjunctive_postings) =
+        static_cast<double>(*min_size) * static_cast<double>(list_sizes.size());
+    using time_prediction::feature_type;
+    at(features, Feature::sum_of_logs) = size_statistics[feature_type::sum_of_logs];
+    at(features, Feature::max_b) = size_statistics[feature_type::max_b];
+    at(features, Feature::score_skew) = sum_scores > 0.0 ? max_score / sum_scores : 0.0;
+    return features;
+}
+
+CostPredictor::CostPredictor(double bias, weights_type weights)
+    : m_bias(bias), m_weights(weights) {}
+
+auto CostPredictor::fit(
+    std::span<QueryFeatures const> features, std::span<double const> costs, double ridge
+) -> CostPredictor {
+    if (features.empty()) {
+        throw std::invalid_argument("cannot fit a cost predictor without observations");
+    }
+    if (features.size() != costs.size()) {
+        throw std::invalid_argument("number of feature vectors and costs differ");
+    }
+    constexpr auto dim = QueryFeatures::size;
+    auto count = static_cast<double>(features.size());
+
+    // Features are standardized, so that the ridge penalty affects all of them alike, and
+    // constant features (zero deviation) are left out of the fit.
+    std::array<double, dim> mean{};
+    std::array<double, dim> deviation{};
+    for (auto const& f: features) {
+        for (std::size_t idx = 0; idx < dim; ++idx) {
+            mean[idx] += f.values[idx] / count;
+        }
+    }
+    for (auto const& f: features) {
+        for (std::size_t idx = 0; idx < dim; ++idx) {
+            deviation[idx] += (f.values[idx] - mean[idx]) * (f.values[idx] - mean[idx]) / count;
+        }
+    }
+    for (auto& dev: deviation) {
+        dev = std::sqrt(dev);
+    }
+    auto mean_cost = std::accumulate(costs.begin(), costs.end(), 0.0) / count;
+
+    std::vector<double> gram(dim * dim, 0.0);
+    std::vector<double> rhs(dim, 0.0);
+    std::array<double, dim> row{};
+    for (std::size_t obs = 0; obs < features.size(); ++obs) {
+        for (std::size_t idx = 0; idx < dim; ++idx) {
+            row[idx] = deviation[idx] > 0.0
+                ? (features[obs].values[idx] - mean[idx]) / deviation[idx]
+                : 0.0;
+        }
+        for (std::size_t i = 0; i < dim; ++i) {
+            for (std::size_t j = 0; j < dim; ++j) {
+                gram[i * dim + j] += row[i] * row[j];
+            }
+            rhs[i] += row[i] * (costs[obs] - mean_cost);
+        }
+    }
+    for (std::size_t idx = 0; idx < dim; ++idx) {
+        // Constant features get a unit diagonal, which makes their coefficient 0.
+        gram[idx * dim + idx] += deviation[idx] > 0.0 ? ridge * count : 1.0;
+    }
+    solve(gram, rhs);
+
+    weights_type weights{};
+    double bias = mean_cost;
+    for (std::size_t idx = 0; idx < dim; ++idx) {
+        if (deviation[idx] > 0.0) {
+            weights[idx] = rhs[idx] / deviation[idx];
+            bias -= weights[idx] * mean[idx];
+        }
+    }
+    return CostPredictor(bias, weights);
+}
+
+auto CostPredictor::operator()(QueryFeatures const& features) const -> double {
+    return std::inner_product(
+        m_weights.begin(), m_weights.end(), features.values.begin(), m_bias
+    );
+}
+
+void CostModel::add(std::string algorithm, CostPredictor predictor) {
+    auto pos = std::find_if(m_predictors.begin(), m_predictors.end(), [&](auto const& entry) {
+        return entry.first == algorithm;
+    });
+    if (pos != m_predictors.end()) {
+        pos->second = predictor;
+    } else {
+        m_predictors.emplace_back(std::move(algorithm), predictor);
+    }
+}
+
+auto CostModel::algorithms() const -> std::vector<std::string> {
+    std::vector<std::string> algorithms;
+    algorithms.reserve(m_predictors.size());
+    for (auto const& [algorithm, _]: m_predictors) {
+        algorithms.push_back(algorithm);
+    }
+    return algorithms;
+}
+
+auto CostModel::predict(std::string_view algorithm, QueryFeatures const& features) const -> double {
+    for (auto const& [name, predictor]: m_predictors) {
+        if (name == algorithm) {
+            return predictor(features);
+        }
+    }
+    throw std::invalid_argument(fmt::format("No cost predictor for algorithm: {}", algorithm));
+}
+
+auto CostModel::select(QueryFeatures const& features) const -> std::size_t {
+    if (m_predictors.empty()) {
+        throw std::logic_error("cannot select an algorithm with an empty cost model");
+    }
+    std::size_t best = 0;
+    double best_cost = m_predictors.front().second(features);
+    for (std::size_t pos = 1; pos < m_predictors.size(); ++pos) {
+        if (auto cost = m_predictors[pos].second(features); cost < best_cost) {
+            best = pos;
+            best_cost = cost;
+        }
+    }
+    return best;
+}
+
+auto CostModel::read(std::istream& in) -> CostModel {
+    std::vector<std::pair<std::string, std::pair<double, CostPredictor::weights_type>>> entries;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string algorithm;
+        std::string feature;
+        double value = 0.0;
+        if (!(fields >> algorithm)) {
+            continue;
+        }
+        if (!(fields >> feature >> value)) {
+            throw std::invalid_argument(fmt::format("Invalid cost model line: {}", line));
+        }
+        auto pos = std::find_if(entries.begin(), entries.end(), [&](auto const& entry) {
+            return entry.first == algorithm;
+        });
+        if (pos == entries.end()) {
+            entries.emplace_back(algorithm, std::pair<double, CostPredictor::weights_type>{});
+            pos = std::prev(entries.end());
+        }
+        auto idx = parse_feature(feature);
+        if (idx == QueryFeatures::size) {
+            pos->second.first = value;
+        } else {
+            pos->second.second[idx] = value;
+        }
+    }
+    CostModel model;
+    for (auto& [algorithm, coefficients]: entries) {
+        model.add(std::move(algorithm), CostPredictor(coefficients.first, coefficients.second));
+    }
+    return model;
+}
+
+void CostModel::write(std::ostream& out) const {
+    for (auto const& [algorithm, predictor]: m_predictors) {
+        out << fmt::format("{}\tbias\t{}\n", algorithm, predictor.bias());
+        for (std::size_t idx = 0; idx < QueryFeatures::size; ++idx) {
+            out << fmt::format(
+                "{}\t{}\t{}\n", algorithm, QueryFeatures::names[idx], predictor.weights()[idx]
+            );
+        }
+    }
+}
+
+}  // namespace pisa
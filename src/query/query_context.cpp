@@ -0,0 +1,117 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "query/query_context.hpp"
+
+namespace pisa {
+
+namespace {
+
+    constexpr std::size_t arena_alignment = alignof(std::max_align_t);
+
+}  // namespace
+
+auto QueryContext::OverflowResource::do_allocate(std::size_t bytes, std::size_t alignment)
+    -> void* {
+    m_allocated += bytes;
+    return m_upstream->allocate(bytes, alignment);
+}
+
+void QueryContext::OverflowResource::do_deallocate(
+    void* ptr, std::size_t bytes, std::size_t alignment
+) {
+    m_upstream->deallocate(ptr, bytes, alignment);
+}
+
+auto QueryContext::OverflowResource::do_is_equal(std::pmr::memory_resource const& other
+) const noexcept -> bool {
+    return this == &other;
+}
+
+QueryContext::QueryContext(std::size_t capacity, std::pmr::memory_resource* upstream)
+    : m_overflow(upstream) {
+    allocate_arena(capacity);
+}
+
+QueryContext::QueryContext(QueryContext const& other)
+    : QueryContext(other.m_capacity, other.m_overflow.upstream()) {
+    m_budget = other.m_budget;
+}
+
+QueryContext& QueryContext::operator=(QueryContext const& other) {
+    if (this != &other) {
+        allocate_arena(other.m_capacity);
+        m_budget = other.m_budget;
+    }
+    return *this;
+}
+
+QueryContext::~QueryContext() {
+    release_arena();
+}
+
+void QueryContext::release_arena() {
+    m_arena.reset();
+    if (m_buffer != nullptr) {
+        m_overflow.upstream()->deallocate(m_buffer, m_capacity, arena_alignment);
+        m_buffer = nullptr;
+    }
+}
+
+void QueryContext::allocate_arena(std::size_t capacity) {
+    release_arena();
+    m_capacity = capacity;
+    m_overflow.clear();
+    if (m_capacity > 0) {
+        m_buffer = static_cast<std::byte*>(
+            m_overflow.upstream()->allocate(m_capacity, arena_alignment)
+        );
+        m_arena.emplace(m_buffer, m_capacity, &m_overflow);
+    } else {
+        m_arena.emplace(&m_overflow);
+    }
+}
+
+auto QueryContext::resource() noexcept -> std::pmr::memory_resource* {
+    return &*m_arena;
+}
+
+void QueryContext::reset() {
+    if (m_overflow.allocated() > 0) {
+        allocate_arena(m_capacity + m_overflow.allocated());
+    } else {
+        m_arena->release();
+    }
+    m_budget.start();
+}
+
+auto QueryContext::capacity() const noexcept -> std::size_t {
+    return m_capacity;
+}
+
+auto QueryContext::topk(std::size_t k, Score initial_threshold) -> topk_queue& {
+    m_topk.reset(k, initial_threshold);
+    return m_topk;
+}
+
+auto QueryContext::budget() noexcept -> QueryBudget& {
+    return m_budget;
+}
+
+void QueryContext::set_budget(QueryBudget budget) {
+    m_budget = budget;
+    m_budget.start();
+}
+
+}  // namespace pisa
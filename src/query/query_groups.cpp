@@ -0,0 +1,99 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "query/query_groups.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace pisa {
+
+namespace {
+
+    [[nodiscard]] auto distinct_terms(Query const& query) -> std::vector<TermId> {
+        std::vector<TermId> terms;
+        terms.reserve(query.terms().size());
+        for (auto const& term: query.terms()) {
+            terms.push_back(term.id);
+        }
+        std::sort(terms.begin(), terms.end());
+        terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+        return terms;
+    }
+
+}  // namespace
+
+auto group_queries_by_terms(std::span<Query const> queries, std::size_t max_group_size)
+    -> std::vector<std::vector<std::size_t>> {
+    if (max_group_size == 0) {
+        throw std::invalid_argument("maximum query group size must be positive");
+    }
+
+    std::vector<std::vector<TermId>> query_terms;
+    query_terms.reserve(queries.size());
+    std::unordered_map<TermId, std::vector<std::size_t>> term_queries;
+    for (std::size_t query = 0; query < queries.size(); ++query) {
+        query_terms.push_back(distinct_terms(queries[query]));
+        for (auto term: query_terms.back()) {
+            term_queries[term].push_back(query);
+        }
+    }
+
+    std::vector<bool> grouped(queries.size(), false);
+    std::vector<std::size_t> overlaps(queries.size(), 0);
+    std::vector<std::size_t> candidates;
+    std::vector<std::vector<std::size_t>> groups;
+    for (std::size_t seed = 0; seed < queries.size(); ++seed) {
+        if (grouped[seed]) {
+            continue;
+        }
+        grouped[seed] = true;
+        std::vector<std::size_t> group{seed};
+
+        candidates.clear();
+        for (auto term: query_terms[seed]) {
+            auto& sharing = term_queries[term];
+            // Grouped queries are dropped, so that each is skipped at most once per term.
+            std::erase_if(sharing, [&](auto query) { return grouped[query]; });
+            for (auto query: sharing) {
+                if (overlaps[query]++ == 0) {
+                    candidates.push_back(query);
+                }
+            }
+        }
+        auto by_overlap = [&](auto lhs, auto rhs) {
+            return overlaps[lhs] > overlaps[rhs] || (overlaps[lhs] == overlaps[rhs] && lhs < rhs);
+        };
+        auto count = std::min(candidates.size(), max_group_size - 1);
+        std::partial_sort(
+            candidates.begin(),
+            std::next(candidates.begin(), static_cast<std::ptrdiff_t>(count)),
+            candidates.end(),
+            by_overlap
+        );
+        for (std::size_t pos = 0; pos < count; ++pos) {
+            grouped[candidates[pos]] = true;
+            group.push_back(candidates[pos]);
+        }
+        for (auto query: candidates) {
+            overlaps[query] = 0;
+        }
+        std::sort(group.begin(), group.end());
+        groups.push_back(std::move(group));
+    }
+    return groups;
+}
+
+}  // namespace pisa
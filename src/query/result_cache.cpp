@@ -0,0 +1,212 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "query/result_cache.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace pisa {
+
+namespace {
+
+    void hash_combine(std::size_t& seed, std::size_t value) noexcept {
+        seed ^= value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2);
+    }
+
+    /** Approximate overhead of a hash map node and an eviction order node. */
+    constexpr std::size_t node_overhead = 96;
+
+    [[nodiscard]] auto entry_bytes(ResultCacheKey const& key, std::size_t result_count)
+        -> std::size_t {
+        return node_overhead + sizeof(ResultCacheKey) + key.terms.size() * sizeof(WeightedTerm)
+            + key.algorithm.size() + key.scorer.size()
+            + result_count * sizeof(topk_queue::entry_type);
+    }
+
+}  // namespace
+
+auto ResultCacheKey::from(Query const& query, std::string algorithm, std::string scorer)
+    -> ResultCacheKey {
+    std::vector<WeightedTerm> terms = query.terms();
+    std::sort(terms.begin(), terms.end(), [](auto const& lhs, auto const& rhs) {
+        return lhs.id < rhs.id;
+    });
+    auto out = terms.begin();
+    for (auto it = terms.begin(); it != terms.end(); ++it) {
+        if (out != terms.begin() && std::prev(out)->id == it->id) {
+            std::prev(out)->weight += it->weight;
+        } else {
+            *out++ = *it;
+        }
+    }
+    terms.erase(out, terms.end());
+    return ResultCacheKey{std::move(terms), std::move(algorithm), std::move(scorer)};
+}
+
+auto ResultCacheKey::hash() const noexcept -> std::size_t {
+    std::size_t seed = std::hash<std::string>{}(algorithm);
+    hash_combine(seed, std::hash<std::string>{}(scorer));
+    for (auto const& term: terms) {
+        hash_combine(seed, std::hash<std::uint32_t>{}(term.id));
+        hash_combine(seed, std::hash<Score>{}(term.weight));
+    }
+    return seed;
+}
+
+auto operator==(ResultCacheKey const& lhs, ResultCacheKey const& rhs) noexcept -> bool {
+    return lhs.terms == rhs.terms && lhs.algorithm == rhs.algorithm && lhs.scorer == rhs.scorer;
+}
+
+auto parse_cache_policy(std::string_view name) -> CachePolicy {
+    if (name == "lru") {
+        return CachePolicy::LRU;
+    }
+    if (name == "lfu") {
+        return CachePolicy::LFU;
+    }
+    throw std::invalid_argument(fmt::format("Unknown cache policy: {}", name));
+}
+
+ResultCache::ResultCache(std::size_t capacity_bytes, CachePolicy policy, std::size_t shards)
+    : m_shard_capacity(capacity_bytes / std::max<std::size_t>(shards, 1)), m_policy(policy) {
+    m_shards.reserve(std::max<std::size_t>(shards, 1));
+    for (std::size_t idx = 0; idx < std::max<std::size_t>(shards, 1); ++idx) {
+        m_shards.push_back(std::make_unique<Shard>());
+    }
+}
+
+auto ResultCache::shard(ResultCacheKey const& key) -> Shard& {
+    return *m_shards[key.hash() % m_shards.size()];
+}
+
+auto ResultCache::rank(Shard& shard, Entry const& entry) const -> Rank {
+    auto primary = m_policy == CachePolicy::LFU ? entry.frequency : 0;
+    return {primary, shard.tick++};
+}
+
+void ResultCache::touch(Shard& shard, ResultCacheKey const& key, Entry& entry) {
+    shard.eviction_order.erase(entry.rank);
+    entry.frequency += 1;
+    entry.rank = rank(shard, entry);
+    shard.eviction_order.emplace(entry.rank, &key);
+}
+
+void ResultCache::evict(Shard& shard, std::size_t budget) {
+    while (shard.bytes > budget && !shard.eviction_order.empty()) {
+        auto victim = shard.eviction_order.begin();
+        auto pos = shard.entries.find(*victim->second);
+        shard.bytes -= pos->second.bytes;
+        shard.eviction_order.erase(victim);
+        shard.entries.erase(pos);
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+auto ResultCache::find(ResultCacheKey const& key, std::size_t k)
+    -> std::optional<std::vector<entry_type>> {
+    auto& shard = this->shard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (auto pos = shard.entries.find(key); pos != shard.entries.end() && pos->second.k >= k) {
+        touch(shard, pos->first, pos->second);
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        auto const& results = pos->second.results;
+        return std::vector<entry_type>(
+            results.begin(), std::next(results.begin(), std::min(k, results.size()))
+        );
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+void ResultCache::insert(ResultCacheKey key, std::size_t k, std::vector<entry_type> results) {
+    auto bytes = entry_bytes(key, results.size());
+    if (bytes > m_shard_capacity) {
+        return;
+    }
+    auto& shard = this->shard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (auto pos = shard.entries.find(key); pos != shard.entries.end()) {
+        if (pos->second.k >= k) {
+            return;
+        }
+        shard.bytes -= pos->second.bytes;
+        shard.eviction_order.erase(pos->second.rank);
+        shard.entries.erase(pos);
+    }
+    evict(shard, m_shard_capacity - bytes);
+    auto [pos, inserted] =
+        shard.entries.emplace(std::move(key), Entry{k, std::move(results), bytes, 1, {}});
+    pos->second.rank = rank(shard, pos->second);
+    shard.eviction_order.emplace(pos->second.rank, &pos->first);
+    shard.bytes += bytes;
+    m_insertions.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ResultCache::clear() {
+    for (auto& shard: m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->eviction_order.clear();
+        shard->entries.clear();
+        shard->bytes = 0;
+    }
+}
+
+auto ResultCache::stats() const -> ResultCacheStats {
+    ResultCacheStats stats{
+        m_hits.load(std::memory_order_relaxed),
+        m_misses.load(std::memory_order_relaxed),
+        m_insertions.load(std::memory_order_relaxed),
+        m_evictions.load(std::memory_order_relaxed),
+    };
+    for (auto const& shard: m_shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.entries += shard->entries.size();
+        stats.bytes += shard->bytes;
+    }
+    return stats;
+}
+
+auto make_cached_query_processor(
+    QueryProcessor process, ResultCache& cache, std::string algorithm, std::string scorer
+) -> QueryProcessor {
+    return [process = std::move(process),
+            &cache,
+            algorithm = std::move(algorithm),
+            scorer = std::move(scorer)](Query const& query, topk_queue& topk) {
+        if (topk.initial_threshold() != 0.0F) {
+            process(query, topk);
+            return;
+        }
+        auto key = ResultCacheKey::from(query, algorithm, scorer);
+        if (auto results = cache.find(key, topk.capacity()); results) {
+            for (auto const& [score, docid]: *results) {
+                topk.insert(score, docid);
+            }
+            return;
+        }
+        process(query, topk);
+        if (!topk.is_complete()) {
+            return;
+        }
+        topk_queue finalized = topk;
+        finalized.finalize();
+        cache.insert(std::move(key), topk.capacity(), finalized.topk());
+    };
+}
+
+}  // namespace pisa
@@ -0,0 +1,198 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "threshold_store.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "span.hpp"
+
+namespace pisa {
+
+namespace {
+
+    constexpr std::uint32_t MAGIC = 0x50545331;  // "PTS1"
+    constexpr std::uint32_t VERSION = 1;
+
+    static_assert(sizeof(ts::PairEntry) == 12);
+    static_assert(sizeof(ts::TripleEntry) == 16);
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t k;
+        std::uint32_t reserved;
+        std::uint64_t num_terms;
+        std::uint64_t num_pairs;
+        std::uint64_t num_triples;
+    };
+
+    template <typename T>
+    [[nodiscard]] auto cast_span(std::span<char const> bytes, std::size_t offset, std::size_t count)
+        -> std::span<T const> {
+        auto sub = pisa::subspan_or_throw(
+            bytes, offset, count * sizeof(T), "threshold store is truncated"
+        );
+        return std::span<T const>(reinterpret_cast<T const*>(sub.data()), count);
+    }
+
+    template <std::size_t N>
+    [[nodiscard]] auto
+    find_score(std::span<ts::Entry<N> const> entries, std::array<TermId, N> terms) -> Score {
+        std::sort(terms.begin(), terms.end());
+        auto pos = std::lower_bound(
+            entries.begin(),
+            entries.end(),
+            terms,
+            [](auto const& entry, auto const& terms) { return entry.terms < terms; }
+        );
+        if (pos != entries.end() && pos->terms == terms) {
+            return pos->score;
+        }
+        return 0.0;
+    }
+
+    template <typename T>
+    void write(std::ostream& out, T const* data, std::size_t count) {
+        out.write(reinterpret_cast<char const*>(data), count * sizeof(T));
+    }
+
+}  // namespace
+
+ThresholdStore::ThresholdStore(MemorySource source) : m_source(std::move(source)) {
+    auto bytes = m_source.span();
+    if (bytes.size() < sizeof(Header)) {
+        throw std::invalid_argument("threshold store is truncated");
+    }
+    Header header{};
+    std::memcpy(&header, bytes.data(), sizeof(Header));
+    if (header.magic != MAGIC) {
+        throw std::invalid_argument("not a threshold store");
+    }
+    if (header.version != VERSION) {
+        throw std::invalid_argument(
+            fmt::format("unsupported threshold store version: {}", header.version)
+        );
+    }
+    m_k = header.k;
+    std::size_t offset = sizeof(Header);
+    m_terms = cast_span<Score>(bytes, offset, header.num_terms);
+    offset += m_terms.size_bytes();
+    m_pairs = cast_span<ts::PairEntry>(bytes, offset, header.num_pairs);
+    offset += m_pairs.size_bytes();
+    m_triples = cast_span<ts::TripleEntry>(bytes, offset, header.num_triples);
+}
+
+auto ThresholdStore::k() const noexcept -> std::size_t {
+    return m_k;
+}
+
+auto ThresholdStore::term(TermId term) const noexcept -> Score {
+    return term < m_terms.size() ? m_terms[term] : 0.0F;
+}
+
+auto ThresholdStore::pair(TermId first, TermId second) const noexcept -> Score {
+    return find_score(m_pairs, {first, second});
+}
+
+auto ThresholdStore::triple(TermId first, TermId second, TermId third) const noexcept -> Score {
+    return find_score(m_triples, {first, second, third});
+}
+
+auto ThresholdStore::threshold(Query const& query, std::size_t k, bool conjunctive) const
+    -> Score {
+    if (conjunctive || k > m_k) {
+        return 0.0;
+    }
+    std::vector<TermId> terms;
+    for (auto const& term: query.terms()) {
+        // the stored scores assume unit weights, and may exceed the scores of down-weighted terms
+        if (term.weight < 1.0) {
+            return 0.0;
+        }
+        terms.push_back(term.id);
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    Score threshold = 0.0;
+    for (auto term: terms) {
+        threshold = std::max(threshold, this->term(term));
+    }
+    if (!m_pairs.empty()) {
+        for (std::size_t i = 0; i < terms.size(); ++i) {
+            for (std::size_t j = i + 1; j < terms.size(); ++j) {
+                threshold = std::max(threshold, pair(terms[i], terms[j]));
+            }
+        }
+    }
+    if (!m_triples.empty()) {
+        for (std::size_t i = 0; i < terms.size(); ++i) {
+            for (std::size_t j = i + 1; j < terms.size(); ++j) {
+                for (std::size_t s = j + 1; s < terms.size(); ++s) {
+                    threshold = std::max(threshold, triple(terms[i], terms[j], terms[s]));
+                }
+            }
+        }
+    }
+    return threshold;
+}
+
+ThresholdStoreBuilder::ThresholdStoreBuilder(std::size_t k, std::size_t num_terms)
+    : m_k(k), m_terms(num_terms, 0.0) {}
+
+void ThresholdStoreBuilder::term(TermId term, Score score) {
+    m_terms.at(term) = score;
+}
+
+void ThresholdStoreBuilder::pair(TermId first, TermId second, Score score) {
+    ts::PairEntry entry{{first, second}, score};
+    std::sort(entry.terms.begin(), entry.terms.end());
+    m_pairs.push_back(entry);
+}
+
+void ThresholdStoreBuilder::triple(TermId first, TermId second, TermId third, Score score) {
+    ts::TripleEntry entry{{first, second, third}, score};
+    std::sort(entry.terms.begin(), entry.terms.end());
+    m_triples.push_back(entry);
+}
+
+void ThresholdStoreBuilder::encode(std::ostream& out) {
+    auto by_terms = [](auto const& lhs, auto const& rhs) { return lhs.terms < rhs.terms; };
+    auto same_terms = [](auto const& lhs, auto const& rhs) { return lhs.terms == rhs.terms; };
+    std::sort(m_pairs.begin(), m_pairs.end(), by_terms);
+    m_pairs.erase(std::unique(m_pairs.begin(), m_pairs.end(), same_terms), m_pairs.end());
+    std::sort(m_triples.begin(), m_triples.end(), by_terms);
+    m_triples.erase(std::unique(m_triples.begin(), m_triples.end(), same_terms), m_triples.end());
+
+    Header header{
+        MAGIC,
+        VERSION,
+        static_cast<std::uint32_t>(m_k),
+        0,
+        m_terms.size(),
+        m_pairs.size(),
+        m_triples.size(),
+    };
+    write(out, &header, 1);
+    write(out, m_terms.data(), m_terms.size());
+    write(out, m_pairs.data(), m_pairs.size());
+    write(out, m_triples.data(), m_triples.size());
+}
+
+}  // namespace pisa
@@ -1,6 +1,7 @@
 #!/usr/bin/env bash
 
 ENCODINGS=(
+    block_adaptive
     block_interpolative
     block_maskedvbyte
     block_optpfor
@@ -3,13 +3,19 @@
 #define CATCH_CONFIG_MAIN
 #include "catch2/catch.hpp"
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
+#include <limits>
 #include <rapidcheck.h>
 #include <type_traits>
 #include <vector>
 
+#include "codec/adaptive.hpp"
 #include "codec/block_codec.hpp"
+#include "codec/optpfor.hpp"
+#include "codec/simdbp.hpp"
+#include "codec/streamvbyte.hpp"
 
 using namespace rc;
 
@@ -53,6 +59,7 @@ void test_block_codec(pisa::BlockCodec const* codec) {
 
 TEST_CASE("Example test case", "[codec]") {
     auto codec_name = GENERATE(
+        "block_adaptive",
         "block_optpfor",
         "block_varintg8iu",
         "block_streamvbyte",
@@ -79,6 +86,7 @@ TEST_CASE("Example test case", "[codec]") {
 
 TEST_CASE("Property test", "[codec]") {
     auto codec_name = GENERATE(
+        "block_adaptive",
         "block_optpfor",
         "block_varintg8iu",
         "block_streamvbyte",
@@ -95,3 +103,50 @@ TEST_CASE("Property test", "[codec]") {
     std::size_t use_sum_of_values = GENERATE(true, false);
     test_block_codec(codec.get());
 }
+
+TEST_CASE("Adaptive block codec", "[codec]") {
+    using Encoding = pisa::AdaptiveBlockCodec::Encoding;
+    pisa::AdaptiveBlockCodec codec;
+    std::size_t n = GENERATE(2, 100, 128);
+    CAPTURE(n);
+
+    SECTION("Constant block") {
+        std::uint32_t value = GENERATE(0, 1000);
+        std::vector<std::uint32_t> values(n, value);
+        std::vector<std::uint8_t> encoded;
+        codec.encode(values.data(), std::uint32_t(-1), n, encoded);
+        REQUIRE(pisa::AdaptiveBlockCodec::encoding(encoded.data()) == Encoding::Constant);
+        REQUIRE(encoded.size() == (value < 128 ? 2 : 3));
+        test_case(&codec, values, false);
+    }
+
+    SECTION("Smallest encoding") {
+        std::vector<std::uint32_t> values(n);
+        std::generate(values.begin(), values.end(), [] { return rand() % 100 + 1; });
+        values.back() = 1U << 20;
+        pisa::SimdBpBlockCodec simdbp;
+        pisa::StreamVByteBlockCodec streamvbyte;
+        pisa::OptPForBlockCodec optpfor;
+        std::size_t min_size = std::numeric_limits<std::size_t>::max();
+        for (pisa::BlockCodec const* candidate:
+             std::array<pisa::BlockCodec const*, 3>{&simdbp, &streamvbyte, &optpfor}) {
+            std::vector<std::uint8_t> encoded;
+            candidate->encode(values.data(), std::uint32_t(-1), n, encoded);
+            min_size = std::min(min_size, encoded.size());
+        }
+        std::vector<std::uint8_t> encoded;
+        codec.encode(values.data(), std::uint32_t(-1), n, encoded);
+        REQUIRE(pisa::AdaptiveBlockCodec::encoding(encoded.data()) != Encoding::Constant);
+        REQUIRE(encoded.size() == min_size + 1);
+        test_case(&codec, values, false);
+
+        // With enough slack, the fastest encoding is chosen.
+        pisa::AdaptiveBlockCodec fast_codec(1000.0);
+        encoded.clear();
+        fast_codec.encode(values.data(), std::uint32_t(-1), n, encoded);
+        REQUIRE(pisa::AdaptiveBlockCodec::encoding(encoded.data()) == Encoding::SimdBp);
+        test_case(&fast_codec, values, false);
+    }
+
+    REQUIRE_THROWS_AS(pisa::AdaptiveBlockCodec(-0.5), std::invalid_argument);
+}
@@ -2,14 +2,21 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <memory>
+#include <sstream>
 #include <vector>
 
 #include <catch2/catch.hpp>
 
 #include "block_inverted_index.hpp"
 #include "codec/block_codec_registry.hpp"
+#include "cursor/scored_cursor.hpp"
+#include "hybrid_block_inverted_index.hpp"
+#include "query/algorithm/and_query.hpp"
+#include "query/algorithm/ranked_and_query.hpp"
 #include "temporary_directory.hpp"
 #include "test_generic_sequence.hpp"
+#include "topk_queue.hpp"
 
 template <typename Accumulator>
 void test_block_posting_accumulator(std::string const& codec_name) {
@@ -60,6 +67,7 @@ TEMPLATE_TEST_CASE(
     pisa::index::block::InMemoryPostingAccumulator,
     pisa::index::block::StreamPostingAccumulator
 ) {
+    test_block_posting_accumulator<TestType>("block_adaptive");
     test_block_posting_accumulator<TestType>("block_optpfor");
     test_block_posting_accumulator<TestType>("block_varintg8iu");
     test_block_posting_accumulator<TestType>("block_streamvbyte");
@@ -71,3 +79,188 @@ TEMPLATE_TEST_CASE(
     test_block_posting_accumulator<TestType>("block_simple16");
     test_block_posting_accumulator<TestType>("block_simdbp");
 }
+
+TEMPLATE_TEST_CASE(
+    "hybrid block posting accumulator",
+    "[block][accumulator][hybrid]",
+    pisa::index::block::InMemoryPostingAccumulator,
+    pisa::index::block::StreamPostingAccumulator
+) {
+    using pisa::index::block::HybridCodecSelector;
+    pisa::TemporaryDirectory tmpdir;
+    uint64_t universe = 20000;
+    std::size_t num_docs = universe;
+    auto output_filename = (tmpdir.path() / "temp.bin").string();
+
+    // Every other term is queried, and decoding time weighs a lot for the queried terms.
+    std::size_t num_terms = 20;
+    std::vector<std::uint64_t> term_frequencies;
+    for (std::size_t term = 0; term < num_terms; term += 2) {
+        term_frequencies.push_back(0);
+        term_frequencies.push_back(1'000'000);
+    }
+    auto selector = std::make_shared<HybridCodecSelector const>(1.0, term_frequencies);
+    auto codecs = pisa::index::block::hybrid_codecs();
+
+    TestType accumulator(codecs.front(), num_docs, output_filename);
+    accumulator.select_codecs(selector);
+    using vec_type = std::vector<std::uint32_t>;
+    std::vector<std::pair<vec_type, vec_type>> posting_lists(num_terms);
+    for (auto& plist: posting_lists) {
+        double avg_gap = 1.1 + double(rand()) / RAND_MAX * 100;
+        auto n = std::uint64_t(universe / avg_gap);
+        plist.first = random_sequence<std::uint32_t>(universe, n, true);
+        plist.second.resize(n);
+        std::generate(plist.second.begin(), plist.second.end(), []() {
+            return (rand() % 256) + 1;
+        });
+        accumulator.accumulate_posting_list(n, &plist.first[0], &plist.second[0]);
+    }
+    accumulator.finish();
+
+    pisa::HybridBlockInvertedIndex index(pisa::MemorySource::mapped_file(output_filename));
+    REQUIRE(index.size() == num_terms);
+    for (size_t i = 0; i < posting_lists.size(); ++i) {
+        auto const& [docs, freqs] = posting_lists[i];
+        auto n = static_cast<std::uint32_t>(docs.size());
+
+        // Unqueried lists take the least space, queried lists are the fastest to decode.
+        std::vector<std::size_t> sizes;
+        std::vector<double> times;
+        for (std::uint32_t tag = 0; tag < codecs.size(); ++tag) {
+            std::vector<std::uint8_t> data;
+            pisa::index::block::write_posting_list(
+                codecs[tag].get(), data, n, docs.data(), freqs.data(), false, tag
+            );
+            sizes.push_back(data.size());
+            times.push_back(selector->decoding_time(tag, n, docs.data(), freqs.data()));
+        }
+        auto best = i % 2 == 0 ? std::min_element(sizes.begin(), sizes.end()) - sizes.begin()
+                               : std::min_element(times.begin(), times.end()) - times.begin();
+        REQUIRE(index.codec_tag(i) == best);
+
+        auto doc_enum = index[i];
+        REQUIRE(docs.size() == doc_enum.size());
+        for (size_t p = 0; p < docs.size(); ++p, doc_enum.next()) {
+            MY_REQUIRE_EQUAL(docs[p], doc_enum.docid(), "i = " << i << " p = " << p);
+            MY_REQUIRE_EQUAL(freqs[p], doc_enum.freq(), "i = " << i << " p = " << p);
+        }
+        REQUIRE(index.num_docs() == doc_enum.docid());
+    }
+}
+
+TEST_CASE("hybrid codec selector input", "[block][hybrid]") {
+    using pisa::index::block::HybridCodecSelector;
+
+    std::istringstream frequencies("3\n0\n12\n");
+    REQUIRE(
+        HybridCodecSelector::read_term_frequencies(frequencies)
+        == std::vector<std::uint64_t>{3, 0, 12}
+    );
+
+    HybridCodecSelector selector;
+    std::vector<std::uint32_t> docs{1, 5, 6, 100};
+    std::vector<std::uint32_t> freqs{1, 1, 2, 1};
+    std::istringstream predictors("block_varintgb bias 1.5\nblock_varintgb n 2\n");
+    HybridCodecSelector::read_predictors(predictors, selector);
+    // One block of document gaps and one of frequencies.
+    REQUIRE(selector.decoding_time(3, 4, docs.data(), freqs.data()) == 2 * (1.5 + 2 * 4));
+
+    std::istringstream unknown_codec("block_qmx bias 1.0\n");
+    REQUIRE_THROWS_AS(
+        HybridCodecSelector::read_predictors(unknown_codec, selector), std::invalid_argument
+    );
+    std::istringstream unknown_feature("block_simdbp speed 1.0\n");
+    REQUIRE_THROWS_AS(
+        HybridCodecSelector::read_predictors(unknown_feature, selector), std::invalid_argument
+    );
+    std::istringstream missing_weight("block_simdbp n\n");
+    REQUIRE_THROWS_AS(
+        HybridCodecSelector::read_predictors(missing_weight, selector), std::invalid_argument
+    );
+}
+
+TEMPLATE_TEST_CASE(
+    "dense block posting accumulator",
+    "[block][accumulator][dense]",
+    pisa::index::block::InMemoryPostingAccumulator,
+    pisa::index::block::StreamPostingAccumulator
+) {
+    pisa::TemporaryDirectory tmpdir;
+    std::uint64_t universe = 20000;
+    auto block_codec = pisa::get_block_codec("block_simdbp");
+    auto dense_filename = (tmpdir.path() / "dense.bin").string();
+    auto sparse_filename = (tmpdir.path() / "sparse.bin").string();
+
+    // Lists with at least a quarter of the documents are dense.
+    TestType dense_accumulator(block_codec, universe, dense_filename);
+    dense_accumulator.dense_cutoff(0.25);
+    TestType sparse_accumulator(block_codec, universe, sparse_filename);
+    std::vector<std::uint64_t> sizes;
+    for (double avg_gap: {1.2, 1.5, 3.0, 10.0, 100.0, 1.1}) {
+        auto n = std::uint64_t(universe / avg_gap);
+        auto docs = random_sequence<std::uint32_t>(universe, n, true);
+        std::vector<std::uint32_t> freqs(n);
+        std::generate(freqs.begin(), freqs.end(), []() { return (rand() % 256) + 1; });
+        dense_accumulator.accumulate_posting_list(n, docs.data(), freqs.data());
+        sparse_accumulator.accumulate_posting_list(n, docs.data(), freqs.data());
+        sizes.push_back(n);
+    }
+    dense_accumulator.finish();
+    sparse_accumulator.finish();
+
+    pisa::BlockInvertedIndex dense(pisa::MemorySource::mapped_file(dense_filename), block_codec);
+    pisa::BlockInvertedIndex sparse(pisa::MemorySource::mapped_file(sparse_filename), block_codec);
+    for (std::size_t term = 0; term < sizes.size(); ++term) {
+        REQUIRE(dense[term].docid_bitmap().empty() == (sizes[term] < universe / 4));
+        REQUIRE(sparse[term].docid_bitmap().empty());
+    }
+
+    auto make_cursors = [](pisa::BlockInvertedIndex const& index, std::vector<std::size_t> terms) {
+        std::vector<pisa::BlockInvertedIndexCursor<>> cursors;
+        for (auto term: terms) {
+            cursors.push_back(index[term]);
+        }
+        return cursors;
+    };
+    auto make_scored_cursors = [&](pisa::BlockInvertedIndex const& index,
+                                   std::vector<std::size_t> terms) {
+        std::vector<pisa::ScoredCursor<pisa::BlockInvertedIndexCursor<>>> cursors;
+        for (auto& cursor: make_cursors(index, terms)) {
+            cursors.emplace_back(
+                std::move(cursor),
+                [](std::uint32_t docid, std::uint32_t freq) {
+                    return static_cast<float>(freq) + static_cast<float>(docid % 7);
+                },
+                1.0
+            );
+        }
+        return cursors;
+    };
+    auto terms = GENERATE(
+        std::vector<std::size_t>{0},
+        std::vector<std::size_t>{0, 1},
+        std::vector<std::size_t>{0, 1, 5},
+        std::vector<std::size_t>{0, 2},
+        std::vector<std::size_t>{1, 3, 4},
+        std::vector<std::size_t>{3, 4}
+    );
+    auto max_docid = GENERATE(std::uint32_t{20000}, std::uint32_t{10000});
+    CAPTURE(terms);
+    CAPTURE(max_docid);
+
+    REQUIRE(
+        pisa::and_query{}(make_cursors(dense, terms), max_docid)
+        == pisa::and_query{}(make_cursors(sparse, terms), max_docid)
+    );
+
+    pisa::topk_queue dense_topk(100);
+    pisa::ranked_and_query dense_query(dense_topk);
+    dense_query(make_scored_cursors(dense, terms), max_docid);
+    dense_topk.finalize();
+    pisa::topk_queue sparse_topk(100);
+    pisa::ranked_and_query sparse_query(sparse_topk);
+    sparse_query(make_scored_cursors(sparse, terms), max_docid);
+    sparse_topk.finalize();
+    REQUIRE(dense_topk.topk() == sparse_topk.topk());
+}
@@ -6,21 +6,28 @@
 #include "test_generic_sequence.hpp"
 
 #include "block_inverted_index.hpp"
+#include "codec/adaptive.hpp"
+#include "codec/optpfor.hpp"
+#include "codec/simdbp.hpp"
+#include "codec/streamvbyte.hpp"
 
 #include <algorithm>
 #include <cstdlib>
+#include <optional>
 #include <random>
+#include <stdexcept>
 #include <vector>
 
+template <typename Codec>
 void test_block_posting_list_ops(
-    pisa::BlockCodec const* codec,
+    Codec const* codec,
     uint8_t const* data,
     uint64_t n,
     uint64_t universe,
     std::vector<std::uint32_t> const& docs,
     std::vector<std::uint32_t> const& freqs
 ) {
-    pisa::BlockInvertedIndexCursor<> cursor(codec, data, universe, 0);
+    pisa::BlockInvertedIndexCursor<pisa::Profiling::Off, Codec> cursor(codec, data, universe, 0);
     REQUIRE(n == cursor.size());
     for (size_t i = 0; i < n; ++i, cursor.next()) {
         MY_REQUIRE_EQUAL(docs[i], cursor.docid(), "i = " << i << " size = " << n);
@@ -33,12 +40,39 @@ void test_block_posting_list_ops(
         MY_REQUIRE_EQUAL(docs[i], cursor.docid(), "i = " << i << " size = " << n);
         MY_REQUIRE_EQUAL(freqs[i], cursor.freq(), "i = " << i << " size = " << n);
     }
+    for (std::uint64_t step: {std::uint64_t{7}, universe / 1000 + 1, universe / 10 + 1}) {
+        cursor.reset();
+        for (std::uint64_t lower_bound = 0; lower_bound < universe; lower_bound += step) {
+            cursor.next_geq(lower_bound);
+            auto pos = std::lower_bound(docs.begin(), docs.end(), lower_bound) - docs.begin();
+            auto expected = pos < n ? docs[pos] : universe;
+            MY_REQUIRE_EQUAL(expected, cursor.docid(), "lb = " << lower_bound << " size = " << n);
+        }
+    }
     cursor.reset();
     cursor.next_geq(docs.back() + 1);
     REQUIRE(universe == cursor.docid());
     cursor.reset();
     cursor.next_geq(universe);
     REQUIRE(universe == cursor.docid());
+
+    for (std::uint32_t max_docid: {docs[n / 2], std::uint32_t(universe)}) {
+        for (std::size_t buffer_size: {codec->block_size(), std::size_t{7}}) {
+            cursor.reset();
+            std::vector<std::uint32_t> block_docs(buffer_size);
+            std::vector<std::uint32_t> block_freqs(buffer_size);
+            std::size_t pos = 0;
+            while (auto size = cursor.read_block(block_docs, block_freqs, max_docid)) {
+                for (std::size_t i = 0; i < size; ++i, ++pos) {
+                    MY_REQUIRE_EQUAL(docs[pos], block_docs[i], "i = " << pos << " size = " << n);
+                    MY_REQUIRE_EQUAL(freqs[pos], block_freqs[i], "i = " << pos << " size = " << n);
+                }
+            }
+            auto expected = std::lower_bound(docs.begin(), docs.end(), max_docid) - docs.begin();
+            REQUIRE(pos == expected);
+            REQUIRE(cursor.docid() == (pos < n ? docs[pos] : universe));
+        }
+    }
 }
 
 void random_posting_data(
@@ -95,6 +129,7 @@ void test_block_posting_list_reordering(pisa::BlockCodecPtr codec) {
 
 TEST_CASE("block_posting_list") {
     auto codec_name = GENERATE(
+        "block_adaptive",
         "block_optpfor",
         "block_varintg8iu",
         "block_streamvbyte",
@@ -113,6 +148,7 @@ TEST_CASE("block_posting_list") {
 
 TEST_CASE("block_posting_list_reordering") {
     auto codec_name = GENERATE(
+        "block_adaptive",
         "block_optpfor",
         "block_varintg8iu",
         "block_streamvbyte",
@@ -128,3 +164,158 @@ TEST_CASE("block_posting_list_reordering") {
     auto codec = pisa::get_block_codec(codec_name);
     test_block_posting_list_reordering(codec);
 }
+
+TEST_CASE("block_posting_list with skip layer", "[block]") {
+    auto codec_name = GENERATE("block_optpfor", "block_simdbp", "block_streamvbyte");
+    CAPTURE(codec_name);
+    auto codec = pisa::get_block_codec(codec_name);
+    uint64_t universe = 2'000'000;
+    for (double avg_gap: {1.5, 20.0, 1000.0}) {
+        auto n = uint64_t(universe / avg_gap);
+
+        std::vector<std::uint32_t> docs, freqs;
+        random_posting_data(n, universe, docs, freqs);
+        std::vector<uint8_t> data;
+        pisa::index::block::write_posting_list(codec.get(), data, n, &docs[0], &freqs[0], true);
+
+        test_block_posting_list_ops(codec.get(), data.data(), n, universe, docs, freqs);
+    }
+}
+
+TEST_CASE("block_posting_list with codec tag", "[block]") {
+    auto codec = pisa::get_block_codec("block_simdbp");
+    bool skip_layer = GENERATE(false, true);
+    CAPTURE(skip_layer);
+    uint64_t universe = 200'000;
+    auto n = uint64_t(universe / 5.0);
+
+    std::vector<std::uint32_t> docs, freqs;
+    random_posting_data(n, universe, docs, freqs);
+    std::vector<uint8_t> data;
+    pisa::index::block::write_posting_list(
+        codec.get(), data, n, &docs[0], &freqs[0], skip_layer, 300
+    );
+
+    std::uint32_t size = 0;
+    std::uint32_t flags = 0;
+    std::uint32_t codec_tag = 0;
+    pisa::index::block::decode_posting_list_header(data.data(), size, flags, codec_tag);
+    REQUIRE(size == n);
+    REQUIRE(codec_tag == 300);
+    REQUIRE((flags & pisa::index::block::CODEC_TAG) != 0U);
+    REQUIRE(((flags & pisa::index::block::SKIP_LAYER) != 0U) == skip_layer);
+
+    test_block_posting_list_ops(codec.get(), data.data(), n, universe, docs, freqs);
+}
+
+TEST_CASE("block_posting_list with dense bitmap", "[block]") {
+    auto codec_name = GENERATE("block_simdbp", "block_varintgb", "block_interpolative");
+    bool skip_layer = GENERATE(false, true);
+    CAPTURE(codec_name);
+    CAPTURE(skip_layer);
+    auto codec = pisa::get_block_codec(codec_name);
+    uint64_t universe = 200'000;
+    for (double avg_gap: {1.1, 2.0, 30.0}) {
+        auto n = uint64_t(universe / avg_gap);
+
+        std::vector<std::uint32_t> docs, freqs;
+        random_posting_data(n, universe, docs, freqs);
+        std::vector<uint8_t> data;
+        pisa::index::block::write_posting_list(
+            codec.get(), data, n, &docs[0], &freqs[0], skip_layer, std::nullopt, true
+        );
+
+        std::uint32_t size = 0;
+        std::uint32_t flags = 0;
+        pisa::index::block::decode_posting_list_header(data.data(), size, flags);
+        REQUIRE(size == n);
+        REQUIRE((flags & pisa::index::block::DENSE) != 0U);
+
+        pisa::BlockInvertedIndexCursor<> cursor(codec.get(), data.data(), universe, 0);
+        auto bitmap = cursor.docid_bitmap();
+        REQUIRE(bitmap.num_words() == docs.back() / 64 + 1);
+        for (std::uint32_t docid = 0, pos = 0; docid < 64 * bitmap.num_words(); ++docid) {
+            bool expected = pos < n && docs[pos] == docid;
+            MY_REQUIRE_EQUAL(expected, bitmap.contains(docid), "docid = " << docid);
+            pos += expected ? 1 : 0;
+        }
+        REQUIRE_THROWS_AS(cursor.get_blocks(), std::logic_error);
+
+        std::vector<uint8_t> sparse_data;
+        pisa::index::block::write_posting_list(
+            codec.get(), sparse_data, n, &docs[0], &freqs[0], skip_layer
+        );
+        pisa::BlockInvertedIndexCursor<> sparse(codec.get(), sparse_data.data(), universe, 0);
+        REQUIRE(sparse.docid_bitmap().empty());
+        REQUIRE(cursor.stats_freqs_size() == sparse.stats_freqs_size());
+
+        test_block_posting_list_ops(codec.get(), data.data(), n, universe, docs, freqs);
+    }
+}
+
+TEST_CASE("block_posting_list with block max scores", "[block]") {
+    auto codec = pisa::get_block_codec("block_simdbp");
+    bool skip_layer = GENERATE(false, true);
+    bool dense = GENERATE(false, true);
+    CAPTURE(skip_layer);
+    CAPTURE(dense);
+    uint64_t universe = 200'000;
+    for (double avg_gap: {1.5, 20.0, 1000.0}) {
+        auto n = uint64_t(universe / avg_gap);
+
+        std::vector<std::uint32_t> docs, freqs;
+        random_posting_data(n, universe, docs, freqs);
+        std::vector<float> scores(n);
+        std::generate(scores.begin(), scores.end(), []() { return float(rand()) / RAND_MAX * 20; });
+        std::vector<uint8_t> data;
+        pisa::index::block::write_posting_list(
+            codec.get(), data, n, &docs[0], &freqs[0], skip_layer, std::nullopt, dense, &scores[0]
+        );
+
+        pisa::BlockInvertedIndexCursor<> cursor(codec.get(), data.data(), universe, 0);
+        REQUIRE(cursor.has_block_max_scores());
+        REQUIRE(cursor.max_score() == *std::max_element(scores.begin(), scores.end()));
+        float step = pisa::index::block::block_max_score_step(cursor.max_score());
+        auto block_size = codec->block_size();
+        for (std::size_t begin = 0; begin < n; begin += block_size) {
+            auto end = std::min<std::size_t>(begin + block_size, n);
+            cursor.block_max_next_geq(docs[begin]);
+            REQUIRE(cursor.block_max_docid() == docs[end - 1]);
+            float block_max = *std::max_element(&scores[begin], &scores[end]);
+            REQUIRE(cursor.block_max_score() >= block_max);
+            REQUIRE(cursor.block_max_score() <= block_max + step);
+        }
+        // Past the end, it stays at the last block.
+        cursor.block_max_next_geq(universe);
+        REQUIRE(cursor.block_max_docid() == docs.back());
+
+        test_block_posting_list_ops(codec.get(), data.data(), n, universe, docs, freqs);
+    }
+}
+
+TEMPLATE_TEST_CASE(
+    "block_posting_list with static codec",
+    "[block]",
+    pisa::AdaptiveBlockCodec,
+    pisa::OptPForBlockCodec,
+    pisa::SimdBpBlockCodec,
+    pisa::StreamVByteBlockCodec
+) {
+    TestType codec;
+    uint64_t universe = 20000;
+    for (size_t t = 0; t < 20; ++t) {
+        double avg_gap = 1.1 + double(rand()) / RAND_MAX * 10;
+        auto n = uint64_t(universe / avg_gap);
+
+        std::vector<std::uint32_t> docs, freqs;
+        random_posting_data(n, universe, docs, freqs);
+        std::vector<uint8_t> data;
+
+        // Encoded with the dynamic codec, decoded with the static one.
+        pisa::index::block::write_posting_list(
+            pisa::get_block_codec(TestType::name).get(), data, n, &docs[0], &freqs[0]
+        );
+
+        test_block_posting_list_ops(&codec, data.data(), n, universe, docs, freqs);
+    }
+}
@@ -9,12 +9,16 @@
 #include <unordered_map>
 
 #include "binary_collection.hpp"
+#include "block_inverted_index.hpp"
+#include "codec/block_codec_registry.hpp"
 #include "cursor/block_max_scored_cursor.hpp"
 #include "cursor/max_scored_cursor.hpp"
 #include "index_types.hpp"
 #include "io.hpp"
 #include "pisa_config.hpp"
 #include "query/algorithm.hpp"
+#include "query/query_processor.hpp"
+#include "temporary_directory.hpp"
 #include "wand_data.hpp"
 #include "wand_data_compressed.hpp"
 #include "wand_data_raw.hpp"
@@ -144,3 +148,96 @@ TEST_CASE("block_max_wand", "[bmw][query][ranked][integration]", ) {
         }
     }
 }
+
+TEST_CASE("block_max_wand with embedded block max scores", "[bmw][query][ranked][integration]") {
+    auto s_name = GENERATE("bm25", "qld");
+    auto algorithm = GENERATE("block_max_wand", "block_max_maxscore", "block_max_ranked_and");
+    CAPTURE(s_name);
+    CAPTURE(algorithm);
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get(s_name, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams(s_name), data->wdata);
+
+    pisa::TemporaryDirectory tmpdir;
+    auto index_path = (tmpdir.path() / "index").string();
+    auto codec = get_block_codec("block_simdbp");
+    BlockIndexBuilder builder(codec, ScorerParams(s_name));
+    builder.block_max_scores(data->wdata).skip_layer(true);
+    builder.build(data->collection, index_path);
+    BlockInvertedIndex index(MemorySource::mapped_file(index_path), codec);
+    REQUIRE(index.has_block_max_scores());
+    REQUIRE(index.block_max_scorer() == scorer->fingerprint());
+
+    // The block max scores are upper bounds within one quantization step.
+    for (std::size_t term = 0; term < index.size(); ++term) {
+        auto cursor = index[term];
+        auto term_scorer = scorer->term_scorer(term);
+        float max_score = 0.0;
+        float step = index::block::block_max_score_step(cursor.max_score());
+        while (cursor.docid() < index.num_docs()) {
+            cursor.block_max_next_geq(cursor.docid());
+            float score = term_scorer(cursor.docid(), cursor.freq());
+            REQUIRE(cursor.block_max_score() >= score);
+            REQUIRE(cursor.block_max_docid() >= cursor.docid());
+            max_score = std::max(max_score, score);
+            cursor.next();
+        }
+        REQUIRE(cursor.max_score() == std::max(0.0F, max_score));
+        REQUIRE(step * 255.0F >= cursor.max_score());
+    }
+
+    auto processor = make_query_processor(algorithm, index, data->wdata, *scorer, false);
+    auto expected_processor =
+        make_query_processor(algorithm, data->index, data->wdata, *scorer, false);
+    for (auto const& q: data->queries) {
+        topk_queue topk(10);
+        processor(q, topk);
+        topk.finalize();
+        topk_queue expected(10);
+        expected_processor(q, expected);
+        expected.finalize();
+        REQUIRE(topk.topk().size() == expected.topk().size());
+        for (size_t i = 0; i < topk.topk().size(); ++i) {
+            REQUIRE(topk.topk()[i].first == Approx(expected.topk()[i].first).epsilon(0.01));
+        }
+    }
+}
+
+TEST_CASE(
+    "block_max_wand ignores embedded block max scores of another scorer",
+    "[bmw][query][ranked][integration]"
+) {
+    auto algorithm = GENERATE("block_max_wand", "block_max_maxscore", "block_max_ranked_and");
+    CAPTURE(algorithm);
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+    auto other_scorer = scorer::from_params(ScorerParams("qld"), data->wdata);
+
+    pisa::TemporaryDirectory tmpdir;
+    auto index_path = (tmpdir.path() / "index").string();
+    auto codec = get_block_codec("block_simdbp");
+    BlockIndexBuilder builder(codec, ScorerParams("qld"));
+    builder.block_max_scores(data->wdata).skip_layer(true);
+    builder.build(data->collection, index_path);
+    BlockInvertedIndex index(MemorySource::mapped_file(index_path), codec);
+    REQUIRE(index.has_block_max_scores());
+    REQUIRE(index.block_max_scorer() == other_scorer->fingerprint());
+    REQUIRE(index.block_max_scorer() != scorer->fingerprint());
+
+    auto processor = make_query_processor(algorithm, index, data->wdata, *scorer, false);
+    auto expected_processor =
+        make_query_processor(algorithm, data->index, data->wdata, *scorer, false);
+    for (auto const& q: data->queries) {
+        topk_queue topk(10);
+        processor(q, topk);
+        topk.finalize();
+        topk_queue expected(10);
+        expected_processor(q, expected);
+        expected.finalize();
+        REQUIRE(topk.topk().size() == expected.topk().size());
+        for (size_t i = 0; i < topk.topk().size(); ++i) {
+            REQUIRE(topk.topk()[i].first == Approx(expected.topk()[i].first).epsilon(0.01));
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <vector>
+
+#include "pisa/champion_lists.hpp"
+#include "pisa/memory_source.hpp"
+#include "pisa/query.hpp"
+#include "pisa/query/algorithm/champion_query.hpp"
+#include "pisa/topk_queue.hpp"
+
+using namespace pisa;
+
+auto encode(ChampionListsBuilder const& builder) -> MemorySource {
+    std::ostringstream out;
+    builder.encode(out);
+    auto bytes = out.str();
+    return MemorySource::from_vector(std::vector<char>(bytes.begin(), bytes.end()));
+}
+
+auto docids(std::span<ChampionEntry const> entries) -> std::vector<DocId> {
+    std::vector<DocId> docids;
+    for (auto const& entry: entries) {
+        docids.push_back(entry.docid);
+    }
+    return docids;
+}
+
+TEST_CASE("Champion lists", "[champion_lists]") {
+    ChampionListsBuilder builder(3, 4);
+    builder.term(0, {{1, 1.0}, {2, 5.0}, {4, 3.0}, {7, 3.0}, {9, 0.5}});
+    builder.term(1, {{3, 2.0}, {5, 0.0}});
+    builder.term(3, {{0, 4.0}, {8, 6.0}, {9, 1.0}});
+    REQUIRE_THROWS_AS(builder.term(4, {}), std::out_of_range);
+
+    ChampionLists lists(encode(builder));
+    REQUIRE(lists.depth() == 3);
+    REQUIRE(lists.size() == 4);
+    REQUIRE(docids(lists.champions(0)) == std::vector<DocId>{2, 4, 7});
+    REQUIRE(lists.champions(0)[0].score == 5.0);
+    REQUIRE(docids(lists.champions(1)) == std::vector<DocId>{3});
+    REQUIRE(lists.champions(2).empty());
+    REQUIRE(docids(lists.champions(3)) == std::vector<DocId>{8, 0, 9});
+    REQUIRE(lists.champions(4).empty());
+
+    REQUIRE(lists.covers(0, 3));
+    REQUIRE_FALSE(lists.covers(0, 4));
+    REQUIRE(lists.covers(1, 10));
+    REQUIRE(lists.covers(2, 10));
+    REQUIRE_FALSE(lists.covers(4, 1));
+}
+
+TEST_CASE("Champion query", "[champion_lists]") {
+    ChampionListsBuilder builder(3, 2);
+    builder.term(0, {{1, 1.0}, {2, 5.0}, {4, 3.0}, {7, 2.0}});
+    builder.term(1, {{3, 2.0}});
+    ChampionLists lists(encode(builder));
+
+    topk_queue topk(2);
+    REQUIRE(champion_query(lists, Query(std::nullopt, std::vector<TermId>{0}), topk));
+    topk.finalize();
+    REQUIRE(topk.topk() == std::vector<topk_queue::entry_type>{{5.0, 2}, {3.0, 4}});
+
+    topk_queue weighted(5);
+    Query query(std::nullopt, std::vector<TermId>{1}, std::vector<float>{2.0});
+    REQUIRE(champion_query(lists, query, weighted, true));
+    weighted.finalize();
+    REQUIRE(weighted.topk() == std::vector<topk_queue::entry_type>{{4.0, 3}});
+
+    topk_queue too_deep(4);
+    REQUIRE_FALSE(champion_query(lists, Query(std::nullopt, std::vector<TermId>{0}), too_deep));
+    REQUIRE_FALSE(champion_query(lists, Query(std::nullopt, std::vector<TermId>{0, 1}), topk));
+    REQUIRE(too_deep.size() == 0);
+}
+
+TEST_CASE("Invalid champion lists", "[champion_lists]") {
+    REQUIRE_THROWS_AS(
+        ChampionLists(MemorySource::from_vector(std::vector<char>(8, 0))), std::invalid_argument
+    );
+    REQUIRE_THROWS_AS(
+        ChampionLists(MemorySource::from_vector(std::vector<char>(64, 0))), std::invalid_argument
+    );
+    ChampionListsBuilder builder(10, 100);
+    auto source = encode(builder);
+    std::vector<char> truncated(source.data(), source.data() + source.size() - 1);
+    REQUIRE_THROWS_AS(
+        ChampionLists(MemorySource::from_vector(std::move(truncated))), std::out_of_range
+    );
+}
@@ -45,6 +45,7 @@ TEST_CASE("Compress index", "[index][compress]") {
         "single",
         "pefuniform",
         "pefopt",
+        "block_adaptive",
         "block_optpfor",
         "block_varintg8iu",
         "block_streamvbyte",
@@ -54,7 +55,8 @@ TEST_CASE("Compress index", "[index][compress]") {
         "block_qmx",
         "block_simple8b",
         "block_simple16",
-        "block_simdbp"
+        "block_simdbp",
+        "block_hybrid"
     );
     CAPTURE(encoding);
     bool in_memory = GENERATE(true, false);
@@ -98,6 +100,7 @@ TEST_CASE("Compress quantized index", "[index][compress]") {
         "single",
         "pefuniform",
         "pefopt",
+        "block_adaptive",
         "block_optpfor",
         "block_varintg8iu",
         "block_streamvbyte",
@@ -107,7 +110,8 @@ TEST_CASE("Compress quantized index", "[index][compress]") {
         "block_qmx",
         "block_simple8b",
         "block_simple16",
-        "block_simdbp"
+        "block_simdbp",
+        "block_hybrid"
     );
     CAPTURE(encoding);
     bool in_memory = GENERATE(true, false);
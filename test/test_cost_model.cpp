@@ -0,0 +1,110 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <span>
+#include <sstream>
+#include <vector>
+
+#include "pisa/query/cost_model.hpp"
+
+using namespace pisa;
+
+TEST_CASE("Query features", "[cost_model]") {
+    std::vector<std::uint32_t> sizes{100, 7, 1000};
+    std::vector<float> scores{1.0, 3.0, 4.0};
+    auto features = query_features(sizes, scores);
+    auto feature = [&](std::string_view name) {
+        auto pos = std::find(QueryFeatures::names.begin(), QueryFeatures::names.end(), name);
+        return features.values[std::distance(QueryFeatures::names.begin(), pos)];
+    };
+    REQUIRE(feature("terms") == 3.0);
+    REQUIRE(feature("sum_postings") == 1107.0);
+    REQUIRE(feature("min_postings") == 7.0);
+    REQUIRE(feature("max_postings") == 1000.0);
+    REQUIRE(feature("conjunctive_postings") == 21.0);
+    REQUIRE(feature("sum_of_logs") == Approx(std::log2(101.0) + 3.0 + std::log2(1001.0)));
+    REQUIRE(feature("max_b") == 10.0);
+    REQUIRE(feature("score_skew") == Approx(0.5));
+
+    auto empty = query_features(std::vector<std::uint32_t>{}, std::vector<float>{});
+    REQUIRE(std::all_of(empty.values.begin(), empty.values.end(), [](auto v) { return v == 0; }));
+    REQUIRE_THROWS_AS(
+        query_features(std::vector<std::uint32_t>{1}, std::vector<float>{}), std::invalid_argument
+    );
+}
+
+TEST_CASE("Fit cost predictor", "[cost_model]") {
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<std::uint32_t> size_dist(1, 100000);
+    std::uniform_real_distribution<float> score_dist(0.1, 10.0);
+    std::uniform_int_distribution<std::size_t> terms_dist(1, 6);
+
+    std::vector<QueryFeatures> features;
+    std::vector<double> or_costs;
+    std::vector<double> and_costs;
+    for (int query = 0; query < 200; ++query) {
+        std::vector<std::uint32_t> sizes(terms_dist(gen));
+        std::vector<float> scores(sizes.size());
+        std::generate(sizes.begin(), sizes.end(), [&] { return size_dist(gen); });
+        std::generate(scores.begin(), scores.end(), [&] { return score_dist(gen); });
+        features.push_back(query_features(sizes, scores));
+        or_costs.push_back(10.0 + 0.01 * features.back().values[1]);
+        and_costs.push_back(50.0 + 0.02 * features.back().values[4]);
+    }
+
+    auto or_predictor = CostPredictor::fit(features, or_costs);
+    auto and_predictor = CostPredictor::fit(features, and_costs);
+    for (std::size_t query = 0; query < features.size(); ++query) {
+        REQUIRE(or_predictor(features[query]) == Approx(or_costs[query]).epsilon(0.01));
+        REQUIRE(and_predictor(features[query]) == Approx(and_costs[query]).epsilon(0.01));
+    }
+
+    CostModel model;
+    model.add("ranked_or_taat", or_predictor);
+    model.add("ranked_and", and_predictor);
+    REQUIRE(model.algorithms() == std::vector<std::string>{"ranked_or_taat", "ranked_and"});
+    for (std::size_t query = 0; query < features.size(); ++query) {
+        std::size_t expected = or_costs[query] <= and_costs[query] ? 0 : 1;
+        if (std::abs(or_costs[query] - and_costs[query]) > 1.0) {
+            REQUIRE(model.select(features[query]) == expected);
+        }
+    }
+
+    std::stringstream buffer;
+    model.write(buffer);
+    auto read_model = CostModel::read(buffer);
+    REQUIRE(read_model.algorithms() == model.algorithms());
+    for (auto const& f: features) {
+        REQUIRE(read_model.predict("ranked_and", f) == model.predict("ranked_and", f));
+        REQUIRE(read_model.predict("ranked_or_taat", f) == model.predict("ranked_or_taat", f));
+    }
+    REQUIRE_THROWS_AS(model.predict("wand", features[0]), std::invalid_argument);
+    REQUIRE_THROWS_AS(
+        CostPredictor::fit(features, std::span(and_costs).first(10)), std::invalid_argument
+    );
+}
+
+TEST_CASE("Read cost model", "[cost_model]") {
+    std::istringstream in("maxscore bias 2.5\nmaxscore terms 1\n\nwand sum_postings 0.5\n");
+    auto model = CostModel::read(in);
+    REQUIRE(model.algorithms() == std::vector<std::string>{"maxscore", "wand"});
+    QueryFeatures features;
+    features.values[0] = 2;
+    features.values[1] = 10;
+    REQUIRE(model.predict("maxscore", features) == 4.5);
+    REQUIRE(model.predict("wand", features) == 5.0);
+    REQUIRE(model.select(features) == 0);
+
+    std::istringstream invalid_feature("maxscore postings 1\n");
+    REQUIRE_THROWS_AS(CostModel::read(invalid_feature), std::invalid_argument);
+    std::istringstream missing_value("maxscore terms\n");
+    REQUIRE_THROWS_AS(CostModel::read(missing_value), std::invalid_argument);
+    REQUIRE_THROWS_AS(CostModel{}.select(features), std::logic_error);
+    REQUIRE_THROWS_AS(
+        CostPredictor::fit(std::vector<QueryFeatures>{}, std::vector<double>{}),
+        std::invalid_argument
+    );
+}
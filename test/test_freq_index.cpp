@@ -8,6 +8,7 @@
 
 #include "test_generic_sequence.hpp"
 
+#include "codec/strict_elias_fano.hpp"
 #include "freq_index.hpp"
 #include "mappable/mapper.hpp"
 #include "memory_source.hpp"
@@ -60,15 +61,41 @@ void test_freq_index() {
             REQUIRE(coll.num_docs() == doc_enum.docid());
         }
     }
+
+    {
+        collection_type coll(pisa::MemorySource::mapped_file(idx_path));
+        std::vector<uint64_t> docs(100);
+        std::vector<uint64_t> freqs(100);
+        for (size_t i = 0; i < posting_lists.size(); ++i) {
+            auto const& plist = posting_lists[i];
+            auto doc_enum = coll[i];
+            size_t p = 0;
+            while (auto n = doc_enum.decode_next(docs.size(), docs.data(), freqs.data())) {
+                for (size_t j = 0; j < n; ++j, ++p) {
+                    MY_REQUIRE_EQUAL(plist.first[p], docs[j], "i = " << i << " p = " << p);
+                    MY_REQUIRE_EQUAL(plist.second[p], freqs[j], "i = " << i << " p = " << p);
+                }
+                if (p < plist.first.size()) {
+                    REQUIRE(plist.first[p] == doc_enum.docid());
+                    REQUIRE(plist.second[p] == doc_enum.freq());
+                }
+            }
+            REQUIRE(plist.first.size() == p);
+            REQUIRE(coll.num_docs() == doc_enum.docid());
+        }
+    }
 }
 
 TEST_CASE("freq_index") {
+    using pisa::compact_elias_fano;
     using pisa::indexed_sequence;
     using pisa::partitioned_sequence;
     using pisa::positive_sequence;
+    using pisa::strict_elias_fano;
     using pisa::strict_sequence;
     using pisa::uniform_partitioned_sequence;
 
+    test_freq_index<compact_elias_fano, positive_sequence<strict_elias_fano>>();
     test_freq_index<indexed_sequence, positive_sequence<>>();
 
     test_freq_index<partitioned_sequence<>, positive_sequence<partitioned_sequence<strict_sequence>>>();
@@ -149,6 +149,45 @@ void test_next_geq(SequenceReader r, std::vector<uint64_t> const& seq) {
     }
 }
 
+template <typename SequenceReader>
+void test_decode(SequenceReader r, std::vector<uint64_t> const& seq) {
+    REQUIRE(seq.size() == r.size());
+    if (seq.empty()) {
+        return;
+    }
+    std::vector<uint64_t> buf;
+
+    // decode consecutive chunks, moving on with next()
+    for (uint64_t chunk: {1, 3, 64, 1000}) {
+        uint64_t pos = 0;
+        while (pos < seq.size()) {
+            uint64_t n = std::min<uint64_t>(chunk, seq.size() - pos);
+            buf.assign(n, 0);
+            r.decode(pos, n, buf.data());
+            for (uint64_t i = 0; i < n; ++i) {
+                MY_REQUIRE_EQUAL(seq[pos + i], buf[i], "pos = " << pos << " i = " << i);
+            }
+            pos += n;
+            auto val = r.next();
+            REQUIRE(pos == val.first);
+            if (pos < seq.size()) {
+                MY_REQUIRE_EQUAL(seq[pos], val.second, "pos = " << pos);
+            }
+        }
+    }
+
+    // decode from arbitrary positions, backwards and forwards
+    for (uint64_t pos: {seq.size() / 2, uint64_t(0), seq.size() - 1, seq.size() / 3}) {
+        uint64_t n = std::min<uint64_t>(777, seq.size() - pos);
+        buf.assign(n, 0);
+        r.decode(pos, n, buf.data());
+        for (uint64_t i = 0; i < n; ++i) {
+            MY_REQUIRE_EQUAL(seq[pos + i], buf[i], "pos = " << pos << " i = " << i);
+        }
+        MY_REQUIRE_EQUAL(seq[pos + n - 1], r.move(pos + n - 1).second, "pos = " << pos);
+    }
+}
+
 // oh, C++
 struct no_next_geq_tag {};
 struct next_geq_tag: no_next_geq_tag {};
@@ -156,12 +195,14 @@ struct next_geq_tag: no_next_geq_tag {};
 template <typename SequenceReader>
 void test_sequence(SequenceReader r, std::vector<uint64_t> const& seq, no_next_geq_tag const&) {
     test_move_next(r, seq);
+    test_decode(r, seq);
 }
 
 template <typename SequenceReader>
 typename pisa::if_has_next_geq<SequenceReader>
 test_sequence(SequenceReader r, std::vector<uint64_t> const& seq, next_geq_tag const&) {
     test_move_next(r, seq);
+    test_decode(r, seq);
     test_next_geq(r, seq);
 }
 
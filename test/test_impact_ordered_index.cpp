@@ -0,0 +1,130 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <map>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "pisa/accumulator/quantized_accumulator.hpp"
+#include "pisa/accumulator/simple_accumulator.hpp"
+#include "pisa/impact_ordered_index.hpp"
+#include "pisa/memory_source.hpp"
+#include "pisa/query.hpp"
+#include "pisa/query/algorithm/saat_query.hpp"
+#include "pisa/query/query_context.hpp"
+
+using namespace pisa;
+
+auto encode(ImpactOrderedIndexBuilder const& builder) -> MemorySource {
+    std::ostringstream out;
+    builder.encode(out);
+    auto bytes = out.str();
+    return MemorySource::from_vector(std::vector<char>(bytes.begin(), bytes.end()));
+}
+
+TEST_CASE("Impact-ordered index", "[impact_ordered_index]") {
+    ImpactOrderedIndexBuilder builder(10);
+    std::vector<DocId> documents{0, 2, 3, 5, 9};
+    std::vector<std::uint32_t> impacts{2, 7, 2, 0, 7};
+    builder.add_posting_list(documents, impacts);
+    builder.add_posting_list(std::vector<DocId>{}, std::vector<std::uint32_t>{});
+    builder.add_posting_list(std::vector<DocId>{4}, std::vector<std::uint32_t>{1});
+    REQUIRE(builder.size() == 3);
+
+    ImpactOrderedIndex index(encode(builder));
+    REQUIRE(index.num_docs() == 10);
+    REQUIRE(index.size() == 3);
+    REQUIRE(index.num_postings() == 5);
+
+    auto segments = index.segments(0);
+    REQUIRE(segments.size() == 2);
+    REQUIRE(segments[0].impact == 7);
+    REQUIRE(segments[1].impact == 2);
+    auto high = index.documents(segments[0]);
+    auto low = index.documents(segments[1]);
+    REQUIRE(std::vector<DocId>(high.begin(), high.end()) == std::vector<DocId>{2, 9});
+    REQUIRE(std::vector<DocId>(low.begin(), low.end()) == std::vector<DocId>{0, 3});
+    REQUIRE(index.segments(1).empty());
+    REQUIRE(index.segments(2).size() == 1);
+    REQUIRE_THROWS_AS(index.segments(3), std::out_of_range);
+
+    REQUIRE_THROWS_AS(
+        builder.add_posting_list(std::vector<DocId>{10}, std::vector<std::uint32_t>{1}),
+        std::invalid_argument
+    );
+    REQUIRE_THROWS_AS(
+        builder.add_posting_list(std::vector<DocId>{1}, std::vector<std::uint32_t>{}),
+        std::invalid_argument
+    );
+    REQUIRE_THROWS_AS(
+        ImpactOrderedIndex(MemorySource::from_vector(std::vector<char>(16, 0))),
+        std::invalid_argument
+    );
+}
+
+TEST_CASE("Score-at-a-time query", "[impact_ordered_index][query]") {
+    std::size_t num_docs = 1000;
+    std::size_t num_terms = 20;
+    std::mt19937 gen(117);
+    std::uniform_int_distribution<std::uint32_t> impact_dist(1, 16);
+    std::bernoulli_distribution posting_dist(0.1);
+
+    std::vector<std::map<DocId, std::uint32_t>> lists(num_terms);
+    ImpactOrderedIndexBuilder builder(num_docs);
+    for (auto& list: lists) {
+        std::vector<DocId> documents;
+        std::vector<std::uint32_t> impacts;
+        for (DocId docid = 0; docid < num_docs; ++docid) {
+            if (posting_dist(gen)) {
+                documents.push_back(docid);
+                impacts.push_back(impact_dist(gen));
+                list[docid] = impacts.back();
+            }
+        }
+        builder.add_posting_list(documents, impacts);
+    }
+    ImpactOrderedIndex index(encode(builder));
+
+    auto query = Query(std::nullopt, std::vector<TermId>{1, 4, 7, 13});
+    std::size_t total_postings = 0;
+    std::vector<std::uint32_t> expected_scores(num_docs, 0);
+    for (auto const& term: query.terms()) {
+        total_postings += lists[term.id].size();
+        for (auto [docid, impact]: lists[term.id]) {
+            expected_scores[docid] += impact;
+        }
+    }
+    std::sort(expected_scores.begin(), expected_scores.end(), std::greater{});
+
+    SECTION("Exhaustive") {
+        topk_queue topk(10);
+        saat_query saat_q(topk);
+        QuantizedAccumulator<std::uint32_t> accumulator(num_docs);
+        saat_q(index, query, accumulator);
+        topk.finalize();
+        REQUIRE(topk.is_complete());
+        REQUIRE(saat_q.processed_postings() == total_postings);
+        REQUIRE(topk.topk().size() == 10);
+        for (std::size_t pos = 0; pos < topk.topk().size(); ++pos) {
+            REQUIRE(topk.topk()[pos].first == static_cast<float>(expected_scores[pos]));
+        }
+    }
+
+    SECTION("Postings budget") {
+        topk_queue topk(10);
+        QueryContext context;
+        context.set_budget(QueryBudget::postings(50));
+        context.reset();
+        saat_query saat_q(topk, context);
+        SimpleAccumulator accumulator(num_docs);
+        saat_q(index, query, accumulator);
+        topk.finalize();
+        REQUIRE_FALSE(topk.is_complete());
+        REQUIRE(saat_q.processed_postings() >= 50);
+        REQUIRE(saat_q.processed_postings() < total_postings);
+        REQUIRE_FALSE(topk.topk().empty());
+        // Partial scores cannot exceed the complete scores.
+        REQUIRE(topk.topk().front().first <= static_cast<float>(expected_scores.front()));
+    }
+}
@@ -0,0 +1,68 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "pisa/util/intrinsics.hpp"
+
+using namespace pisa;
+
+TEST_CASE("Gaps to document IDs", "[intrinsics]") {
+    std::mt19937 rng(17);
+    auto base = GENERATE(std::uint32_t{0}, std::uint32_t{1}, std::uint32_t{1} << 31);
+    for (std::size_t size: {0, 1, 3, 4, 5, 8, 127, 128}) {
+        std::vector<std::uint32_t> gaps(size);
+        std::generate(gaps.begin(), gaps.end(), [&] { return rng() % 100; });
+        std::vector<std::uint32_t> expected(size);
+        std::uint32_t docid = base - 1;
+        for (std::size_t idx = 0; idx < size; ++idx) {
+            docid += gaps[idx] + 1;
+            expected[idx] = docid;
+        }
+        intrinsics::gaps_to_docids(gaps.data(), gaps.size(), base);
+        REQUIRE(gaps == expected);
+    }
+}
+
+TEST_CASE("Find first value not less than bound", "[intrinsics]") {
+    auto offset = GENERATE(std::uint32_t{0}, std::uint32_t{1} << 31);
+    for (std::size_t size: {0, 1, 5, 8, 13, 128}) {
+        std::vector<std::uint32_t> values(size);
+        for (std::size_t idx = 0; idx < size; ++idx) {
+            values[idx] = offset + 3 * idx;
+        }
+        for (std::uint32_t bound = offset; bound < offset + 3 * size + 2; ++bound) {
+            auto expected = std::lower_bound(values.begin(), values.end(), bound) - values.begin();
+            REQUIRE(intrinsics::find_geq(values.data(), size, bound) == expected);
+        }
+    }
+}
+
+TEST_CASE("OR packed bit fields", "[intrinsics]") {
+    std::mt19937_64 rng(17);
+    std::vector<std::uint8_t> bytes(1024);
+    std::generate(bytes.begin(), bytes.end(), [&] { return static_cast<std::uint8_t>(rng()); });
+    auto bit = [&](std::uint64_t pos) -> std::uint64_t {
+        return (bytes[pos / 8] >> (pos % 8)) & 1U;
+    };
+    for (std::uint64_t width: {0, 1, 7, 13, 32, 56}) {
+        for (std::uint64_t offset: {0, 3, 64, 101}) {
+            for (std::size_t size: {0, 1, 3, 4, 5, 8, 17, 100}) {
+                std::vector<std::uint64_t> values(size);
+                std::generate(values.begin(), values.end(), [&] { return rng() << width; });
+                auto expected = values;
+                for (std::size_t idx = 0; idx < size; ++idx) {
+                    for (std::uint64_t b = 0; b < width; ++b) {
+                        expected[idx] |= bit(offset + idx * width + b) << b;
+                    }
+                }
+                intrinsics::or_packed_bits(values.data(), bytes.data(), offset, width, size);
+                REQUIRE(values == expected);
+            }
+        }
+    }
+}
@@ -34,6 +34,20 @@ void test_positive_sequence() {
         MY_REQUIRE_EQUAL(i, val.first, "i = " << i);
         MY_REQUIRE_EQUAL(values[i], val.second, "i = " << i);
     }
+    for (size_t chunk: {1, 5, 128, 1000}) {
+        std::vector<uint64_t> buf(chunk);
+        for (size_t pos = 0; pos < n; pos += chunk) {
+            auto count = std::min(chunk, n - pos);
+            r.decode(pos, count, buf.data());
+            for (size_t i = 0; i < count; ++i) {
+                MY_REQUIRE_EQUAL(values[pos + i], buf[i], "pos = " << pos << " i = " << i);
+            }
+        }
+    }
+    uint64_t value = 0;
+    r.decode(n / 2, 1, &value);
+    REQUIRE(value == values[n / 2]);
+    REQUIRE(r.move(n / 2 + 1).second == values[n / 2 + 1]);
 }
 
 TEST_CASE("positive_sequence") {
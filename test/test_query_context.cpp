@@ -0,0 +1,140 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory_resource>
+#include <thread>
+#include <vector>
+
+#include "pisa/query/query_context.hpp"
+
+using namespace pisa;
+
+/** Counts allocations, and passes them to `std::pmr::new_delete_resource()`. */
+class CountingResource: public std::pmr::memory_resource {
+  public:
+    std::size_t allocations = 0;
+
+  private:
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override {
+        return this == &other;
+    }
+};
+
+/** Allocates vectors of the given sizes from the context, as a query would. */
+void run_query(QueryContext& context, std::vector<std::size_t> const& sizes) {
+    context.reset();
+    std::vector<std::pmr::vector<std::uint32_t>> vectors;
+    vectors.reserve(sizes.size());
+    for (auto size: sizes) {
+        vectors.emplace_back(size, 1, context.resource());
+    }
+    for (auto const& vec: vectors) {
+        REQUIRE(std::all_of(vec.begin(), vec.end(), [](auto value) { return value == 1; }));
+    }
+}
+
+TEST_CASE("Query context grows to the largest query", "[query_context]") {
+    CountingResource upstream;
+    QueryContext context(1024, &upstream);
+    REQUIRE(context.capacity() == 1024);
+    REQUIRE(upstream.allocations == 1);
+
+    run_query(context, {16, 32});
+    REQUIRE(upstream.allocations == 1);
+
+    run_query(context, {1024, 2048});
+    auto allocations = upstream.allocations;
+    REQUIRE(allocations > 1);
+
+    // The next reset grows the arena, after which no query up to that size allocates.
+    run_query(context, {1024, 2048});
+    REQUIRE(context.capacity() > 1024 + 3 * 1024 * sizeof(std::uint32_t));
+    REQUIRE(upstream.allocations == allocations + 1);
+    for (int run = 0; run < 10; ++run) {
+        run_query(context, {1024, 2048});
+        run_query(context, {16, 32, 64});
+    }
+    REQUIRE(upstream.allocations == allocations + 1);
+}
+
+TEST_CASE("Query context copy is a new context", "[query_context]") {
+    QueryContext context(1024);
+    run_query(context, {4096});
+    context.reset();
+    auto capacity = context.capacity();
+    REQUIRE(capacity > 1024);
+
+    QueryContext copy(context);
+    REQUIRE(copy.capacity() == capacity);
+    REQUIRE(copy.resource() != context.resource());
+    run_query(copy, {4096});
+    run_query(context, {4096});
+}
+
+TEST_CASE("Query context top-k queue is reset", "[query_context]") {
+    QueryContext context;
+    auto& topk = context.topk(2, 1.0);
+    REQUIRE(topk.capacity() == 2);
+    REQUIRE(topk.initial_threshold() == 1.0);
+    REQUIRE_FALSE(topk.insert(0.5, 0));
+    REQUIRE(topk.insert(2.0, 1));
+    REQUIRE(topk.insert(3.0, 2));
+    REQUIRE(topk.insert(4.0, 3));
+    REQUIRE(topk.effective_threshold() == 3.0);
+
+    auto& other = context.topk(3);
+    REQUIRE(&other == &topk);
+    REQUIRE(other.size() == 0);
+    REQUIRE(other.capacity() == 3);
+    REQUIRE(other.initial_threshold() == 0.0);
+    REQUIRE(other.insert(0.5, 0));
+    other.finalize();
+    REQUIRE(other.topk() == std::vector<topk_queue::entry_type>{{0.5, 0}});
+}
+
+TEST_CASE("Query budget", "[query_context]") {
+    SECTION("Unlimited") {
+        QueryBudget budget;
+        REQUIRE_FALSE(budget.is_limited());
+        REQUIRE_FALSE(budget.charge(std::numeric_limits<std::size_t>::max() / 2));
+        REQUIRE_FALSE(budget.exhausted());
+    }
+    SECTION("Postings") {
+        auto budget = QueryBudget::postings(100);
+        REQUIRE(budget.is_limited());
+        REQUIRE_FALSE(budget.charge(60));
+        REQUIRE(budget.charge(40));
+        REQUIRE(budget.exhausted());
+        REQUIRE(budget.processed_postings() == 100);
+        budget.start();
+        REQUIRE_FALSE(budget.exhausted());
+        REQUIRE(budget.processed_postings() == 0);
+    }
+    SECTION("Time") {
+        auto budget = QueryBudget::time(std::chrono::milliseconds(1));
+        REQUIRE_FALSE(budget.charge(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        // The clock is only read every `clock_interval` postings.
+        REQUIRE_FALSE(budget.charge(1));
+        REQUIRE(budget.charge(QueryBudget::clock_interval));
+    }
+    SECTION("Context restarts the budget") {
+        QueryContext context;
+        context.set_budget(QueryBudget::postings(10));
+        REQUIRE(context.budget().charge(10));
+        context.reset();
+        REQUIRE_FALSE(context.budget().exhausted());
+        QueryContext copy(context);
+        REQUIRE(copy.budget().max_postings() == 10);
+    }
+}
@@ -2,27 +2,45 @@
 #include "type_safe.hpp"
 #define CATCH_CONFIG_MAIN
 
+#include <limits>
 #include <memory>
+#include <sstream>
+#include <utility>
 
 #include <catch2/catch.hpp>
 
+#include "accumulator/block_max_accumulator.hpp"
 #include "accumulator/lazy_accumulator.hpp"
+#include "accumulator/quantized_accumulator.hpp"
 #include "accumulator/simple_accumulator.hpp"
+#include "buffered_topk_queue.hpp"
+#include "champion_lists.hpp"
 #include "cursor/block_max_scored_cursor.hpp"
 #include "cursor/scored_cursor.hpp"
 #include "index_types.hpp"
 #include "io.hpp"
+#include "memory_source.hpp"
 #include "pisa_config.hpp"
+#include "query/algorithm/batched_ranked_or_taat_query.hpp"
 #include "query/algorithm/block_max_maxscore_query.hpp"
 #include "query/algorithm/block_max_ranked_and_query.hpp"
 #include "query/algorithm/block_max_wand_query.hpp"
+#include "query/algorithm/bootstrap_threshold.hpp"
+#include "query/algorithm/champion_query.hpp"
 #include "query/algorithm/maxscore_query.hpp"
+#include "query/algorithm/parallel_range_query.hpp"
 #include "query/algorithm/range_query.hpp"
 #include "query/algorithm/ranked_and_query.hpp"
 #include "query/algorithm/ranked_or_query.hpp"
 #include "query/algorithm/ranked_or_taat_query.hpp"
+#include "query/algorithm/ranked_or_window_query.hpp"
 #include "query/algorithm/wand_query.hpp"
+#include "query/cost_model.hpp"
+#include "query/query_context.hpp"
+#include "query/query_groups.hpp"
+#include "query/query_processor.hpp"
 #include "scorer/scorer.hpp"
+#include "threshold_store.hpp"
 #include "wand_data.hpp"
 #include "wand_data_raw.hpp"
 #include "wand_utils.hpp"
@@ -102,6 +120,34 @@ class ranked_or_taat_query_acc: public ranked_or_taat_query {
     }
 };
 
+struct CollectionBuffer {
+    buffered_topk_queue buffer{0};
+};
+
+template <typename Acc>
+class ranked_or_taat_query_buffered: private CollectionBuffer, public ranked_or_taat_query {
+  public:
+    explicit ranked_or_taat_query_buffered(topk_queue& topk) : ranked_or_taat_query(topk, buffer) {}
+
+    template <typename CursorRange>
+        requires(pisa::concepts::MaxScorePostingCursor<pisa::val_t<CursorRange>>)
+    void operator()(CursorRange&& cursors, uint64_t max_docid) {
+        Acc accumulator(max_docid);
+        ranked_or_taat_query::operator()(cursors, max_docid, accumulator);
+    }
+};
+
+class ranked_or_window_query_64: public ranked_or_window_query {
+  public:
+    using ranked_or_window_query::ranked_or_window_query;
+
+    template <typename CursorRange>
+        requires(pisa::concepts::MaxScorePostingCursor<pisa::val_t<CursorRange>>)
+    void operator()(CursorRange&& cursors, uint64_t max_docid) {
+        ranked_or_window_query::operator()(cursors, max_docid, 64);
+    }
+};
+
 template <typename T>
 class range_query_128: public range_query<T> {
   public:
@@ -120,6 +166,12 @@ TEMPLATE_TEST_CASE(
     "[query][ranked][integration]",
     ranked_or_taat_query_acc<SimpleAccumulator>,
     ranked_or_taat_query_acc<LazyAccumulator<4>>,
+    ranked_or_taat_query_buffered<SimpleAccumulator>,
+    ranked_or_taat_query_buffered<LazyAccumulator<4>>,
+    ranked_or_taat_query_acc<BlockMaxAccumulator<>>,
+    ranked_or_taat_query_buffered<BlockMaxAccumulator<>>,
+    ranked_or_window_query,
+    ranked_or_window_query_64,
     wand_query,
     maxscore_query,
     block_max_wand_query,
@@ -163,6 +215,53 @@ TEMPLATE_TEST_CASE(
     }
 }
 
+// NOLINTNEXTLINE(hicpp-explicit-conversions)
+TEMPLATE_TEST_CASE(
+    "Parallel range query test",
+    "[query][ranked][integration]",
+    wand_query,
+    maxscore_query,
+    block_max_wand_query,
+    block_max_maxscore_query
+) {
+    for (auto quantized: {false, true}) {
+        for (auto&& s_name: {"bm25", "qld"}) {
+            std::unordered_set<size_t> dropped_term_ids;
+            auto data = IndexData<single_index>::get(s_name, quantized, dropped_term_ids);
+            topk_queue topk_1(10);
+            parallel_range_query<TestType> op_q(topk_1);
+            topk_queue topk_2(10);
+            ranked_or_query or_q(topk_2);
+
+            auto scorer = scorer::from_params(ScorerParams(s_name), data->wdata);
+            for (auto const& q: data->queries) {
+                for (std::size_t range_count: {1, 4, 64}) {
+                    or_q(make_scored_cursors(data->index, *scorer, q), data->index.num_docs());
+                    op_q(
+                        [&] {
+                            return make_block_max_scored_cursors(
+                                data->index, data->wdata, *scorer, q
+                            );
+                        },
+                        data->index.num_docs(),
+                        range_count
+                    );
+                    topk_1.finalize();
+                    topk_2.finalize();
+                    REQUIRE(topk_2.topk().size() == topk_1.topk().size());
+                    for (size_t i = 0; i < topk_2.topk().size(); ++i) {
+                        REQUIRE(
+                            topk_2.topk()[i].first == Approx(topk_1.topk()[i].first).epsilon(0.1)
+                        );
+                    }
+                    topk_1.clear();
+                    topk_2.clear();
+                }
+            }
+        }
+    }
+}
+
 // NOLINTNEXTLINE(hicpp-explicit-conversions)
 TEMPLATE_TEST_CASE("Ranked AND query test", "[query][ranked][integration]", block_max_ranked_and_query) {
     for (auto quantized: {false, true}) {
@@ -198,6 +297,445 @@ TEMPLATE_TEST_CASE("Ranked AND query test", "[query][ranked][integration]", bloc
     }
 }
 
+// NOLINTNEXTLINE(hicpp-explicit-conversions)
+TEMPLATE_TEST_CASE(
+    "Ranked query test with query context",
+    "[query][ranked][integration]",
+    wand_query,
+    maxscore_query,
+    block_max_wand_query,
+    block_max_maxscore_query,
+    block_max_ranked_and_query,
+    ranked_and_query,
+    ranked_or_query,
+    ranked_or_window_query
+) {
+    for (auto quantized: {false, true}) {
+        for (auto&& s_name: {"bm25", "qld"}) {
+            std::unordered_set<size_t> dropped_term_ids;
+            auto data = IndexData<single_index>::get(s_name, quantized, dropped_term_ids);
+            auto scorer = scorer::from_params(ScorerParams(s_name), data->wdata);
+            // Small enough for the arena to grow while processing the queries.
+            QueryContext context(256);
+            for (auto const& q: data->queries) {
+                topk_queue expected(10);
+                TestType expected_q(expected);
+                expected_q(
+                    make_block_max_scored_cursors(data->index, data->wdata, *scorer, q),
+                    data->index.num_docs()
+                );
+                expected.finalize();
+
+                context.reset();
+                auto& topk = context.topk(10);
+                TestType(topk, context)(
+                    make_block_max_scored_cursors(data->index, data->wdata, *scorer, q, context),
+                    data->index.num_docs()
+                );
+                topk.finalize();
+                REQUIRE(topk.is_complete());
+                REQUIRE(topk.topk() == expected.topk());
+            }
+        }
+    }
+}
+
+// NOLINTNEXTLINE(hicpp-explicit-conversions)
+TEMPLATE_TEST_CASE(
+    "Ranked query test with postings budget",
+    "[query][ranked][integration]",
+    wand_query,
+    maxscore_query,
+    block_max_wand_query,
+    block_max_maxscore_query
+) {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+    QueryContext context;
+    for (auto const& q: data->queries) {
+        topk_queue expected(10);
+        TestType expected_q(expected);
+        expected_q(
+            make_block_max_scored_cursors(data->index, data->wdata, *scorer, q),
+            data->index.num_docs()
+        );
+        expected.finalize();
+
+        context.set_budget(QueryBudget::postings(1));
+        context.reset();
+        auto& topk = context.topk(10);
+        TestType(topk, context)(
+            make_block_max_scored_cursors(data->index, data->wdata, *scorer, q, context),
+            data->index.num_docs()
+        );
+        topk.finalize();
+        REQUIRE(topk.topk().size() <= 1);
+        REQUIRE(topk.is_complete() == expected.topk().empty());
+
+        context.set_budget(QueryBudget::postings(std::numeric_limits<std::size_t>::max() - 1));
+        context.reset();
+        auto& unlimited = context.topk(10);
+        TestType(unlimited, context)(
+            make_block_max_scored_cursors(data->index, data->wdata, *scorer, q, context),
+            data->index.num_docs()
+        );
+        unlimited.finalize();
+        REQUIRE(unlimited.is_complete());
+        REQUIRE(unlimited.topk() == expected.topk());
+    }
+}
+
+TEST_CASE("Ranked OR TAAT query test with postings budget", "[query][ranked][integration]") {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+    SimpleAccumulator accumulator(data->index.num_docs());
+    QueryContext context;
+    context.set_budget(QueryBudget::postings(10));
+    for (auto const& q: data->queries) {
+        std::size_t postings = 0;
+        for (auto const& term: q.terms()) {
+            postings += data->index[term.id].size();
+        }
+        context.reset();
+        topk_queue topk(10);
+        ranked_or_taat_query(topk, context)(
+            make_scored_cursors(data->index, *scorer, q), data->index.num_docs(), accumulator
+        );
+        REQUIRE(topk.is_complete() == (postings <= 10));
+        REQUIRE(context.budget().processed_postings() <= std::max<std::size_t>(postings, 10));
+    }
+}
+
+// NOLINTNEXTLINE(hicpp-explicit-conversions)
+TEMPLATE_TEST_CASE(
+    "Ranked OR TAAT query test with quantized accumulator",
+    "[query][ranked][integration]",
+    std::uint16_t,
+    std::uint32_t
+) {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    // The quantized scorer returns the stored values, which are integers.
+    auto scorer = scorer::from_params(ScorerParams("quantized"), data->wdata);
+    SimpleAccumulator expected_accumulator(data->index.num_docs());
+    QuantizedAccumulator<TestType> accumulator(data->index.num_docs());
+    for (auto const& q: data->queries) {
+        topk_queue expected(10);
+        ranked_or_taat_query expected_q(expected);
+        expected_q(
+            make_scored_cursors(data->index, *scorer, q),
+            data->index.num_docs(),
+            expected_accumulator
+        );
+        expected.finalize();
+
+        topk_queue topk(10);
+        ranked_or_taat_query ranked_or_taat_q(topk);
+        ranked_or_taat_q(
+            make_scored_cursors(data->index, *scorer, q), data->index.num_docs(), accumulator
+        );
+        topk.finalize();
+
+        REQUIRE(topk.topk().size() == expected.topk().size());
+        for (std::size_t i = 0; i < topk.topk().size(); ++i) {
+            REQUIRE(topk.topk()[i].first == expected.topk()[i].first);
+            REQUIRE(expected_accumulator[topk.topk()[i].second] == topk.topk()[i].first);
+        }
+    }
+}
+
+TEST_CASE("Batched ranked OR TAAT query test", "[query][ranked][integration]") {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+    std::size_t max_group_size = GENERATE(1, 3, 8);
+    auto groups = group_queries_by_terms(data->queries, max_group_size);
+
+    std::vector<bool> seen(data->queries.size(), false);
+    batched_ranked_or_taat_query batched_q(data->index.num_docs(), max_group_size);
+    SimpleAccumulator accumulator(data->index.num_docs());
+    for (auto const& group: groups) {
+        REQUIRE(!group.empty());
+        REQUIRE(group.size() <= max_group_size);
+        std::vector<topk_queue> topks(group.size(), topk_queue(10));
+        batched_q(data->index, *scorer, data->queries, group, topks);
+        for (std::size_t pos = 0; pos < group.size(); ++pos) {
+            auto const& q = data->queries[group[pos]];
+            REQUIRE(!seen[group[pos]]);
+            seen[group[pos]] = true;
+
+            topk_queue expected(10);
+            ranked_or_taat_query ranked_or_taat_q(expected);
+            ranked_or_taat_q(
+                make_scored_cursors(data->index, *scorer, q), data->index.num_docs(), accumulator
+            );
+            expected.finalize();
+            topks[pos].finalize();
+            REQUIRE(topks[pos].topk().size() == expected.topk().size());
+            for (std::size_t i = 0; i < expected.topk().size(); ++i) {
+                REQUIRE(topks[pos].topk()[i].first == Approx(expected.topk()[i].first));
+            }
+        }
+    }
+    REQUIRE(std::all_of(seen.begin(), seen.end(), [](bool s) { return s; }));
+}
+
+TEST_CASE("Group queries by terms", "[query]") {
+    std::vector<Query> queries{
+        Query(std::nullopt, std::vector<TermId>{1, 2, 3}),
+        Query(std::nullopt, std::vector<TermId>{7, 8}),
+        Query(std::nullopt, std::vector<TermId>{3}),
+        Query(std::nullopt, std::vector<TermId>{2, 3, 4}),
+        Query(std::nullopt, std::vector<TermId>{8, 9}),
+        Query(std::nullopt, std::vector<TermId>{5}),
+    };
+    REQUIRE(
+        group_queries_by_terms(queries, 2)
+        == std::vector<std::vector<std::size_t>>{{0, 3}, {1, 4}, {2}, {5}}
+    );
+    REQUIRE(
+        group_queries_by_terms(queries, 3)
+        == std::vector<std::vector<std::size_t>>{{0, 2, 3}, {1, 4}, {5}}
+    );
+    REQUIRE(
+        group_queries_by_terms(queries, 1)
+        == std::vector<std::vector<std::size_t>>{{0}, {1}, {2}, {3}, {4}, {5}}
+    );
+    REQUIRE(group_queries_by_terms(std::vector<Query>{}, 4).empty());
+    REQUIRE_THROWS_AS(group_queries_by_terms(queries, 0), std::invalid_argument);
+}
+
+TEST_CASE("Quantized TAAT query processor requires quantized scorer", "[query][ranked]") {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    std::string scorer_name = GENERATE("bm25", "qld", "dph");
+    auto scorer = scorer::from_params(ScorerParams(scorer_name), data->wdata);
+    REQUIRE_THROWS_AS(
+        make_query_processor(
+            "ranked_or_taat_quantized", data->index, data->wdata, *scorer, false
+        ),
+        std::invalid_argument
+    );
+    auto quantized_scorer = scorer::from_params(ScorerParams("quantized"), data->wdata);
+    REQUIRE_NOTHROW(make_query_processor(
+        "ranked_or_taat_quantized", data->index, data->wdata, *quantized_scorer, false
+    ));
+}
+
+TEST_CASE("Auto query processor", "[query][ranked][integration]") {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+
+    // Selects ranked_and for single-term queries, and block_max_wand otherwise.
+    CostPredictor::weights_type and_weights{};
+    and_weights[0] = 2.0;
+    CostModel model;
+    model.add("block_max_wand", CostPredictor(3.0, {}));
+    model.add("ranked_and", CostPredictor(0.0, and_weights));
+
+    auto process = make_auto_query_processor(data->index, data->wdata, *scorer, false, model);
+    auto wand = make_query_processor("block_max_wand", data->index, data->wdata, *scorer, false);
+    auto ranked_and = make_query_processor("ranked_and", data->index, data->wdata, *scorer, false);
+    for (auto const& q: data->queries) {
+        topk_queue expected(10);
+        if (q.terms().size() == 1) {
+            ranked_and(q, expected);
+        } else {
+            wand(q, expected);
+        }
+        expected.finalize();
+        topk_queue topk(10);
+        process(q, topk);
+        topk.finalize();
+        REQUIRE(topk.topk() == expected.topk());
+    }
+    REQUIRE_THROWS_AS(
+        make_auto_query_processor(data->index, data->wdata, *scorer, false, CostModel{}),
+        std::invalid_argument
+    );
+}
+
+TEST_CASE("Bootstrapped threshold", "[query][ranked][integration]") {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+    std::size_t max_postings = GENERATE(1, 100, std::numeric_limits<std::size_t>::max());
+    QueryContext context;
+    std::size_t seeded = 0;
+    for (auto const& q: data->queries) {
+        topk_queue expected(10);
+        block_max_wand_query bmw_q(expected);
+        bmw_q(
+            make_block_max_scored_cursors(data->index, data->wdata, *scorer, q),
+            data->index.num_docs()
+        );
+        expected.finalize();
+
+        context.reset();
+        auto threshold = bootstrap_threshold(
+            make_block_max_scored_cursors(data->index, data->wdata, *scorer, q, context),
+            data->index.num_docs(),
+            10,
+            context,
+            max_postings
+        );
+        if (threshold > 0.0) {
+            seeded += 1;
+            REQUIRE(expected.topk().size() == 10);
+            REQUIRE(threshold <= expected.topk().back().first);
+        }
+    }
+    if (max_postings == std::numeric_limits<std::size_t>::max()) {
+        REQUIRE(seeded > 0);
+    }
+}
+
+TEST_CASE("Bootstrapped threshold is charged to the query budget", "[query][ranked][integration]") {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+    QueryContext unlimited;
+    QueryContext limited;
+    limited.set_budget(QueryBudget::postings(16));
+    std::size_t charged = 0;
+    for (auto const& q: data->queries) {
+        unlimited.reset();
+        auto threshold = bootstrap_threshold(
+            make_block_max_scored_cursors(data->index, data->wdata, *scorer, q, unlimited),
+            data->index.num_docs(),
+            10,
+            unlimited
+        );
+        charged += unlimited.budget().processed_postings();
+        REQUIRE(
+            unlimited.budget().processed_postings()
+            <= default_bootstrap_postings + q.terms().size()
+        );
+
+        limited.reset();
+        REQUIRE(
+            bootstrap_threshold(
+                make_block_max_scored_cursors(data->index, data->wdata, *scorer, q, limited),
+                data->index.num_docs(),
+                10,
+                limited
+            )
+            <= threshold
+        );
+        REQUIRE(limited.budget().processed_postings() <= 16 + q.terms().size());
+    }
+    REQUIRE(charged > 0);
+}
+
+TEST_CASE("Bootstrapped query processor", "[query][ranked][integration]") {
+    auto [algorithm, bootstrapped] = GENERATE(
+        std::pair{"block_max_wand", "block_max_wand_bootstrap"},
+        std::pair{"maxscore", "maxscore_bootstrap"}
+    );
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+    auto process = make_query_processor(algorithm, data->index, data->wdata, *scorer, false);
+    auto process_bootstrapped =
+        make_query_processor(bootstrapped, data->index, data->wdata, *scorer, false);
+    for (auto const& q: data->queries) {
+        topk_queue expected(10);
+        process(q, expected);
+        expected.finalize();
+        topk_queue topk(10);
+        process_bootstrapped(q, topk);
+        topk.finalize();
+        REQUIRE(topk.is_complete());
+        REQUIRE(topk.topk().size() == expected.topk().size());
+        for (std::size_t i = 0; i < topk.topk().size(); ++i) {
+            REQUIRE(topk.topk()[i].first == Approx(expected.topk()[i].first));
+        }
+    }
+}
+
+TEST_CASE("Champion lists query processor", "[query][ranked][integration]") {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+    std::ostringstream encoded;
+    build_champion_lists(data->collection, data->wdata, ScorerParams("bm25"), 20).encode(encoded);
+    auto bytes = encoded.str();
+    ChampionLists lists(MemorySource::from_vector(std::vector<char>(bytes.begin(), bytes.end())));
+
+    std::vector<Query> queries = data->queries;
+    for (auto const& q: data->queries) {
+        for (auto const& term: q.terms()) {
+            queries.emplace_back(std::nullopt, std::vector<TermId>{term.id});
+        }
+    }
+    std::string algorithm = GENERATE("maxscore", "block_max_wand", "ranked_and");
+    bool conjunctive = algorithm == "ranked_and";
+    auto process = make_query_processor(algorithm, data->index, data->wdata, *scorer, false);
+    auto process_champions =
+        with_champion_lists(process, lists, data->index, *scorer, false, conjunctive);
+    for (auto const& q: queries) {
+        topk_queue expected(10);
+        process(q, expected);
+        expected.finalize();
+        topk_queue topk(10);
+        process_champions(q, topk);
+        topk.finalize();
+        REQUIRE(topk.topk().size() == expected.topk().size());
+        for (std::size_t i = 0; i < topk.topk().size(); ++i) {
+            REQUIRE(topk.topk()[i].first == Approx(expected.topk()[i].first));
+        }
+    }
+}
+
+TEST_CASE("Threshold store query processor", "[query][ranked][integration]") {
+    std::unordered_set<size_t> dropped_term_ids;
+    auto data = IndexData<single_index>::get("bm25", false, dropped_term_ids);
+    auto scorer = scorer::from_params(ScorerParams("bm25"), data->wdata);
+    auto kth_score = [&](std::vector<TermId> terms) {
+        topk_queue topk(10);
+        wand_query wand_q(topk);
+        wand_q(
+            make_max_scored_cursors(data->index, data->wdata, *scorer, Query(std::nullopt, terms)),
+            data->index.num_docs()
+        );
+        return topk.size() == 10 ? topk.true_threshold() : 0.0F;
+    };
+    ThresholdStoreBuilder builder(10, data->index.size());
+    for (auto const& q: data->queries) {
+        auto terms = q.terms();
+        for (std::size_t i = 0; i < terms.size(); ++i) {
+            builder.term(terms[i].id, kth_score({terms[i].id}));
+            for (std::size_t j = i + 1; j < terms.size(); ++j) {
+                builder.pair(terms[i].id, terms[j].id, kth_score({terms[i].id, terms[j].id}));
+            }
+        }
+    }
+    std::ostringstream encoded;
+    builder.encode(encoded);
+    auto bytes = encoded.str();
+    ThresholdStore store(MemorySource::from_vector(std::vector<char>(bytes.begin(), bytes.end())));
+
+    std::string algorithm = GENERATE("wand", "ranked_and");
+    bool conjunctive = is_conjunctive(algorithm);
+    auto process = make_query_processor(algorithm, data->index, data->wdata, *scorer, false);
+    for (auto const& q: data->queries) {
+        topk_queue expected(10);
+        process(q, expected);
+        expected.finalize();
+        topk_queue topk(10);
+        topk.reset(10, store.threshold(q, 10, conjunctive));
+        process(q, topk);
+        topk.finalize();
+        REQUIRE(topk.topk().size() == expected.topk().size());
+        for (std::size_t i = 0; i < topk.topk().size(); ++i) {
+            REQUIRE(topk.topk()[i].first == Approx(expected.topk()[i].first));
+        }
+    }
+}
+
 TEST_CASE("Top k") {
     for (auto&& s_name: {"bm25", "qld"}) {
         std::unordered_set<size_t> dropped_term_ids;
@@ -0,0 +1,183 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "pisa/query.hpp"
+#include "pisa/query/result_cache.hpp"
+#include "pisa/topk_queue.hpp"
+
+using namespace pisa;
+
+using entry_type = topk_queue::entry_type;
+
+auto make_query(std::vector<TermId> terms, query::TermPolicy policy = query::default_policy)
+    -> Query {
+    return Query(std::nullopt, terms, policy);
+}
+
+auto make_results(std::size_t count) -> std::vector<entry_type> {
+    std::vector<entry_type> results;
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        results.emplace_back(static_cast<Score>(count - idx), static_cast<DocId>(idx));
+    }
+    return results;
+}
+
+TEST_CASE("Result cache key is normalized", "[result_cache]") {
+    auto key = ResultCacheKey::from(
+        make_query({3, 1, 3, 2}, query::keep_duplicates), "wand", "bm25"
+    );
+    REQUIRE(
+        key.terms
+        == std::vector<WeightedTerm>{
+            {.id = 1, .weight = 1.0}, {.id = 2, .weight = 1.0}, {.id = 3, .weight = 2.0}
+        }
+    );
+    auto other = ResultCacheKey::from(make_query({2, 3, 1, 3}), "wand", "bm25");
+    REQUIRE(key == other);
+    REQUIRE(key.hash() == other.hash());
+    REQUIRE_FALSE(key == ResultCacheKey::from(make_query({2, 3, 1, 3}), "maxscore", "bm25"));
+    REQUIRE_FALSE(key == ResultCacheKey::from(make_query({2, 3, 1, 3}), "wand", "qld"));
+}
+
+TEST_CASE("Result cache serves smaller k", "[result_cache]") {
+    auto policy = GENERATE(CachePolicy::LRU, CachePolicy::LFU);
+    ResultCache cache(1 << 20, policy);
+    auto key = ResultCacheKey::from(make_query({1, 2}), "wand", "bm25");
+
+    REQUIRE_FALSE(cache.find(key, 10).has_value());
+    cache.insert(key, 10, make_results(10));
+
+    auto results = cache.find(key, 5);
+    REQUIRE(results.has_value());
+    auto expected = make_results(10);
+    REQUIRE(*results == std::vector<entry_type>(expected.begin(), expected.begin() + 5));
+    REQUIRE(cache.find(key, 10) == make_results(10));
+    REQUIRE_FALSE(cache.find(key, 20).has_value());
+
+    // Results for a greater k replace the entry; results for a smaller k are ignored.
+    cache.insert(key, 20, make_results(20));
+    cache.insert(key, 3, make_results(3));
+    REQUIRE(cache.find(key, 20) == make_results(20));
+
+    auto stats = cache.stats();
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 2);
+    REQUIRE(stats.insertions == 2);
+    REQUIRE(stats.entries == 1);
+}
+
+TEST_CASE("Result cache stays within budget", "[result_cache]") {
+    auto key = [](TermId term) {
+        return ResultCacheKey::from(make_query({term}), "wand", "bm25");
+    };
+
+    SECTION("LRU evicts least recently used") {
+        ResultCache cache(4096, CachePolicy::LRU, 1);
+        cache.insert(key(0), 10, make_results(10));
+        auto entry_bytes = cache.stats().bytes;
+        auto capacity = 4096 / entry_bytes;
+        for (TermId term = 1; term < capacity; ++term) {
+            cache.insert(key(term), 10, make_results(10));
+        }
+        REQUIRE(cache.stats().entries == capacity);
+        REQUIRE(cache.find(key(0), 10).has_value());
+        cache.insert(key(capacity), 10, make_results(10));
+        REQUIRE(cache.stats().bytes <= 4096);
+        REQUIRE(cache.stats().evictions == 1);
+        REQUIRE(cache.find(key(0), 10).has_value());
+        REQUIRE_FALSE(cache.find(key(1), 10).has_value());
+    }
+
+    SECTION("LFU evicts least frequently used") {
+        ResultCache cache(4096, CachePolicy::LFU, 1);
+        cache.insert(key(0), 10, make_results(10));
+        auto entry_bytes = cache.stats().bytes;
+        auto capacity = 4096 / entry_bytes;
+        for (TermId term = 1; term < capacity; ++term) {
+            cache.insert(key(term), 10, make_results(10));
+            REQUIRE(cache.find(key(term), 10).has_value());
+        }
+        cache.insert(key(capacity), 10, make_results(10));
+        REQUIRE(cache.stats().bytes <= 4096);
+        REQUIRE_FALSE(cache.find(key(0), 10).has_value());
+        REQUIRE(cache.find(key(1), 10).has_value());
+    }
+
+    SECTION("Entries larger than the budget are not cached") {
+        ResultCache cache(4096, CachePolicy::LRU, 1);
+        cache.insert(key(0), 1000, make_results(1000));
+        REQUIRE(cache.stats().entries == 0);
+    }
+}
+
+TEST_CASE("Cached query processor", "[result_cache]") {
+    ResultCache cache(1 << 20);
+    std::size_t calls = 0;
+    QueryProcessor process = [&](Query const&, topk_queue& topk) {
+        ++calls;
+        for (auto [score, docid]: make_results(10)) {
+            topk.insert(score, docid);
+        }
+    };
+    auto cached = make_cached_query_processor(process, cache, "wand", "bm25");
+    auto run = [&](std::size_t k, Score threshold = 0.0) {
+        topk_queue topk(k, threshold);
+        cached(make_query({1, 2}), topk);
+        topk.finalize();
+        return topk.topk();
+    };
+    auto expected = make_results(10);
+    REQUIRE(run(10) == expected);
+    REQUIRE(run(10) == expected);
+    REQUIRE(run(3) == std::vector<entry_type>(expected.begin(), expected.begin() + 3));
+    REQUIRE(calls == 1);
+    run(10, 5.0);
+    REQUIRE(calls == 2);
+}
+
+TEST_CASE("Cached query processor skips incomplete results", "[result_cache]") {
+    ResultCache cache(1 << 20);
+    std::size_t calls = 0;
+    QueryProcessor process = [&](Query const&, topk_queue& topk) {
+        ++calls;
+        topk.insert(1.0, 0);
+        topk.mark_incomplete();
+    };
+    auto cached = make_cached_query_processor(process, cache, "wand", "bm25");
+    for (int run = 0; run < 2; ++run) {
+        topk_queue topk(10);
+        cached(make_query({1, 2}), topk);
+        REQUIRE_FALSE(topk.is_complete());
+    }
+    REQUIRE(calls == 2);
+    REQUIRE(cache.stats().entries == 0);
+}
+
+TEST_CASE("Result cache is thread safe", "[result_cache]") {
+    ResultCache cache(1 << 16, CachePolicy::LFU, 4);
+    std::atomic_size_t mismatches = 0;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&cache, &mismatches] {
+            for (TermId term = 0; term < 1000; ++term) {
+                auto key = ResultCacheKey::from(make_query({term % 100}), "wand", "bm25");
+                if (auto results = cache.find(key, 10); results) {
+                    mismatches += static_cast<std::size_t>(*results != make_results(10));
+                } else {
+                    cache.insert(key, 10, make_results(10));
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    REQUIRE(mismatches == 0);
+    auto stats = cache.stats();
+    REQUIRE(stats.hits + stats.misses == 4000);
+    REQUIRE(stats.bytes <= 1 << 16);
+}
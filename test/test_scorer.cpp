@@ -81,3 +81,50 @@ TEST_CASE("Quantized", "[scorer][unit]") {
     CHECK(term_scorer(1, 10) == Approx(10.0F));
     CHECK(term_scorer(1, 20) == Approx(20.0F));
 }
+
+TEST_CASE("Static term scorers match type-erased ones", "[scorer][unit]") {
+    WandData wdata;
+    auto name = GENERATE(
+        std::string("bm25"),
+        std::string("qld"),
+        std::string("pl2"),
+        std::string("dph"),
+        std::string("quantized")
+    );
+    auto weight = GENERATE(1.0F, 2.5F);
+    CAPTURE(name);
+    CAPTURE(weight);
+    auto dynamic_scorer = scorer::from_params(ScorerParams(name), wdata);
+    scorer::run_for_scorer(ScorerParams(name), wdata, [&](auto const& static_scorer) {
+        STATIC_REQUIRE(StaticIndexScorer<std::decay_t<decltype(static_scorer)>>);
+        for (std::uint32_t term_id: {0, 1}) {
+            auto expected = dynamic_scorer->term_scorer(term_id);
+            auto actual = static_scorer.static_term_scorer(term_id).weighted(weight);
+            for (std::uint32_t docid: {0, 1, 2}) {
+                for (std::uint32_t freq: {1, 10, 20}) {
+                    CHECK(actual(docid, freq) == Approx(weight * expected(docid, freq)));
+                }
+            }
+        }
+    });
+}
+
+TEST_CASE("BM25 block scoring", "[scorer][unit]") {
+    struct BlockWandData: WandData {
+        std::vector<std::uint32_t> lengths = {50, 40, 60, 10, 200, 50, 35, 70, 90, 55, 45};
+        [[nodiscard]] auto doc_lens() const -> std::span<std::uint32_t const> { return lengths; }
+        [[nodiscard]] auto norm_len(std::uint32_t docid) const -> float {
+            return lengths[docid] / avg_len();
+        }
+    };
+    BlockWandData wdata;
+    auto weight = GENERATE(1.0F, 2.5F);
+    auto term_scorer = bm25<BlockWandData>(wdata, 0.4, 0.9).static_term_scorer(0).weighted(weight);
+    std::vector<std::uint32_t> docids = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    std::vector<std::uint32_t> freqs = {1, 10, 20, 3, 4, 1, 2, 8, 100, 7, 5};
+    std::vector<float> scores(docids.size());
+    score_postings(term_scorer, docids, freqs, scores);
+    for (std::size_t idx = 0; idx < docids.size(); ++idx) {
+        CHECK(scores[idx] == Approx(term_scorer(docids[idx], freqs[idx])));
+    }
+}
@@ -0,0 +1,85 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <vector>
+
+#include "pisa/memory_source.hpp"
+#include "pisa/query.hpp"
+#include "pisa/threshold_store.hpp"
+
+using namespace pisa;
+
+auto encode(ThresholdStoreBuilder& builder) -> MemorySource {
+    std::ostringstream out;
+    builder.encode(out);
+    auto bytes = out.str();
+    return MemorySource::from_vector(std::vector<char>(bytes.begin(), bytes.end()));
+}
+
+auto make_query(std::vector<TermId> terms) -> Query {
+    return Query(std::nullopt, terms);
+}
+
+TEST_CASE("Threshold store", "[threshold_store]") {
+    ThresholdStoreBuilder builder(10, 5);
+    builder.term(0, 1.0);
+    builder.term(1, 2.0);
+    builder.term(3, 0.5);
+    builder.pair(3, 0, 2.5);
+    builder.pair(1, 2, 3.0);
+    builder.triple(4, 0, 3, 4.0);
+    ThresholdStore store(encode(builder));
+
+    REQUIRE(store.k() == 10);
+
+    SECTION("Lookups") {
+        REQUIRE(store.term(0) == 1.0);
+        REQUIRE(store.term(2) == 0.0);
+        REQUIRE(store.term(5) == 0.0);
+        REQUIRE(store.pair(0, 3) == 2.5);
+        REQUIRE(store.pair(3, 0) == 2.5);
+        REQUIRE(store.pair(2, 1) == 3.0);
+        REQUIRE(store.pair(0, 1) == 0.0);
+        REQUIRE(store.triple(0, 3, 4) == 4.0);
+        REQUIRE(store.triple(3, 4, 0) == 4.0);
+        REQUIRE(store.triple(0, 1, 2) == 0.0);
+    }
+
+    SECTION("Query thresholds") {
+        REQUIRE(store.threshold(make_query({0}), 10) == 1.0);
+        REQUIRE(store.threshold(make_query({0, 1}), 10) == 2.0);
+        REQUIRE(store.threshold(make_query({3, 0, 1}), 10) == 2.5);
+        REQUIRE(store.threshold(make_query({2, 1, 0}), 10) == 3.0);
+        REQUIRE(store.threshold(make_query({4, 3, 2, 0}), 10) == 4.0);
+        REQUIRE(store.threshold(make_query({4, 3, 2, 0}), 5) == 4.0);
+        REQUIRE(store.threshold(make_query({4, 3, 2, 0}), 11) == 0.0);
+        REQUIRE(store.threshold(make_query({2}), 10) == 0.0);
+        REQUIRE(store.threshold(make_query({0, 1}), 10, true) == 0.0);
+        REQUIRE(store.threshold(make_query({4, 3, 2, 0}), 5, true) == 0.0);
+    }
+    SECTION("Weighted query thresholds") {
+        auto query = [](std::vector<TermId> terms, std::vector<Score> weights) {
+            return Query(std::nullopt, terms, weights);
+        };
+        REQUIRE(store.threshold(query({0, 1}, {1.0, 2.0}), 10) == 2.0);
+        REQUIRE(store.threshold(query({0, 1}, {1.0, 0.5}), 10) == 0.0);
+        REQUIRE(store.threshold(query({2, 1, 0}, {0.5, 1.0, 1.0}), 10) == 0.0);
+    }
+}
+
+TEST_CASE("Invalid threshold store", "[threshold_store]") {
+    REQUIRE_THROWS_AS(
+        ThresholdStore(MemorySource::from_vector(std::vector<char>(8, 0))), std::invalid_argument
+    );
+    REQUIRE_THROWS_AS(
+        ThresholdStore(MemorySource::from_vector(std::vector<char>(64, 0))), std::invalid_argument
+    );
+
+    ThresholdStoreBuilder builder(10, 100);
+    auto source = encode(builder);
+    std::vector<char> truncated(source.begin(), source.end() - 4);
+    REQUIRE_THROWS_AS(
+        ThresholdStore(MemorySource::from_vector(std::move(truncated))), std::out_of_range
+    );
+}
@@ -5,6 +5,7 @@
 
 #include <rapidcheck.h>
 
+#include "pisa/buffered_topk_queue.hpp"
 #include "pisa/topk_queue.hpp"
 
 using namespace rc;
@@ -145,4 +146,101 @@ TEST_CASE("Threshold", "[topk_queue][prop]") {
             REQUIRE(std::is_sorted(true_thresholds.begin(), true_thresholds.end()));
         });
     }
+
+    SECTION("Queues with shared threshold merge to the same top-k scores") {
+        check([] {
+            auto [scores, docids] = *gen_postings(10, 1000);
+            auto split = *gen::inRange<std::size_t>(0, docids.size());
+
+            pisa::SharedThreshold threshold;
+            pisa::topk_queue lhs(10);
+            pisa::topk_queue rhs(10);
+            lhs.share_threshold(threshold);
+            rhs.share_threshold(threshold);
+            for (std::size_t posting = 0; posting < docids.size(); ++posting) {
+                auto& topk = posting < split ? lhs : rhs;
+                topk.insert(scores[posting], docids[posting]);
+            }
+
+            pisa::topk_queue merged(10);
+            for (auto const& topk: {lhs, rhs}) {
+                for (auto [score, docid]: topk.topk()) {
+                    merged.insert(score, docid);
+                }
+            }
+
+            auto expected = kth(scores, 10);
+            REQUIRE(threshold.load() <= expected);
+            REQUIRE(merged.true_threshold() == expected);
+        });
+    }
+}
+
+auto scores_of(std::vector<pisa::topk_queue::entry_type> const& entries) -> std::vector<float> {
+    std::vector<float> scores;
+    std::transform(entries.begin(), entries.end(), std::back_inserter(scores), [](auto entry) {
+        return entry.first;
+    });
+    return scores;
+}
+
+TEST_CASE("Buffered queue", "[topk_queue][prop]") {
+    SECTION("Single inserts result in the same scores as the heap") {
+        check([] {
+            auto [scores, docids] = *gen_postings(1, 1000);
+            auto k = *gen::inRange<std::size_t>(1, 100);
+
+            pisa::topk_queue expected(k);
+            accumulate(expected, scores, docids);
+            expected.finalize();
+
+            pisa::buffered_topk_queue topk(k);
+            for (std::size_t posting = 0; posting < docids.size(); ++posting) {
+                topk.insert(scores[posting], docids[posting]);
+            }
+            topk.finalize();
+            REQUIRE(scores_of(topk.topk()) == scores_of(expected.topk()));
+            for (auto [score, docid]: topk.topk()) {
+                auto pos = std::find(docids.begin(), docids.end(), docid) - docids.begin();
+                REQUIRE(scores[pos] == score);
+            }
+        });
+    }
+
+    SECTION("Batch inserts result in the same scores as the heap") {
+        check([] {
+            auto [scores, docids] = *gen_quantized_postings(1, 1000);
+            auto k = *gen::inRange<std::size_t>(1, 100);
+            auto split = *gen::inRange<std::size_t>(0, scores.size());
+
+            pisa::topk_queue expected(k);
+            for (std::size_t docid = 0; docid < scores.size(); ++docid) {
+                expected.insert(scores[docid], docid);
+            }
+            expected.finalize();
+
+            pisa::buffered_topk_queue topk(k);
+            std::span<float const> all(scores);
+            topk.insert_batch(all.first(split), 0);
+            topk.insert_batch(all.subspan(split), split);
+            topk.finalize();
+            REQUIRE(scores_of(topk.topk()) == scores_of(expected.topk()));
+            for (auto [score, docid]: topk.topk()) {
+                REQUIRE(scores[docid] == score);
+            }
+        });
+    }
+
+    SECTION("When initial is exact, final is the same") {
+        check([] {
+            auto [scores, docids] = *gen_postings(10, 1000);
+            auto initial = kth(scores, 10);
+            pisa::buffered_topk_queue topk(10, initial);
+            topk.insert_batch(scores, 0);
+            topk.finalize();
+            REQUIRE(topk.initial_threshold() == initial);
+            REQUIRE(topk.true_threshold() == topk.initial_threshold());
+            REQUIRE(topk.effective_threshold() == topk.initial_threshold());
+        });
+    }
 }
@@ -84,13 +84,19 @@ const std::map<std::string, bool> Algorithm::VALID_ALGORITHMS = {
     {"or_freq", false},
     {"wand", true},
     {"block_max_wand", true},
+    {"block_max_wand_bootstrap", true},
     {"block_max_maxscore", true},
     {"ranked_and", true},
     {"block_max_ranked_and", true},
     {"ranked_or", true},
     {"maxscore", true},
+    {"maxscore_bootstrap", true},
+    {"ranked_or_window", true},
     {"ranked_or_taat", true},
-    {"ranked_or_taat_lazy", true}
+    {"ranked_or_taat_lazy", true},
+    {"ranked_or_taat_block_max", true},
+    {"ranked_or_taat_quantized", true},
+    {"auto", true}
 };
 
 LogLevel::LogLevel(CLI::App* app) {
@@ -128,21 +134,25 @@ Algorithm::Algorithm(CLI::App* app) {
             return "";
         });
 
-    // Check if WAND data is provided when it is required by an algorithm.
-    if (auto* wand_option = app->get_option_no_throw("--wand")) {
-        app->callback([this, &wand_opt = *wand_option]() {
-            if (!wand_opt) {
-                for (const auto& algorithm: m_algorithms) {
-                    if (VALID_ALGORITHMS.at(algorithm)) {
-                        throw CLI::ValidationError(
-                            "Algorithm '" + algorithm
-                            + "' requires WAND data but it was not provided"
-                        );
-                    }
-                }
+    // Check if WAND data is provided when it is required by an algorithm, and that quantized
+    // accumulators are only used with quantized scores.
+    app->callback([this, app]() {
+        auto* wand_option = app->get_option_no_throw("--wand");
+        auto* scorer_option = app->get_option_no_throw("--scorer");
+        for (const auto& algorithm: m_algorithms) {
+            if (wand_option != nullptr && !*wand_option && VALID_ALGORITHMS.at(algorithm)) {
+                throw CLI::ValidationError(
+                    "Algorithm '" + algorithm + "' requires WAND data but it was not provided"
+                );
             }
-        });
-    }
+            if (algorithm == "ranked_or_taat_quantized" && scorer_option != nullptr
+                && scorer_option->as<std::string>() != "quantized") {
+                throw CLI::ValidationError(
+                    "Algorithm '" + algorithm + "' requires the quantized scorer"
+                );
+            }
+        }
+    });
 }
 
 auto Algorithm::algorithms() const -> std::vector<std::string> const& {
@@ -155,10 +165,21 @@ Quantize::Quantize(CLI::App* app) : m_params("") {
     auto* quant = app->add_option(
         "--quantize", m_quantization_bits, "Quantizes the scores using this many bits"
     );
+    auto* block_max = app->add_flag(
+        "--block-max-scores",
+        m_block_max_scores,
+        "Stores the block max scores in the posting lists (block indexes only)"
+    );
     wand->needs(scorer);
     scorer->needs(wand);
-    scorer->needs(quant);
     quant->needs(scorer);
+    block_max->needs(scorer);
+    // The scorer is only used to quantize or to compute the block max scores.
+    app->callback([scorer, quant, block_max]() {
+        if (*scorer && !*quant && !*block_max) {
+            throw CLI::ValidationError("--scorer requires --quantize or --block-max-scores");
+        }
+    });
 }
 
 auto Quantize::scorer_params() const -> ScorerParams {
@@ -169,6 +190,10 @@ auto Quantize::wand_data_path() const -> std::optional<std::string> const& {
     return m_wand_data_path;
 }
 
+auto Quantize::block_max_scores() const -> bool {
+    return m_block_max_scores;
+}
+
 auto Quantize::quantization_bits() const -> std::optional<Size> {
     if (m_quantization_bits.has_value()) {
         return Size(*m_quantization_bits);
@@ -187,6 +212,18 @@ auto Scorer::scorer_params() const -> ScorerParams {
 Thresholds::Thresholds(CLI::App* app) {
     m_option =
         app->add_option("-T,--thresholds", m_thresholds_filename, "File containing query thresholds");
+    app->add_option(
+        "--threshold-store",
+        m_threshold_store_filename,
+        "Threshold store used to seed the thresholds of disjunctive queries "
+        "(see kth_threshold --store)"
+    );
+    app->add_option(
+        "--champion-lists",
+        m_champion_lists_filename,
+        "Champion lists used to answer single-term queries and seed query thresholds "
+        "(see champion-lists)"
+    );
 }
 
 auto Thresholds::thresholds_file() const -> std::optional<std::string> const& {
@@ -197,6 +234,14 @@ auto Thresholds::thresholds_option() -> CLI::Option* {
     return m_option;
 }
 
+auto Thresholds::threshold_store_file() const -> std::optional<std::string> const& {
+    return m_threshold_store_filename;
+}
+
+auto Thresholds::champion_lists_file() const -> std::optional<std::string> const& {
+    return m_champion_lists_filename;
+}
+
 Verbose::Verbose(CLI::App* app) {
     app->add_flag("-v,--verbose", m_verbose, "Print additional information");
 }
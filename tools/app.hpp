@@ -29,6 +29,7 @@
 #include <spdlog/spdlog.h>
 #include <unordered_set>
 
+#include "compress.hpp"
 #include "io.hpp"
 #include "pisa/query.hpp"
 #include "pisa/query/query_parser.hpp"
@@ -134,15 +135,20 @@ namespace arg {
             return std::nullopt;
         }
 
-        [[nodiscard]] auto queries() const -> std::vector<::pisa::Query> {
-            std::vector<::pisa::Query> qs;
+        /// Returns a parser mapping query terms with the term lexicon, if any, or as term IDs.
+        [[nodiscard]] auto query_parser() const -> QueryParser {
             std::unique_ptr<TermMap> term_map = [this]() -> std::unique_ptr<TermMap> {
                 if (this->m_term_lexicon) {
                     return std::make_unique<LexiconMap>(*this->m_term_lexicon);
                 }
                 return std::make_unique<IntMap>();
             }();
-            QueryParser parser(text_analyzer(), std::move(term_map));
+            return QueryParser(text_analyzer(), std::move(term_map));
+        }
+
+        [[nodiscard]] auto queries() const -> std::vector<::pisa::Query> {
+            std::vector<::pisa::Query> qs;
+            QueryParser parser = query_parser();
             auto parse_query = [&qs, &parser](auto&& line) { qs.push_back(parser.parse(line)); };
             if (m_query_file) {
                 std::ifstream is(*m_query_file);
@@ -243,6 +249,7 @@ namespace arg {
         [[nodiscard]] auto scorer_params() const -> ScorerParams;
         [[nodiscard]] auto wand_data_path() const -> std::optional<std::string> const&;
         [[nodiscard]] auto quantization_bits() const -> std::optional<Size>;
+        [[nodiscard]] auto block_max_scores() const -> bool;
 
         template <typename T>
         friend CLI::Option* add_scorer_options(CLI::App* app, T& args, ScorerMode scorer_mode);
@@ -251,6 +258,7 @@ namespace arg {
         ScorerParams m_params;
         std::optional<std::string> m_wand_data_path;
         std::optional<std::size_t> m_quantization_bits = std::nullopt;
+        bool m_block_max_scores = false;
     };
 
     struct Scorer {
@@ -268,9 +276,13 @@ namespace arg {
         explicit Thresholds(CLI::App* app);
         [[nodiscard]] auto thresholds_file() const -> std::optional<std::string> const&;
         [[nodiscard]] auto thresholds_option() -> CLI::Option*;
+        [[nodiscard]] auto threshold_store_file() const -> std::optional<std::string> const&;
+        [[nodiscard]] auto champion_lists_file() const -> std::optional<std::string> const&;
 
       private:
         std::optional<std::string> m_thresholds_filename;
+        std::optional<std::string> m_threshold_store_filename;
+        std::optional<std::string> m_champion_lists_filename;
         CLI::Option* m_option;
     };
 
@@ -326,11 +338,47 @@ namespace arg {
                 ->required();
             app->add_option("-o,--output", m_output, "Output inverted index")->required();
             app->add_flag("--check", m_check, "Check the correctness of the index");
+            app->add_flag(
+                "--skip-layer",
+                m_skip_layer,
+                "Add a skip layer over block maxima to speed up long jumps (block indexes only)"
+            );
+            app->add_option(
+                   "--dense-cutoff",
+                   m_dense_cutoff,
+                   "Store the document IDs of the lists containing at least this fraction of "
+                   "documents as bitmaps (block indexes only)"
+            )
+                ->check(CLI::Range(0.0, 1.0));
+            app->add_option(
+                   "--decode-weight",
+                   m_hybrid_options.decode_weight,
+                   "Weight of the expected decoding time against the size, in bytes per "
+                   "nanosecond (block_hybrid only)"
+            )
+                ->capture_default_str()
+                ->check(CLI::NonNegativeNumber);
+            app->add_option(
+                "--term-frequencies",
+                m_hybrid_options.term_frequencies_file,
+                "Query log term frequencies, one per line in term ID order (block_hybrid only)"
+            );
+            app->add_option(
+                "--decode-model",
+                m_hybrid_options.decode_model_file,
+                "Decoding time predictors, one `<codec> <feature> <weight>` per line "
+                "(block_hybrid only)"
+            );
         }
 
         [[nodiscard]] auto input_basename() const -> std::string { return m_input_basename; }
         [[nodiscard]] auto output() const -> std::string { return m_output; }
         [[nodiscard]] auto check() const -> bool { return m_check; }
+        [[nodiscard]] auto skip_layer() const -> bool { return m_skip_layer; }
+        [[nodiscard]] auto dense_cutoff() const -> std::optional<double> { return m_dense_cutoff; }
+        [[nodiscard]] auto hybrid_options() const -> HybridCompressOptions const& {
+            return m_hybrid_options;
+        }
 
         /// Transform paths for `shard`.
         void apply_shard(Shard_Id shard) {
@@ -342,6 +390,9 @@ namespace arg {
         std::string m_input_basename{};
         std::string m_output{};
         bool m_check = false;
+        bool m_skip_layer = false;
+        std::optional<double> m_dense_cutoff{};
+        HybridCompressOptions m_hybrid_options{};
     };
 
     struct CreateWandData {
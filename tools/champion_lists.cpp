@@ -0,0 +1,79 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <CLI/CLI.hpp>
+#include <spdlog/spdlog.h>
+#include <tbb/global_control.h>
+
+#include "app.hpp"
+#include "binary_freq_collection.hpp"
+#include "champion_lists.hpp"
+#include "memory_source.hpp"
+#include "wand_data.hpp"
+#include "wand_data_compressed.hpp"
+#include "wand_data_raw.hpp"
+
+using namespace pisa;
+
+using wand_raw_index = wand_data<wand_data_raw>;
+using wand_uniform_index = wand_data<wand_data_compressed<>>;
+using wand_uniform_index_quantized = wand_data<wand_data_compressed<PayloadType::Quantized>>;
+
+int main(int argc, char** argv) {
+    std::string collection_basename;
+    std::string output_file;
+    std::size_t depth = 1000;
+    bool quantized = false;
+
+    App<arg::WandData<arg::WandMode::Required>, arg::Scorer, arg::Threads, arg::LogLevel> app{
+        "Builds champion lists: the highest scoring postings of each term"
+    };
+    app.add_option("-c,--collection", collection_basename, "Collection basename")->required();
+    app.add_option("-o,--output", output_file, "Output champion lists file")->required();
+    app.add_option("-d,--depth", depth, "Maximum number of postings of each list")
+        ->capture_default_str()
+        ->check(CLI::PositiveNumber);
+    app.add_flag("--quantized", quantized, "Quantized scores");
+    CLI11_PARSE(app, argc, argv);
+    spdlog::set_level(app.log_level());
+    tbb::global_control control(tbb::global_control::max_allowed_parallelism, app.threads() + 1);
+
+    try {
+        binary_freq_collection collection(collection_basename.c_str());
+        auto build = [&](auto const& wdata) {
+            auto builder = build_champion_lists(collection, wdata, app.scorer_params(), depth);
+            std::ofstream out(output_file);
+            builder.encode(out);
+        };
+        auto source = MemorySource::mapped_file(app.wand_data_path());
+        if (app.is_wand_compressed()) {
+            if (quantized) {
+                build(wand_uniform_index_quantized(std::move(source)));
+            } else {
+                build(wand_uniform_index(std::move(source)));
+            }
+        } else {
+            build(wand_raw_index(std::move(source)));
+        }
+        spdlog::info("Built champion lists of depth {}", depth);
+    } catch (std::exception const& err) {
+        spdlog::error("{}", err.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
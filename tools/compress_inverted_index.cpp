@@ -19,6 +19,10 @@ int main(int argc, char** argv) {
         args.scorer_params(),
         args.quantization_bits(),
         args.check(),
-        false
+        false,
+        args.skip_layer(),
+        args.hybrid_options(),
+        args.dense_cutoff(),
+        args.block_max_scores()
     );
 }
@@ -1,3 +1,4 @@
+#include <fstream>
 #include <iostream>
 #include <optional>
 
@@ -8,25 +9,20 @@
 #include <range/v3/view/enumerate.hpp>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
 #include <tbb/global_control.h>
 #include <tbb/parallel_for.h>
 
-#include "accumulator/lazy_accumulator.hpp"
-#include "accumulator/simple_accumulator.hpp"
 #include "app.hpp"
-#include "cursor/block_max_scored_cursor.hpp"
-#include "cursor/max_scored_cursor.hpp"
-#include "cursor/scored_cursor.hpp"
+#include "champion_lists.hpp"
 #include "index_types.hpp"
-#include "query/algorithm/block_max_maxscore_query.hpp"
-#include "query/algorithm/block_max_ranked_and_query.hpp"
-#include "query/algorithm/block_max_wand_query.hpp"
-#include "query/algorithm/maxscore_query.hpp"
-#include "query/algorithm/ranked_and_query.hpp"
-#include "query/algorithm/ranked_or_query.hpp"
-#include "query/algorithm/ranked_or_taat_query.hpp"
-#include "query/algorithm/wand_query.hpp"
+#include "query/algorithm/batched_ranked_or_taat_query.hpp"
+#include "query/cost_model.hpp"
+#include "query/query_groups.hpp"
+#include "query/query_processor.hpp"
 #include "scorer/scorer.hpp"
+#include "threshold_store.hpp"
 #include "wand_data.hpp"
 #include "wand_data_compressed.hpp"
 #include "wand_data_raw.hpp"
@@ -40,6 +36,8 @@ void evaluate_queries(
     const std::string& wand_data_filename,
     const std::vector<Query>& queries,
     const std::optional<std::string>& thresholds_filename,
+    const std::optional<std::string>& threshold_store_filename,
+    const std::optional<std::string>& champion_lists_filename,
     std::string const& type,
     std::string const& query_type,
     uint64_t k,
@@ -47,113 +45,100 @@ void evaluate_queries(
     ScorerParams const& scorer_params,
     const bool weighted,
     std::string const& run_id,
-    std::string const& iteration
+    std::string const& iteration,
+    std::optional<std::size_t> batch_size,
+    std::optional<CostModel> const& cost_model
 ) {
     auto const& index = *index_ptr;
     WandType const wdata(MemorySource::mapped_file(wand_data_filename));
 
     auto scorer = scorer::from_params(scorer_params, wdata);
-    std::function<std::vector<typename topk_queue::entry_type>(Query)> query_fun;
-
-    if (query_type == "wand") {
-        query_fun = [&](Query query) {
-            topk_queue topk(k);
-            wand_query wand_q(topk);
-            wand_q(make_max_scored_cursors(index, wdata, *scorer, query, weighted), index.num_docs());
-            topk.finalize();
-            return topk.topk();
-        };
-    } else if (query_type == "block_max_wand") {
-        query_fun = [&](Query query) {
-            topk_queue topk(k);
-            block_max_wand_query block_max_wand_q(topk);
-            block_max_wand_q(
-                make_block_max_scored_cursors(index, wdata, *scorer, query, weighted),
-                index.num_docs()
-            );
-            topk.finalize();
-            return topk.topk();
-        };
-    } else if (query_type == "block_max_maxscore") {
-        query_fun = [&](Query query) {
-            topk_queue topk(k);
-            block_max_maxscore_query block_max_maxscore_q(topk);
-            block_max_maxscore_q(
-                make_block_max_scored_cursors(index, wdata, *scorer, query, weighted),
-                index.num_docs()
-            );
-            topk.finalize();
-            return topk.topk();
-        };
-    } else if (query_type == "block_max_ranked_and") {
-        query_fun = [&](Query query) {
-            topk_queue topk(k);
-            block_max_ranked_and_query block_max_ranked_and_q(topk);
-            block_max_ranked_and_q(
-                make_block_max_scored_cursors(index, wdata, *scorer, query, weighted),
-                index.num_docs()
-            );
-            topk.finalize();
-            return topk.topk();
-        };
-    } else if (query_type == "ranked_and") {
-        query_fun = [&](Query query) {
-            topk_queue topk(k);
-            ranked_and_query ranked_and_q(topk);
-            ranked_and_q(make_scored_cursors(index, *scorer, query, weighted), index.num_docs());
-            topk.finalize();
-            return topk.topk();
-        };
-    } else if (query_type == "ranked_or") {
-        query_fun = [&](Query query) {
-            topk_queue topk(k);
-            ranked_or_query ranked_or_q(topk);
-            ranked_or_q(make_scored_cursors(index, *scorer, query, weighted), index.num_docs());
-            topk.finalize();
-            return topk.topk();
-        };
-    } else if (query_type == "maxscore") {
-        query_fun = [&](Query query) {
-            topk_queue topk(k);
-            maxscore_query maxscore_q(topk);
-            maxscore_q(
-                make_max_scored_cursors(index, wdata, *scorer, query, weighted), index.num_docs()
-            );
-            topk.finalize();
-            return topk.topk();
-        };
-    } else if (query_type == "ranked_or_taat") {
-        query_fun = [&, accumulator = SimpleAccumulator(index.num_docs())](Query query) mutable {
-            topk_queue topk(k);
-            ranked_or_taat_query ranked_or_taat_q(topk);
-            ranked_or_taat_q(
-                make_scored_cursors(index, *scorer, query, weighted), index.num_docs(), accumulator
-            );
-            topk.finalize();
-            return topk.topk();
-        };
-    } else if (query_type == "ranked_or_taat_lazy") {
-        query_fun = [&, accumulator = LazyAccumulator<4>(index.num_docs())](Query query) mutable {
-            topk_queue topk(k);
-            ranked_or_taat_query ranked_or_taat_q(topk);
-            ranked_or_taat_q(
-                make_scored_cursors(index, *scorer, query, weighted), index.num_docs(), accumulator
+    if (batch_size && query_type != "ranked_or_taat") {
+        spdlog::error("Batched execution is only supported by the ranked_or_taat algorithm");
+        return;
+    }
+    if (batch_size && champion_lists_filename) {
+        spdlog::warn("Champion lists are not used in batched execution");
+    }
+    QueryProcessor process;
+    try {
+        process = query_type == "auto"
+            ? make_auto_query_processor(index, wdata, *scorer, weighted, *cost_model)
+            : make_query_processor(query_type, index, wdata, *scorer, weighted);
+    } catch (std::invalid_argument const& err) {
+        spdlog::error("{}", err.what());
+        return;
+    }
+    bool conjunctive = is_conjunctive(query_type, cost_model ? &*cost_model : nullptr);
+    std::optional<ThresholdStore> threshold_store;
+    if (threshold_store_filename) {
+        if (conjunctive) {
+            spdlog::warn(
+                "Threshold store only applies to disjunctive algorithms and will not be used"
             );
-            topk.finalize();
-            return topk.topk();
-        };
-    } else {
-        spdlog::error("Unsupported query type: {}", query_type);
+        }
+        threshold_store.emplace(MemorySource::mapped_file(*threshold_store_filename));
+    }
+    std::optional<ChampionLists> champion_lists;
+    if (champion_lists_filename) {
+        champion_lists.emplace(MemorySource::mapped_file(*champion_lists_filename));
+        process = with_champion_lists(
+            std::move(process), *champion_lists, index, *scorer, weighted, conjunctive
+        );
     }
-
     auto source = std::make_shared<mio::mmap_source>(documents_filename.c_str());
     auto docmap = Payload_Vector<>::from(*source);
 
     std::vector<std::vector<typename topk_queue::entry_type>> raw_results(queries.size());
     auto start_batch = std::chrono::steady_clock::now();
-    tbb::parallel_for(size_t(0), queries.size(), [&, query_fun](size_t query_idx) {
-        raw_results[query_idx] = query_fun(queries[query_idx]);
-    });
+    if (batch_size) {
+        auto groups = group_queries_by_terms(queries, *batch_size);
+        spdlog::info("Processing {} queries in {} groups", queries.size(), groups.size());
+        // Each worker allocates its accumulators once and reuses them for all its groups.
+        tbb::enumerable_thread_specific<batched_ranked_or_taat_query<>> batched_queries([&] {
+            return batched_ranked_or_taat_query<>(index.num_docs(), *batch_size);
+        });
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, groups.size()), [&](auto const& range) {
+                auto& batched_q = batched_queries.local();
+                std::vector<topk_queue> topks;
+                for (auto group_idx = range.begin(); group_idx != range.end(); ++group_idx) {
+                    auto const& group = groups[group_idx];
+                    topks.assign(group.size(), topk_queue(k));
+                    for (std::size_t pos = 0; pos < group.size(); ++pos) {
+                        auto const& query = queries[group[pos]];
+                        topks[pos].reset(
+                            k, threshold_store ? threshold_store->threshold(query, k) : 0.0F
+                        );
+                    }
+                    batched_q(index, *scorer, queries, group, topks, weighted);
+                    for (std::size_t pos = 0; pos < group.size(); ++pos) {
+                        topks[pos].finalize();
+                        raw_results[group[pos]] = topks[pos].topk();
+                    }
+                }
+            }
+        );
+    } else {
+        // Processors own their query context, so each worker works on its own copy.
+        tbb::enumerable_thread_specific<QueryProcessor> processors(process);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, queries.size()), [&](auto const& range) {
+                auto& range_process = processors.local();
+                topk_queue topk(k);
+                for (auto query_idx = range.begin(); query_idx != range.end(); ++query_idx) {
+                    auto const& query = queries[query_idx];
+                    topk.reset(
+                        k,
+                        threshold_store ? threshold_store->threshold(query, k, conjunctive) : 0.0F
+                    );
+                    range_process(query, topk);
+                    topk.finalize();
+                    raw_results[query_idx] = topk.topk();
+                }
+            }
+        );
+    }
     auto end_batch = std::chrono::steady_clock::now();
 
     for (size_t query_idx = 0; query_idx < raw_results.size(); ++query_idx) {
@@ -190,6 +175,8 @@ int main(int argc, const char** argv) {
     std::string documents_file;
     std::string run_id = "R0";
     bool quantized = false;
+    std::optional<std::size_t> batch_size;
+    std::optional<std::string> cost_model_path;
 
     App<arg::Index,
         arg::WandData<arg::WandMode::Required>,
@@ -203,6 +190,18 @@ int main(int argc, const char** argv) {
     app.add_option("-r,--run", run_id, "Run identifier");
     app.add_option("--documents", documents_file, "Document lexicon")->required();
     app.add_flag("--quantized", quantized, "Quantized scores");
+    app.add_option(
+           "--batch-size",
+           batch_size,
+           "Processes queries in groups of at most this many queries sharing terms, traversing "
+           "each posting list once per group (ranked_or_taat only). Each worker thread keeps "
+           "this many accumulators of one float per document in memory"
+    )->check(CLI::PositiveNumber);
+    app.add_option(
+        "--cost-model",
+        cost_model_path,
+        "Cost model used by the auto algorithm to select an algorithm for each query"
+    );
 
     CLI11_PARSE(app, argc, argv);
 
@@ -221,6 +220,21 @@ int main(int argc, const char** argv) {
 
     auto iteration = "Q0";
 
+    std::optional<CostModel> cost_model;
+    if (app.algorithms().front() == "auto") {
+        if (!cost_model_path) {
+            spdlog::error("Algorithm 'auto' requires a cost model (--cost-model)");
+            return 1;
+        }
+        std::ifstream in(*cost_model_path);
+        try {
+            cost_model = CostModel::read(in);
+        } catch (std::exception const& err) {
+            spdlog::error("{}", err.what());
+            return 1;
+        }
+    }
+
     run_for_index(
         app.index_encoding(), MemorySource::mapped_file(app.index_filename()), [&](auto index) {
             using Index = std::decay_t<decltype(index)>;
@@ -229,6 +243,8 @@ int main(int argc, const char** argv) {
                 app.wand_data_path(),
                 app.queries(),
                 app.thresholds_file(),
+                app.threshold_store_file(),
+                app.champion_lists_file(),
                 app.index_encoding(),
                 app.algorithms().front(),
                 app.k(),
@@ -236,7 +252,9 @@ int main(int argc, const char** argv) {
                 app.scorer_params(),
                 app.weighted(),
                 run_id,
-                iteration
+                iteration,
+                batch_size,
+                cost_model
             );
             if (app.is_wand_compressed()) {
                 if (quantized) {
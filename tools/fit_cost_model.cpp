@@ -0,0 +1,230 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <spdlog/spdlog.h>
+
+#include "app.hpp"
+#include "index_types.hpp"
+#include "memory_source.hpp"
+#include "query/cost_model.hpp"
+#include "wand_data.hpp"
+#include "wand_data_compressed.hpp"
+#include "wand_data_raw.hpp"
+
+using namespace pisa;
+
+using wand_raw_index = wand_data<wand_data_raw>;
+using wand_uniform_index = wand_data<wand_data_compressed<>>;
+using wand_uniform_index_quantized = wand_data<wand_data_compressed<PayloadType::Quantized>>;
+
+/** Mean time in microseconds of each query, by algorithm and query position. */
+using Timings = std::map<std::string, std::map<std::size_t, std::pair<double, std::size_t>>>;
+
+/**
+ * Reads the per-run timings printed by `queries --output`: a header followed by lines of
+ * algorithm, query ID, run, and time in microseconds, separated by tabs.
+ */
+void read_timings(
+    std::string const& path,
+    std::unordered_map<std::string, std::size_t> const& query_positions,
+    Timings& timings
+) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error(fmt::format("Failed to open timing file: {}", path));
+    }
+    std::string line;
+    std::size_t unknown_queries = 0;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string algorithm;
+        std::string qid;
+        std::string run;
+        double usec = 0.0;
+        if (!std::getline(fields, algorithm, '\t') || algorithm == "algorithm") {
+            continue;
+        }
+        if (!std::getline(fields, qid, '\t') || !std::getline(fields, run, '\t')
+            || !(fields >> usec)) {
+            throw std::invalid_argument(fmt::format("Invalid timing line in {}: {}", path, line));
+        }
+        if (algorithm == "auto") {
+            // Timings of previously selected algorithms cannot be attributed to any of them.
+            continue;
+        }
+        auto pos = query_positions.find(qid);
+        if (pos == query_positions.end()) {
+            unknown_queries += 1;
+            continue;
+        }
+        auto& [sum, count] = timings[algorithm][pos->second];
+        sum += usec;
+        count += 1;
+    }
+    if (unknown_queries > 0) {
+        spdlog::warn("Skipped {} timings of unknown queries in {}", unknown_queries, path);
+    }
+}
+
+template <typename Index, typename Wand>
+auto fit(
+    Index const& index,
+    Wand const& wdata,
+    std::vector<Query> const& queries,
+    bool weighted,
+    Timings const& timings
+) -> CostModel {
+    std::vector<QueryFeatures> features;
+    features.reserve(queries.size());
+    for (auto const& query: queries) {
+        features.push_back(query_features(index, wdata, query, weighted));
+    }
+
+    CostModel model;
+    for (auto const& [algorithm, query_times]: timings) {
+        std::vector<QueryFeatures> observed;
+        std::vector<double> costs;
+        for (auto const& [query, time]: query_times) {
+            observed.push_back(features[query]);
+            costs.push_back(time.first / static_cast<double>(time.second));
+        }
+        auto predictor = CostPredictor::fit(observed, costs);
+        double error = 0.0;
+        for (std::size_t idx = 0; idx < observed.size(); ++idx) {
+            error += std::abs(predictor(observed[idx]) - costs[idx]);
+        }
+        spdlog::info(
+            "{}: fitted on {} queries, mean absolute error {:.2f} us",
+            algorithm,
+            observed.size(),
+            error / static_cast<double>(observed.size())
+        );
+        model.add(algorithm, predictor);
+    }
+
+    // Compares the selection with the best single algorithm on queries timed with all of them.
+    auto algorithms = model.algorithms();
+    std::vector<double> fixed_total(algorithms.size(), 0.0);
+    double selected_total = 0.0;
+    double oracle_total = 0.0;
+    std::size_t common_queries = 0;
+    for (std::size_t query = 0; query < queries.size(); ++query) {
+        std::vector<double> times;
+        for (auto const& algorithm: algorithms) {
+            auto const& query_times = timings.at(algorithm);
+            if (auto pos = query_times.find(query); pos != query_times.end()) {
+                times.push_back(pos->second.first / static_cast<double>(pos->second.second));
+            }
+        }
+        if (times.size() != algorithms.size()) {
+            continue;
+        }
+        common_queries += 1;
+        for (std::size_t idx = 0; idx < times.size(); ++idx) {
+            fixed_total[idx] += times[idx];
+        }
+        selected_total += times[model.select(features[query])];
+        oracle_total += *std::min_element(times.begin(), times.end());
+    }
+    if (common_queries > 0) {
+        auto best = std::min_element(fixed_total.begin(), fixed_total.end());
+        auto mean = [&](double total) { return total / static_cast<double>(common_queries); };
+        spdlog::info(
+            "Mean time on {} queries: best single algorithm ({}) {:.2f} us, selected {:.2f} us, "
+            "oracle {:.2f} us",
+            common_queries,
+            algorithms[static_cast<std::size_t>(std::distance(fixed_total.begin(), best))],
+            mean(*best),
+            mean(selected_total),
+            mean(oracle_total)
+        );
+    }
+    return model;
+}
+
+int main(int argc, char** argv) {
+    std::vector<std::string> timing_files;
+    std::string output_file;
+    bool quantized = false;
+
+    App<arg::Index,
+        arg::WandData<arg::WandMode::Required>,
+        arg::Query<arg::QueryMode::Unranked>,
+        arg::LogLevel>
+        app{"Fits a cost model for the auto algorithm from per-query timings"};
+    app.add_option(
+           "--timings",
+           timing_files,
+           "Per-run query timing files written by queries --output"
+    )
+        ->required();
+    app.add_option("-o,--output", output_file, "Output cost model file")->required();
+    app.add_flag("--quantized", quantized, "Quantized scores");
+    CLI11_PARSE(app, argc, argv);
+    spdlog::set_level(app.log_level());
+
+    try {
+        auto queries = app.queries();
+        std::unordered_map<std::string, std::size_t> query_positions;
+        for (std::size_t idx = 0; idx < queries.size(); ++idx) {
+            query_positions[queries[idx].id().value_or(std::to_string(idx))] = idx;
+        }
+        Timings timings;
+        for (auto const& path: timing_files) {
+            read_timings(path, query_positions, timings);
+        }
+        if (timings.empty()) {
+            throw std::invalid_argument("No timings of the given queries were found");
+        }
+
+        CostModel model;
+        run_for_index(
+            app.index_encoding(),
+            MemorySource::mapped_file(app.index_filename()),
+            [&](auto index) {
+                auto run = [&](auto const& wdata) {
+                    model = fit(index, wdata, queries, app.weighted(), timings);
+                };
+                auto source = MemorySource::mapped_file(app.wand_data_path());
+                if (app.is_wand_compressed()) {
+                    if (quantized) {
+                        run(wand_uniform_index_quantized(std::move(source)));
+                    } else {
+                        run(wand_uniform_index(std::move(source)));
+                    }
+                } else {
+                    run(wand_raw_index(std::move(source)));
+                }
+            }
+        );
+        std::ofstream out(output_file);
+        model.write(out);
+    } catch (std::exception const& err) {
+        spdlog::error("{}", err.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
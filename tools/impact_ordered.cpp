@@ -0,0 +1,179 @@
+// Copyright 2025 PISA developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include "accumulator/quantized_accumulator.hpp"
+#include "app.hpp"
+#include "impact_ordered_index.hpp"
+#include "index_types.hpp"
+#include "memory_source.hpp"
+#include "query/algorithm/saat_query.hpp"
+#include "topk_queue.hpp"
+
+using namespace pisa;
+
+struct Arguments {
+    std::string index_file{};
+    std::string encoding{};
+    std::string output_file{};
+    std::optional<std::size_t> postings_budget{};
+    std::optional<std::size_t> time_budget{};
+};
+
+auto build_cmd(CLI::App& app, Arguments& args) {
+    auto cmd = app.add_subcommand(
+        "build", "Converts an index compressed with quantized scores into an impact-ordered index"
+    );
+    cmd->add_option("-i,--index", args.index_file, "Quantized index file")->required();
+    cmd->add_option("-e,--encoding", args.encoding, "Index encoding")->required();
+    cmd->add_option("-o,--output", args.output_file, "Impact-ordered index output file")
+        ->required();
+    return cmd;
+}
+
+auto query_cmd(CLI::App& app, Arguments& args) {
+    auto cmd = app.add_subcommand(
+        "query", "Runs score-at-a-time queries and prints a summary of query times"
+    );
+    cmd->add_option("-i,--index", args.index_file, "Impact-ordered index file")->required();
+    cmd->add_option(
+        "--postings-budget",
+        args.postings_budget,
+        "Stops a query after processing the segment exceeding this number of postings"
+    );
+    cmd->add_option(
+        "--time-budget",
+        args.time_budget,
+        "Stops a query at a segment boundary after this many microseconds"
+    );
+    return cmd;
+}
+
+template <typename Index>
+void build(Index const& index, std::string const& output_file) {
+    ImpactOrderedIndexBuilder builder(index.num_docs());
+    std::vector<DocId> documents;
+    std::vector<std::uint32_t> impacts;
+    for (std::size_t term = 0; term < index.size(); ++term) {
+        auto cursor = index[term];
+        documents.clear();
+        impacts.clear();
+        while (cursor.docid() < index.num_docs()) {
+            documents.push_back(cursor.docid());
+            impacts.push_back(cursor.freq());
+            cursor.next();
+        }
+        builder.add_posting_list(documents, impacts);
+    }
+    std::ofstream out(output_file);
+    builder.encode(out);
+}
+
+void query(
+    ImpactOrderedIndex const& index,
+    std::vector<Query> const& queries,
+    std::size_t k,
+    bool weighted,
+    QueryBudget const& budget
+) {
+    topk_queue topk(k);
+    QueryContext context;
+    context.set_budget(budget);
+    QuantizedAccumulator<std::uint32_t> accumulator(index.num_docs());
+    std::vector<double> times;
+    std::size_t incomplete = 0;
+    std::size_t postings = 0;
+    for (auto const& q: queries) {
+        auto start = std::chrono::steady_clock::now();
+        context.reset();
+        topk.clear();
+        saat_query saat_q(topk, context);
+        saat_q(index, q, accumulator, weighted);
+        topk.finalize();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        times.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+        incomplete += topk.is_complete() ? 0 : 1;
+        postings += saat_q.processed_postings();
+    }
+    if (queries.empty()) {
+        spdlog::warn("No queries to run");
+        return;
+    }
+    std::sort(times.begin(), times.end());
+    nlohmann::json summary;
+    summary["queries"] = queries.size();
+    summary["k"] = k;
+    summary["incomplete"] = incomplete;
+    summary["mean_postings"] = static_cast<double>(postings) / queries.size();
+    summary["mean"] = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+    summary["q50"] = times[times.size() / 2];
+    summary["q90"] = times[90 * times.size() / 100];
+    summary["q95"] = times[95 * times.size() / 100];
+    summary["q99"] = times[99 * times.size() / 100];
+    std::cout << summary.dump(2) << "\n";
+}
+
+int main(int argc, char** argv) {
+    Arguments args;
+
+    App<arg::LogLevel> app{"Builds and queries impact-ordered indexes"};
+    app.require_subcommand();
+    auto build_command = build_cmd(app, args);
+    auto query_command = query_cmd(app, args);
+    arg::Query<arg::QueryMode::Ranked> query_args(query_command);
+    CLI11_PARSE(app, argc, argv);
+    spdlog::set_level(app.log_level());
+
+    try {
+        if (*build_command) {
+            run_for_index(
+                args.encoding,
+                MemorySource::mapped_file(args.index_file),
+                [&](auto index) { build(index, args.output_file); }
+            );
+        } else if (*query_command) {
+            QueryBudget budget;
+            if (args.postings_budget || args.time_budget) {
+                std::optional<QueryBudget::clock::duration> time_limit;
+                if (args.time_budget) {
+                    time_limit = std::chrono::microseconds(*args.time_budget);
+                }
+                budget = QueryBudget(
+                    args.postings_budget.value_or(std::numeric_limits<std::size_t>::max()),
+                    time_limit
+                );
+            }
+            ImpactOrderedIndex index(MemorySource::mapped_file(args.index_file));
+            query(index, query_args.queries(), query_args.k(), query_args.weighted(), budget);
+        }
+    } catch (std::exception const& err) {
+        spdlog::error("{}", err.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
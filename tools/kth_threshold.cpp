@@ -1,3 +1,4 @@
+#include <fstream>
 #include <iostream>
 #include <optional>
 #include <unordered_set>
@@ -9,6 +10,7 @@
 #include "mio/mmap.hpp"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/spdlog.h"
+#include "tbb/parallel_for.h"
 
 #include "mappable/mapper.hpp"
 
@@ -21,6 +23,7 @@
 
 #include "query/algorithm/wand_query.hpp"
 #include "scorer/scorer.hpp"
+#include "threshold_store.hpp"
 
 using namespace pisa;
 
@@ -48,6 +51,23 @@ std::set<uint32_t> parse_tuple(std::string const& line, size_t k) {
     return term_ids_int;
 }
 
+/// Returns the k-th highest score of the query made of the given terms, or 0 if it matches fewer
+/// than k documents.
+template <typename IndexType, typename WandType, typename Scorer, std::size_t N>
+auto kth_score(
+    IndexType const& index,
+    WandType const& wdata,
+    Scorer const& scorer,
+    std::array<std::uint32_t, N> terms,
+    uint64_t k
+) -> float {
+    topk_queue topk(k);
+    wand_query wand_q(topk);
+    Query query{std::nullopt, terms};
+    wand_q(make_max_scored_cursors(index, wdata, scorer, query), index.num_docs());
+    return topk.size() == k ? topk.true_threshold() : 0.0F;
+}
+
 template <typename IndexType, typename WandType>
 void kt_thresholds(
     IndexType const* index_ptr,
@@ -110,22 +130,22 @@ void kt_thresholds(
         float threshold = 0;
 
         auto terms = query.terms();
-        topk_queue topk(k);
-        wand_query wand_q(topk);
 
         for (auto&& term: terms) {
-            Query query{std::nullopt, std::array<std::uint32_t, 1>{term.id}};
-            wand_q(make_max_scored_cursors(index, wdata, *scorer, query), index.num_docs());
-            threshold = std::max(threshold, topk.size() == k ? topk.true_threshold() : 0.0F);
-            topk.clear();
+            auto score = kth_score(index, wdata, *scorer, std::array<std::uint32_t, 1>{term.id}, k);
+            threshold = std::max(threshold, score);
         }
         for (size_t i = 0; i < terms.size(); ++i) {
             for (size_t j = i + 1; j < terms.size(); ++j) {
                 if (pairs_set.count({terms[i].id, terms[j].id}) > 0 or all_pairs) {
-                    Query query{std::nullopt, std::array<std::uint32_t, 2>{terms[i].id, terms[j].id}};
-                    wand_q(make_max_scored_cursors(index, wdata, *scorer, query), index.num_docs());
-                    threshold = std::max(threshold, topk.size() == k ? topk.true_threshold() : 0.0F);
-                    topk.clear();
+                    auto score = kth_score(
+                        index,
+                        wdata,
+                        *scorer,
+                        std::array<std::uint32_t, 2>{terms[i].id, terms[j].id},
+                        k
+                    );
+                    threshold = std::max(threshold, score);
                 }
             }
         }
@@ -134,16 +154,14 @@ void kt_thresholds(
                 for (size_t s = j + 1; s < terms.size(); ++s) {
                     if (triples_set.count({terms[i].id, terms[j].id, terms[s].id}) > 0
                         or all_triples) {
-                        Query query{
-                            std::nullopt,
-                            std::array<std::uint32_t, 3>{terms[i].id, terms[j].id, terms[s].id}
-                        };
-                        wand_q(
-                            make_max_scored_cursors(index, wdata, *scorer, query), index.num_docs()
+                        auto score = kth_score(
+                            index,
+                            wdata,
+                            *scorer,
+                            std::array<std::uint32_t, 3>{terms[i].id, terms[j].id, terms[s].id},
+                            k
                         );
-                        threshold =
-                            std::max(threshold, topk.size() == k ? topk.true_threshold() : 0.0F);
-                        topk.clear();
+                        threshold = std::max(threshold, score);
                     }
                 }
             }
@@ -152,6 +170,103 @@ void kt_thresholds(
     }
 }
 
+/// Builds a `ThresholdStore` with the scores of all terms in the index, of the pairs and triples
+/// given in the files, and of all the pairs and triples of the queries if requested.
+template <typename IndexType, typename WandType>
+void build_threshold_store(
+    IndexType const* index_ptr,
+    const std::string& wand_data_filename,
+    const std::vector<Query>& queries,
+    ScorerParams const& scorer_params,
+    uint64_t k,
+    std::optional<std::string> pairs_filename,
+    std::optional<std::string> triples_filename,
+    bool all_pairs,
+    bool all_triples,
+    std::string const& output_filename
+) {
+    auto const& index = *index_ptr;
+    WandType const wdata(MemorySource::mapped_file(wand_data_filename));
+    auto scorer = scorer::from_params(scorer_params, wdata);
+
+    ThresholdStoreBuilder builder(k, index.size());
+    std::vector<float> term_scores(index.size(), 0.0F);
+    tbb::parallel_for(std::size_t{0}, index.size(), [&](std::size_t term) {
+        if (index[term].size() >= k) {
+            auto term_id = static_cast<std::uint32_t>(term);
+            term_scores[term] =
+                kth_score(index, wdata, *scorer, std::array<std::uint32_t, 1>{term_id}, k);
+        }
+    });
+    for (std::size_t term = 0; term < term_scores.size(); ++term) {
+        builder.term(term, term_scores[term]);
+    }
+    spdlog::info("Computed thresholds of {} terms", index.size());
+
+    std::set<std::array<std::uint32_t, 2>> pairs;
+    std::set<std::array<std::uint32_t, 3>> triples;
+    std::string line;
+    if (pairs_filename) {
+        std::ifstream pin(*pairs_filename);
+        while (std::getline(pin, line)) {
+            auto pair = parse_tuple(line, 2);
+            pairs.insert({*pair.begin(), *pair.rbegin()});
+        }
+    }
+    if (triples_filename) {
+        std::ifstream trin(*triples_filename);
+        while (std::getline(trin, line)) {
+            auto triple = parse_tuple(line, 3);
+            triples.insert({*triple.begin(), *std::next(triple.begin()), *triple.rbegin()});
+        }
+    }
+    for (auto const& query: queries) {
+        std::set<std::uint32_t> term_set;
+        for (auto const& term: query.terms()) {
+            term_set.insert(term.id);
+        }
+        std::vector<std::uint32_t> terms(term_set.begin(), term_set.end());
+        for (size_t i = 0; i < terms.size(); ++i) {
+            for (size_t j = i + 1; j < terms.size(); ++j) {
+                if (all_pairs) {
+                    pairs.insert({terms[i], terms[j]});
+                }
+                for (size_t s = j + 1; s < terms.size() && all_triples; ++s) {
+                    triples.insert({terms[i], terms[j], terms[s]});
+                }
+            }
+        }
+    }
+
+    std::vector<std::array<std::uint32_t, 2>> pair_list(pairs.begin(), pairs.end());
+    std::vector<float> pair_scores(pair_list.size());
+    tbb::parallel_for(std::size_t{0}, pair_list.size(), [&](std::size_t idx) {
+        pair_scores[idx] = kth_score(index, wdata, *scorer, pair_list[idx], k);
+    });
+    for (std::size_t idx = 0; idx < pair_list.size(); ++idx) {
+        if (pair_scores[idx] > 0.0F) {
+            builder.pair(pair_list[idx][0], pair_list[idx][1], pair_scores[idx]);
+        }
+    }
+    spdlog::info("Computed thresholds of {} pairs", pair_list.size());
+
+    std::vector<std::array<std::uint32_t, 3>> triple_list(triples.begin(), triples.end());
+    std::vector<float> triple_scores(triple_list.size());
+    tbb::parallel_for(std::size_t{0}, triple_list.size(), [&](std::size_t idx) {
+        triple_scores[idx] = kth_score(index, wdata, *scorer, triple_list[idx], k);
+    });
+    for (std::size_t idx = 0; idx < triple_list.size(); ++idx) {
+        if (triple_scores[idx] > 0.0F) {
+            auto const& [first, second, third] = triple_list[idx];
+            builder.triple(first, second, third, triple_scores[idx]);
+        }
+    }
+    spdlog::info("Computed thresholds of {} triples", triple_list.size());
+
+    std::ofstream out(output_filename, std::ios::binary);
+    builder.encode(out);
+}
+
 using wand_raw_index = wand_data<wand_data_raw>;
 using wand_uniform_index = wand_data<wand_data_compressed<>>;
 using wand_uniform_index_quantized = wand_data<wand_data_compressed<PayloadType::Quantized>>;
@@ -169,6 +284,7 @@ int main(int argc, const char** argv) {
 
     bool all_pairs = false;
     bool all_triples = false;
+    std::optional<std::string> store_filename;
 
     App<arg::Index, arg::WandData<arg::WandMode::Required>, arg::Query<arg::QueryMode::Ranked>, arg::Scorer, arg::LogLevel>
         app{"A tool for performing threshold estimation using the k-highest impact score for each "
@@ -185,11 +301,54 @@ int main(int argc, const char** argv) {
     app.add_flag("--all-pairs", all_pairs, "Consider all term pairs of a query")->excludes(pairs);
     app.add_flag("--all-triples", all_triples, "Consider all term triples of a query")->excludes(triples);
     app.add_flag("--quantized", quantized, "Quantizes the scores");
+    app.add_option(
+        "--store",
+        store_filename,
+        "Instead of printing query thresholds, write a threshold store with the scores of all "
+        "terms, and of the given pairs and triples; queries are only read for --all-pairs and "
+        "--all-triples"
+    );
 
     CLI11_PARSE(app, argc, argv);
 
     spdlog::set_level(app.log_level());
 
+    if (store_filename) {
+        std::vector<Query> queries;
+        if (all_pairs || all_triples) {
+            queries = app.queries();
+        }
+        run_for_index(
+            app.index_encoding(), MemorySource::mapped_file(app.index_filename()), [&](auto index) {
+                using Index = std::decay_t<decltype(index)>;
+                auto params = std::make_tuple(
+                    &index,
+                    app.wand_data_path(),
+                    queries,
+                    app.scorer_params(),
+                    app.k(),
+                    pairs_filename,
+                    triples_filename,
+                    all_pairs,
+                    all_triples,
+                    *store_filename
+                );
+                if (app.is_wand_compressed()) {
+                    if (quantized) {
+                        std::apply(
+                            build_threshold_store<Index, wand_uniform_index_quantized>, params
+                        );
+                    } else {
+                        std::apply(build_threshold_store<Index, wand_uniform_index>, params);
+                    }
+                } else {
+                    std::apply(build_threshold_store<Index, wand_raw_index>, params);
+                }
+            }
+        );
+        return 0;
+    }
+
     run_for_index(
         app.index_encoding(), MemorySource::mapped_file(app.index_filename()), [&](auto index) {
             using Index = std::decay_t<decltype(index)>;
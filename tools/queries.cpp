@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <numeric>
 #include <optional>
 #include <string>
@@ -26,26 +28,17 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
-#include "accumulator/lazy_accumulator.hpp"
-#include "accumulator/simple_accumulator.hpp"
 #include "app.hpp"
-#include "cursor/block_max_scored_cursor.hpp"
+#include "champion_lists.hpp"
 #include "cursor/cursor.hpp"
-#include "cursor/max_scored_cursor.hpp"
-#include "cursor/scored_cursor.hpp"
 #include "index_types.hpp"
 #include "memory_source.hpp"
 #include "query/algorithm/and_query.hpp"
-#include "query/algorithm/block_max_maxscore_query.hpp"
-#include "query/algorithm/block_max_ranked_and_query.hpp"
-#include "query/algorithm/block_max_wand_query.hpp"
-#include "query/algorithm/maxscore_query.hpp"
 #include "query/algorithm/or_query.hpp"
-#include "query/algorithm/ranked_and_query.hpp"
-#include "query/algorithm/ranked_or_query.hpp"
-#include "query/algorithm/ranked_or_taat_query.hpp"
-#include "query/algorithm/wand_query.hpp"
+#include "query/cost_model.hpp"
+#include "query/query_processor.hpp"
 #include "scorer/scorer.hpp"
+#include "threshold_store.hpp"
 #include "timer.hpp"
 #include "topk_queue.hpp"
 #include "type_alias.hpp"
@@ -99,9 +92,17 @@ struct QueryTimesSummary {
     }
 };
 
+/** The number of results of a query, and whether it was processed within its budget. */
+struct QueryOutcome {
+    std::uint64_t results;
+    bool complete = true;
+};
+
 struct QueryTimes {
     std::vector<std::vector<std::size_t>> values;
     std::size_t corrective_rerun_count;
+    /** The number of queries stopped by the budget in at least one run. */
+    std::size_t incomplete_count = 0;
 
     auto aggregate_none() const -> std::vector<std::size_t> {
         std::vector<std::size_t> aggregated;
@@ -193,24 +194,31 @@ auto extract_times(
     QueryTimes query_times{
         std::vector<std::vector<std::size_t>>(queries.size(), std::vector<std::size_t>(runs)), 0
     };
+    std::vector<bool> incomplete(queries.size(), false);
 
     // Note: each query is measured once per run, so the set of queries is
     // measured independently in each run.
     for (size_t run = 0; run <= runs; ++run) {
         for (auto&& [query_idx, query]: enumerate(queries)) {
+            QueryOutcome outcome{};
             auto usecs = run_with_timer<std::chrono::microseconds>([&]() {
-                uint64_t result = query_func(query, thresholds[query_idx]);
-                if (safe && result < k) {
+                outcome = query_func(query, thresholds[query_idx]);
+                if (safe && outcome.results < k) {
                     query_times.corrective_rerun_count += 1;
-                    result = query_func(query, 0);
+                    outcome = query_func(query, 0);
                 }
-                do_not_optimize_away(result);
+                do_not_optimize_away(outcome.results);
             });
             if (run != 0) {  // first run is not timed
                 query_times.values[query_idx][run - 1] = usecs.count();
+                if (!outcome.complete) {
+                    incomplete[query_idx] = true;
+                }
             }
         }
     }
+    query_times.incomplete_count =
+        static_cast<std::size_t>(std::count(incomplete.begin(), incomplete.end(), true));
 
     return query_times;
 }
@@ -221,7 +229,8 @@ void print_summary(
     std::string const& query_type,
     size_t runs,
     std::uint64_t k,
-    bool safe
+    bool safe,
+    QueryBudget const& budget
 ) {
     nlohmann::json summary;
     summary["encoding"] = index_type;
@@ -230,6 +239,16 @@ void print_summary(
     summary["k"] = k;
     summary["safe"] = safe;
     summary["corrective_reruns"] = query_times.corrective_rerun_count;
+    if (budget.is_limited()) {
+        if (budget.max_postings() != std::numeric_limits<std::size_t>::max()) {
+            summary["postings_budget"] = budget.max_postings();
+        }
+        if (auto time_limit = budget.time_limit(); time_limit) {
+            summary["time_budget"] =
+                std::chrono::duration_cast<std::chrono::microseconds>(*time_limit).count();
+        }
+        summary["incomplete"] = query_times.incomplete_count;
+    }
     summary["times"] = nlohmann::json::array();
 
     for (auto agg_type:
@@ -282,6 +301,8 @@ void perftest(
     const std::optional<std::string>& wand_data_filename,
     const std::vector<Query>& queries,
     const std::optional<std::string>& thresholds_filename,
+    const std::optional<std::string>& threshold_store_filename,
+    const std::optional<std::string>& champion_lists_filename,
     std::string const& type,
     std::vector<std::string> const& query_types,
     uint64_t k,
@@ -289,6 +310,9 @@ void perftest(
     const bool weighted,
     bool safe,
     std::size_t runs,
+    std::size_t intra_query_ranges,
+    QueryBudget const& budget,
+    std::optional<CostModel> const& cost_model,
     std::optional<std::ofstream> output_file
 ) {
     auto const& index = *index_ptr;
@@ -323,142 +347,92 @@ void perftest(
             throw std::invalid_argument("Invalid thresholds file.");
         }
     }
-
-    auto scorer = scorer::from_params(scorer_params, wdata);
+    // The thresholds of the store are only lower bounds for disjunctive algorithms.
+    std::vector<Score> disjunctive_thresholds = thresholds;
+    if (threshold_store_filename) {
+        ThresholdStore store(MemorySource::mapped_file(*threshold_store_filename));
+        if (k > store.k()) {
+            spdlog::warn("Threshold store was built for k = {} and will not be used", store.k());
+        }
+        for (std::size_t idx = 0; idx < queries.size(); ++idx) {
+            disjunctive_thresholds[idx] =
+                std::max(thresholds[idx], store.threshold(queries[idx], k));
+        }
+    }
+    std::optional<ChampionLists> champion_lists;
+    if (champion_lists_filename) {
+        champion_lists.emplace(MemorySource::mapped_file(*champion_lists_filename));
+    }
 
     if (output_file) {
         *output_file << "algorithm\tqid\trun\tusec\n";
     }
 
-    for (const auto& t: query_types) {
-        auto valid_algorithms_it = pisa::arg::Algorithm::VALID_ALGORITHMS.find(t);
-        if (valid_algorithms_it == pisa::arg::Algorithm::VALID_ALGORITHMS.end()) {
-            spdlog::error("Unsupported query type: {}", t);
-            break;
-        }
-        if (valid_algorithms_it->second && !wand_data_filename) {
-            spdlog::error("Query type '{}' requires WAND data", t);
-            break;
-        }
+    // The scorer is resolved once, so that scoring can be inlined in the query processing loops.
+    scorer::run_for_scorer(scorer_params, wdata, [&](auto const& scorer) {
+        for (const auto& t: query_types) {
+            auto valid_algorithms_it = pisa::arg::Algorithm::VALID_ALGORITHMS.find(t);
+            if (valid_algorithms_it == pisa::arg::Algorithm::VALID_ALGORITHMS.end()) {
+                spdlog::error("Unsupported query type: {}", t);
+                break;
+            }
+            if (valid_algorithms_it->second && !wand_data_filename) {
+                spdlog::error("Query type '{}' requires WAND data", t);
+                break;
+            }
 
-        spdlog::info("Performing {} runs for '{}' queries...", runs, t);
-
-        std::function<uint64_t(Query, Score)> query_fun;
-        if (t == "and") {
-            query_fun = [&](Query query, Score) {
-                and_query and_q;
-                return and_q(make_cursors(index, query), index.num_docs()).size();
-            };
-        } else if (t == "or") {
-            query_fun = [&](Query query, Score) {
-                or_query<false> or_q;
-                return or_q(make_cursors(index, query), index.num_docs());
-            };
-        } else if (t == "or_freq") {
-            query_fun = [&](Query query, Score) {
-                or_query<true> or_q;
-                return or_q(make_cursors(index, query), index.num_docs());
-            };
-        } else if (t == "wand") {
-            query_fun = [&](Query query, Score threshold) {
-                topk_queue topk(k, threshold);
-                wand_query wand_q(topk);
-                wand_q(
-                    make_max_scored_cursors(index, wdata, *scorer, query, weighted), index.num_docs()
-                );
-                topk.finalize();
-                return topk.topk().size();
-            };
-        } else if (t == "block_max_wand") {
-            query_fun = [&](Query query, Score threshold) {
-                topk_queue topk(k, threshold);
-                block_max_wand_query block_max_wand_q(topk);
-                block_max_wand_q(
-                    make_block_max_scored_cursors(index, wdata, *scorer, query, weighted),
-                    index.num_docs()
-                );
-                topk.finalize();
-                return topk.topk().size();
-            };
-        } else if (t == "block_max_maxscore") {
-            query_fun = [&](Query query, Score threshold) {
-                topk_queue topk(k, threshold);
-                block_max_maxscore_query block_max_maxscore_q(topk);
-                block_max_maxscore_q(
-                    make_block_max_scored_cursors(index, wdata, *scorer, query, weighted),
-                    index.num_docs()
-                );
-                topk.finalize();
-                return topk.topk().size();
-            };
-        } else if (t == "ranked_and") {
-            query_fun = [&](Query query, Score threshold) {
-                topk_queue topk(k, threshold);
-                ranked_and_query ranked_and_q(topk);
-                ranked_and_q(make_scored_cursors(index, *scorer, query, weighted), index.num_docs());
-                topk.finalize();
-                return topk.topk().size();
-            };
-        } else if (t == "block_max_ranked_and") {
-            query_fun = [&](Query query, Score threshold) {
-                topk_queue topk(k, threshold);
-                block_max_ranked_and_query block_max_ranked_and_q(topk);
-                block_max_ranked_and_q(
-                    make_block_max_scored_cursors(index, wdata, *scorer, query, weighted),
-                    index.num_docs()
-                );
-                topk.finalize();
-                return topk.topk().size();
-            };
-        } else if (t == "ranked_or") {
-            query_fun = [&](Query query, Score threshold) {
-                topk_queue topk(k, threshold);
-                ranked_or_query ranked_or_q(topk);
-                ranked_or_q(make_scored_cursors(index, *scorer, query, weighted), index.num_docs());
-                topk.finalize();
-                return topk.topk().size();
-            };
-        } else if (t == "maxscore") {
-            query_fun = [&](Query query, Score threshold) {
-                topk_queue topk(k, threshold);
-                maxscore_query maxscore_q(topk);
-                maxscore_q(
-                    make_max_scored_cursors(index, wdata, *scorer, query, weighted), index.num_docs()
-                );
-                topk.finalize();
-                return topk.topk().size();
-            };
-        } else if (t == "ranked_or_taat") {
-            SimpleAccumulator accumulator(index.num_docs());
-            topk_queue topk(k);
-            query_fun = [&, topk, accumulator](Query query, Score threshold) mutable {
-                ranked_or_taat_query ranked_or_taat_q(topk);
-                topk.clear(threshold);
-                ranked_or_taat_q(
-                    make_scored_cursors(index, *scorer, query, weighted), index.num_docs(), accumulator
-                );
-                topk.finalize();
-                return topk.topk().size();
-            };
-        } else if (t == "ranked_or_taat_lazy") {
-            LazyAccumulator<4> accumulator(index.num_docs());
-            topk_queue topk(k);
-            query_fun = [&, topk, accumulator](Query query, Score threshold) mutable {
-                ranked_or_taat_query ranked_or_taat_q(topk);
-                topk.clear(threshold);
-                ranked_or_taat_q(
-                    make_scored_cursors(index, *scorer, query, weighted), index.num_docs(), accumulator
-                );
-                topk.finalize();
-                return topk.topk().size();
-            };
-        }
-        auto query_times = extract_times(query_fun, queries, thresholds, runs, k, safe);
-        print_summary(query_times, type, t, runs, k, safe);
-        if (output_file) {
-            print_times(query_times, queries, t, *output_file);
+            spdlog::info("Performing {} runs for '{}' queries...", runs, t);
+            bool conjunctive = is_conjunctive(t, cost_model ? &*cost_model : nullptr);
+
+            std::function<QueryOutcome(Query const&, Score)> query_fun;
+            if (t == "and") {
+                query_fun = [&](Query const& query, Score) {
+                    and_query and_q;
+                    auto results = and_q(make_cursors(index, query), index.num_docs());
+                    return QueryOutcome{results.size()};
+                };
+            } else if (t == "or") {
+                query_fun = [&](Query const& query, Score) {
+                    or_query<false> or_q;
+                    return QueryOutcome{or_q(make_cursors(index, query), index.num_docs())};
+                };
+            } else if (t == "or_freq") {
+                query_fun = [&](Query const& query, Score) {
+                    or_query<true> or_q;
+                    return QueryOutcome{or_q(make_cursors(index, query), index.num_docs())};
+                };
+            } else {
+                auto process = t == "auto"
+                    ? make_auto_query_processor(
+                          index, wdata, scorer, weighted, *cost_model, intra_query_ranges, budget
+                      )
+                    : make_query_processor(
+                          t, index, wdata, scorer, weighted, intra_query_ranges, budget
+                      );
+                if (champion_lists) {
+                    process = with_champion_lists(
+                        std::move(process), *champion_lists, index, scorer, weighted, conjunctive
+                    );
+                }
+                // The queue is reused, so that its storage is allocated only once.
+                query_fun = [&, process, topk = topk_queue(k)](
+                                Query const& query, Score threshold
+                            ) mutable {
+                    topk.reset(k, threshold);
+                    process(query, topk);
+                    topk.finalize();
+                    return QueryOutcome{topk.topk().size(), topk.is_complete()};
+                };
+            }
+            auto query_times = extract_times(
+                query_fun, queries, conjunctive ? thresholds : disjunctive_thresholds, runs, k, safe
+            );
+            print_summary(query_times, type, t, runs, k, safe, budget);
+            if (output_file) {
+                print_times(query_times, queries, t, *output_file);
+            }
         }
-    }
+    });
 }
 
 using wand_raw_index = wand_data<wand_data_raw>;
@@ -469,7 +443,11 @@ int main(int argc, const char** argv) {
     bool safe = false;
     bool quantized = false;
     std::size_t runs = 3;
+    std::size_t intra_query_ranges = 1;
     std::optional<std::string> output_path;
+    std::optional<std::size_t> postings_budget;
+    std::optional<std::size_t> time_budget;
+    std::optional<std::string> cost_model_path;
 
     App<arg::Index,
         arg::WandData<arg::WandMode::Optional>,
@@ -486,6 +464,31 @@ int main(int argc, const char** argv) {
         ->capture_default_str()
         ->check(CLI::PositiveNumber);
     app.add_option("-o,--output", output_path, "Output file for per-run query timing data");
+    app.add_option(
+        "--intra-query-ranges",
+        intra_query_ranges,
+        "Split wand, block_max_wand, maxscore, and block_max_maxscore queries into this many "
+        "document ranges processed in parallel"
+    )
+        ->capture_default_str()
+        ->check(CLI::PositiveNumber);
+    app.add_option(
+        "--postings-budget",
+        postings_budget,
+        "Stop each query after processing about this many postings, and report the number of "
+        "queries that were stopped"
+    );
+    app.add_option(
+        "--time-budget",
+        time_budget,
+        "Stop each query after this many microseconds, and report the number of queries that "
+        "were stopped"
+    );
+    app.add_option(
+        "--cost-model",
+        cost_model_path,
+        "Cost model used by the auto algorithm to select an algorithm for each query"
+    );
     CLI11_PARSE(app, argc, argv);
 
     spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
@@ -493,6 +496,32 @@ int main(int argc, const char** argv) {
 
     auto const& query_types = app.algorithms();
 
+    QueryBudget budget;
+    if (postings_budget || time_budget) {
+        std::optional<QueryBudget::clock::duration> time_limit;
+        if (time_budget) {
+            time_limit = std::chrono::microseconds(*time_budget);
+        }
+        budget = QueryBudget(
+            postings_budget.value_or(std::numeric_limits<std::size_t>::max()), time_limit
+        );
+    }
+
+    std::optional<CostModel> cost_model;
+    if (std::find(query_types.begin(), query_types.end(), "auto") != query_types.end()) {
+        if (!cost_model_path) {
+            spdlog::error("Algorithm 'auto' requires a cost model (--cost-model)");
+            return EXIT_FAILURE;
+        }
+        std::ifstream in(*cost_model_path);
+        try {
+            cost_model = CostModel::read(in);
+        } catch (std::exception const& e) {
+            spdlog::error("{}", e.what());
+            return EXIT_FAILURE;
+        }
+    }
+
     // If required, attempt to open the output file
     std::optional<std::ofstream> output_file;
     try {
@@ -513,6 +542,8 @@ int main(int argc, const char** argv) {
                 app.wand_data_path(),
                 app.queries(),
                 app.thresholds_file(),
+                app.threshold_store_file(),
+                app.champion_lists_file(),
                 app.index_encoding(),
                 query_types,
                 app.k(),
@@ -520,6 +551,9 @@ int main(int argc, const char** argv) {
                 app.weighted(),
                 safe,
                 runs,
+                intra_query_ranges,
+                budget,
+                cost_model,
                 std::move(output_file)
             );
             if (app.is_wand_compressed()) {
@@ -0,0 +1,529 @@
+// Copyright 2025 PISA Developers
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <CLI/CLI.hpp>
+#include <mio/mmap.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <tbb/concurrent_queue.h>
+
+#include "app.hpp"
+#include "index_types.hpp"
+#include "io.hpp"
+#include "memory_source.hpp"
+#include "payload_vector.hpp"
+#include "query/query_processor.hpp"
+#include "query/result_cache.hpp"
+#include "scorer/scorer.hpp"
+#include "threshold_store.hpp"
+#include "topk_queue.hpp"
+#include "wand_data.hpp"
+#include "wand_data_compressed.hpp"
+#include "wand_data_raw.hpp"
+
+using namespace pisa;
+
+/// Destination of responses: either the standard output or a client connection.
+///
+/// Responses are written by multiple workers, one line at a time.
+class ResponseSink {
+  public:
+    explicit ResponseSink(int fd, bool owned) : m_fd(fd), m_owned(owned) {}
+    ResponseSink(ResponseSink const&) = delete;
+    ResponseSink(ResponseSink&&) = delete;
+    ResponseSink& operator=(ResponseSink const&) = delete;
+    ResponseSink& operator=(ResponseSink&&) = delete;
+    ~ResponseSink() {
+        if (m_owned) {
+            ::close(m_fd);
+        }
+    }
+
+    /// Writes the response followed by a new line. Errors, such as a closed connection,
+    /// are logged, and the response is dropped.
+    void write(std::string response) {
+        response.push_back('\n');
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::string_view remaining = response;
+        while (!remaining.empty()) {
+            auto written = ::write(m_fd, remaining.data(), remaining.size());
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                spdlog::warn("Failed to write response: {}", std::strerror(errno));
+                return;
+            }
+            remaining.remove_prefix(written);
+        }
+    }
+
+  private:
+    int m_fd;
+    bool m_owned;
+    std::mutex m_mutex;
+};
+
+struct Request {
+    std::string line;
+    std::shared_ptr<ResponseSink> sink;
+};
+
+/// Requests waiting to be processed; an empty value signals a worker to stop.
+using RequestQueue = tbb::concurrent_bounded_queue<std::optional<Request>>;
+
+struct ServeOptions {
+    std::string algorithm;
+    std::uint64_t k;
+    std::uint64_t max_k;
+    bool weighted;
+    std::size_t threads;
+    std::optional<std::string> socket_path;
+    std::optional<std::string> requests_path;
+    std::optional<std::string> documents_path;
+    std::size_t cache_bytes;
+    CachePolicy cache_policy;
+    std::optional<std::string> threshold_store_path;
+};
+
+/// Calls `fn` for each line read from the file descriptor, until the end of the stream.
+template <typename Fn>
+void for_each_line(int fd, Fn&& fn) {
+    std::string buffer;
+    std::array<char, 4096> chunk{};
+    while (true) {
+        auto bytes = ::read(fd, chunk.data(), chunk.size());
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes <= 0) {
+            break;
+        }
+        buffer.append(chunk.data(), bytes);
+        std::size_t line_start = 0;
+        for (auto pos = buffer.find('\n'); pos != std::string::npos;
+             pos = buffer.find('\n', line_start)) {
+            fn(buffer.substr(line_start, pos - line_start));
+            line_start = pos + 1;
+        }
+        buffer.erase(0, line_start);
+    }
+    if (!buffer.empty()) {
+        fn(std::move(buffer));
+    }
+}
+
+[[nodiscard]] auto listen_on_socket(std::string const& path) -> int {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument(fmt::format("Socket path too long: {}", path));
+    }
+    std::copy(path.begin(), path.end(), address.sun_path);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to create socket");
+    }
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr const*>(&address), sizeof(address)) < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to bind socket");
+    }
+    if (::listen(fd, SOMAXCONN) < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to listen on socket");
+    }
+    return fd;
+}
+
+/**
+ * Wraps a query processor so that queries without an initial threshold are processed with the
+ * threshold from the store.
+ *
+ * The queue passed to the processor keeps a zero initial threshold, so that the results can still
+ * be cached: the thresholds from the store are lower bounds on the k-th score of disjunctive
+ * queries, and never cause missed results for them. They must not be used with conjunctive
+ * algorithms (see `is_conjunctive`), which may score all their results below the threshold.
+ */
+[[nodiscard]] auto seed_thresholds(QueryProcessor process, ThresholdStore const& store)
+    -> QueryProcessor {
+    return [process = std::move(process), &store, seeded = topk_queue(0)](
+               Query const& query, topk_queue& topk
+           ) mutable {
+        auto threshold = store.threshold(query, topk.capacity());
+        if (topk.initial_threshold() != 0.0F || threshold == 0.0F) {
+            process(query, topk);
+            return;
+        }
+        seeded.reset(topk.capacity(), threshold);
+        process(query, seeded);
+        for (auto const& [score, docid]: seeded.topk()) {
+            topk.insert(score, docid);
+        }
+    };
+}
+
+/**
+ * Executes requests from the queue until it receives an empty value.
+ *
+ * Each worker has its own query parser, top-k queue, and query processors, created on first use of
+ * each algorithm and reused afterwards, so that query contexts and accumulators are allocated only
+ * once per thread.
+ *
+ * A request is a JSON object in a single line:
+ *
+ *     {"id": "q1", "query": "text", "k": 10, "algorithm": "maxscore", "threshold": 0.0}
+ *
+ * Only "query" is required; other fields default to the command line arguments. "k" must be
+ * between 1 and the configured maximum. The response contains the request ID, if any, the
+ * results, and the processing time in microseconds; if the request fails, the response contains
+ * "error" instead of results.
+ *
+ * If the result cache is enabled, the request `{"stats": true}` returns its counters.
+ */
+template <typename Index, typename Wand, typename Scorer>
+void run_worker(
+    RequestQueue& requests,
+    QueryParser parser,
+    Index const& index,
+    Wand const& wdata,
+    Scorer const& scorer,
+    std::optional<Payload_Vector<>> const& docmap,
+    ThresholdStore const* threshold_store,
+    ResultCache* cache,
+    std::string const& scorer_id,
+    ServeOptions const& options
+) {
+    std::map<std::string, QueryProcessor, std::less<>> processors;
+    auto processor = [&](std::string const& algorithm) -> QueryProcessor& {
+        auto pos = processors.find(algorithm);
+        if (pos == processors.end()) {
+            auto process = make_query_processor(algorithm, index, wdata, scorer, options.weighted);
+            if (threshold_store != nullptr && !is_conjunctive(algorithm)) {
+                process = seed_thresholds(std::move(process), *threshold_store);
+            }
+            if (cache != nullptr) {
+                process =
+                    make_cached_query_processor(std::move(process), *cache, algorithm, scorer_id);
+            }
+            pos = processors.emplace(algorithm, std::move(process)).first;
+        }
+        return pos->second;
+    };
+
+    topk_queue topk(options.k);
+    auto handle = [&](std::string const& line) -> nlohmann::json {
+        nlohmann::json response;
+        try {
+            auto request = nlohmann::json::parse(line);
+            if (request.contains("id")) {
+                response["id"] = request["id"];
+            }
+            if (cache != nullptr && request.value("stats", false)) {
+                auto stats = cache->stats();
+                response["cache"] = {
+                    {"hits", stats.hits},
+                    {"misses", stats.misses},
+                    {"insertions", stats.insertions},
+                    {"evictions", stats.evictions},
+                    {"entries", stats.entries},
+                    {"bytes", stats.bytes},
+                };
+                return response;
+            }
+            auto query = parser.parse(request.at("query").get<std::string>());
+            // Read as signed, so that negative values are rejected rather than wrapped around.
+            auto k = request.value("k", static_cast<std::int64_t>(options.k));
+            if (k <= 0 || static_cast<std::uint64_t>(k) > options.max_k) {
+                throw std::invalid_argument(
+                    fmt::format("k must be between 1 and {}", options.max_k)
+                );
+            }
+            auto threshold = request.value("threshold", 0.0F);
+            auto& process = processor(request.value("algorithm", options.algorithm));
+
+            auto start = std::chrono::steady_clock::now();
+            topk.reset(k, threshold);
+            process(query, topk);
+            topk.finalize();
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start
+            );
+
+            auto results = nlohmann::json::array();
+            for (auto const& [score, docid]: topk.topk()) {
+                nlohmann::json result{{"docid", docid}, {"score", score}};
+                if (docmap) {
+                    result["document"] = std::string((*docmap)[docid]);
+                }
+                results.push_back(std::move(result));
+            }
+            response["results"] = std::move(results);
+            response["time_us"] = elapsed.count();
+        } catch (std::exception const& err) {
+            response["error"] = err.what();
+        }
+        return response;
+    };
+
+    while (true) {
+        std::optional<Request> request;
+        requests.pop(request);
+        if (!request) {
+            return;
+        }
+        request->sink->write(handle(request->line).dump());
+    }
+}
+
+template <typename Index, typename Wand, typename Scorer>
+void run_server(
+    Index const& index,
+    Wand const& wdata,
+    Scorer const& scorer,
+    ScorerParams const& scorer_params,
+    std::function<QueryParser()> const& make_parser,
+    ServeOptions const& options
+) {
+    std::optional<mio::mmap_source> documents_source;
+    std::optional<Payload_Vector<>> docmap;
+    if (options.documents_path) {
+        documents_source.emplace(options.documents_path->c_str());
+        docmap.emplace(Payload_Vector<>::from(*documents_source));
+    }
+
+    std::optional<ThresholdStore> threshold_store;
+    if (options.threshold_store_path) {
+        threshold_store.emplace(MemorySource::mapped_file(*options.threshold_store_path));
+    }
+    std::unique_ptr<ResultCache> cache;
+    if (options.cache_bytes > 0) {
+        cache = std::make_unique<ResultCache>(options.cache_bytes, options.cache_policy);
+    }
+    // Results depend on all the scorer parameters, and on whether query weights are used.
+    auto scorer_id = fmt::format(
+        "{}:{}:{}:{}:{}:{}",
+        scorer_params.name,
+        scorer_params.bm25_b,
+        scorer_params.bm25_k1,
+        scorer_params.pl2_c,
+        scorer_params.qld_mu,
+        options.weighted
+    );
+
+    // Fail early if the default algorithm is unknown.
+    [[maybe_unused]] auto validated =
+        make_query_processor(options.algorithm, index, wdata, scorer, options.weighted);
+
+    RequestQueue requests;
+    requests.set_capacity(16 * options.threads);
+
+    std::vector<std::thread> workers;
+    for (std::size_t worker = 0; worker < options.threads; ++worker) {
+        workers.emplace_back([&, parser = make_parser()]() mutable {
+            run_worker(
+                requests,
+                std::move(parser),
+                index,
+                wdata,
+                scorer,
+                docmap,
+                threshold_store ? &*threshold_store : nullptr,
+                cache.get(),
+                scorer_id,
+                options
+            );
+        });
+    }
+    spdlog::info("Started {} workers", options.threads);
+
+    auto enqueue = [&](std::shared_ptr<ResponseSink> const& sink) {
+        return [&requests, sink](std::string line) {
+            if (!line.empty()) {
+                requests.push(Request{std::move(line), sink});
+            }
+        };
+    };
+
+    if (options.socket_path) {
+        int server_fd = listen_on_socket(*options.socket_path);
+        spdlog::info("Listening on {}", *options.socket_path);
+        while (true) {
+            int client_fd = ::accept(server_fd, nullptr, nullptr);
+            if (client_fd < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "Failed to accept");
+            }
+            auto sink = std::make_shared<ResponseSink>(client_fd, true);
+            std::thread([client_fd, read_line = enqueue(sink)]() mutable {
+                for_each_line(client_fd, read_line);
+            }).detach();
+        }
+    }
+
+    auto sink = std::make_shared<ResponseSink>(STDOUT_FILENO, false);
+    auto read_line = enqueue(sink);
+    if (options.requests_path) {
+        std::ifstream is(*options.requests_path);
+        io::for_each_line(is, read_line);
+    } else {
+        io::for_each_line(std::cin, read_line);
+    }
+    for (std::size_t worker = 0; worker < options.threads; ++worker) {
+        requests.push(std::nullopt);
+    }
+    for (auto& worker: workers) {
+        worker.join();
+    }
+}
+
+template <typename Index, typename Wand>
+void serve(
+    Index const& index,
+    std::string const& wand_data_path,
+    ScorerParams const& scorer_params,
+    std::function<QueryParser()> const& make_parser,
+    ServeOptions const& options
+) {
+    Wand const wdata(MemorySource::mapped_file(wand_data_path));
+    // The scorer is resolved once, so that scoring can be inlined in the query processing loops.
+    scorer::run_for_scorer(scorer_params, wdata, [&](auto const& scorer) {
+        run_server(index, wdata, scorer, scorer_params, make_parser, options);
+    });
+}
+
+using wand_raw_index = wand_data<wand_data_raw>;
+using wand_uniform_index = wand_data<wand_data_compressed<>>;
+using wand_uniform_index_quantized = wand_data<wand_data_compressed<PayloadType::Quantized>>;
+
+int main(int argc, const char** argv) {
+    spdlog::set_default_logger(spdlog::stderr_color_mt("default"));
+
+    std::optional<std::string> socket_path;
+    std::optional<std::string> documents_path;
+    bool quantized = false;
+    std::size_t cache_bytes = 0;
+    std::string cache_policy = "lru";
+    std::optional<std::string> threshold_store_path;
+    std::uint64_t max_k = 10000;
+
+    App<arg::Index,
+        arg::WandData<arg::WandMode::Required>,
+        arg::Query<arg::QueryMode::Ranked>,
+        arg::Algorithm,
+        arg::Scorer,
+        arg::Threads,
+        arg::LogLevel>
+        app{
+            "Serves ranked queries, one JSON object per line, read from a Unix socket, the query "
+            "file, or the standard input."
+        };
+    app.add_option("--socket", socket_path, "Unix domain socket to listen on")
+        ->excludes(app.get_option("--queries"));
+    app.add_option("--documents", documents_path, "Document lexicon");
+    app.add_flag("--quantized", quantized, "Quantized scores");
+    app.add_option("--max-k", max_k, "Maximum number of results a request can ask for")
+        ->check(CLI::PositiveNumber);
+    app.add_option("--cache-bytes", cache_bytes, "Result cache size in bytes (0 disables it)");
+    app.add_option("--cache-policy", cache_policy, "Result cache eviction policy")
+        ->check(CLI::IsMember({"lru", "lfu"}));
+    app.add_option(
+        "--threshold-store",
+        threshold_store_path,
+        "Threshold store used to seed the thresholds of disjunctive queries "
+        "(see kth_threshold --store)"
+    );
+    CLI11_PARSE(app, argc, argv);
+
+    spdlog::set_level(app.log_level());
+
+    if (app.algorithms().size() > 1) {
+        spdlog::error("Only one default algorithm (query type) is allowed.");
+        return 1;
+    }
+
+    if (static_cast<std::uint64_t>(app.k()) > max_k) {
+        spdlog::error("The number of results ({}) exceeds --max-k ({})", app.k(), max_k);
+        return 1;
+    }
+
+    // Writing to a disconnected client must not terminate the server.
+    std::signal(SIGPIPE, SIG_IGN);
+
+    ServeOptions options{
+        app.algorithms().front(),
+        static_cast<std::uint64_t>(app.k()),
+        max_k,
+        app.weighted(),
+        std::max<std::size_t>(app.threads(), 1),
+        socket_path,
+        app.query_file().has_value() ? std::optional<std::string>(app.query_file()->get())
+                                     : std::nullopt,
+        documents_path,
+        cache_bytes,
+        parse_cache_policy(cache_policy),
+        threshold_store_path
+    };
+    std::function<QueryParser()> make_parser = [&app] { return app.query_parser(); };
+
+    try {
+        run_for_index(
+            app.index_encoding(), MemorySource::mapped_file(app.index_filename()), [&](auto index) {
+                using Index = std::decay_t<decltype(index)>;
+                auto params = std::make_tuple(
+                    std::cref(index),
+                    app.wand_data_path(),
+                    app.scorer_params(),
+                    std::cref(make_parser),
+                    std::cref(options)
+                );
+                if (app.is_wand_compressed()) {
+                    if (quantized) {
+                        std::apply(serve<Index, wand_uniform_index_quantized>, params);
+                    } else {
+                        std::apply(serve<Index, wand_uniform_index>, params);
+                    }
+                } else {
+                    std::apply(serve<Index, wand_raw_index>, params);
+                }
+            }
+        );
+    } catch (std::exception const& err) {
+        spdlog::error("{}", err.what());
+        return 1;
+    }
+}
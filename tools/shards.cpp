@@ -119,7 +119,11 @@ int main(int argc, char** argv) {
                     shard_args.scorer_params(),
                     shard_args.quantization_bits(),
                     shard_args.check(),
-                    false
+                    false,
+                    shard_args.skip_layer(),
+                    shard_args.hybrid_options(),
+                    shard_args.dense_cutoff(),
+                    shard_args.block_max_scores()
                 );
             }
             return 0;
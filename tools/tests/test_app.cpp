@@ -412,20 +412,26 @@ TEST_CASE("Algorithm", "[cli]") {
 
 TEST_CASE("Algorithm WAND requirement mapping is correct", "[cli]") {
     auto const& algorithms = pisa::arg::Algorithm::VALID_ALGORITHMS;
-    REQUIRE(algorithms.size() == 12);
+    REQUIRE(algorithms.size() == 18);
 
     REQUIRE(algorithms.at("and") == false);
     REQUIRE(algorithms.at("or") == false);
     REQUIRE(algorithms.at("or_freq") == false);
     REQUIRE(algorithms.at("wand") == true);
     REQUIRE(algorithms.at("block_max_wand") == true);
+    REQUIRE(algorithms.at("block_max_wand_bootstrap") == true);
     REQUIRE(algorithms.at("block_max_maxscore") == true);
     REQUIRE(algorithms.at("ranked_and") == true);
     REQUIRE(algorithms.at("block_max_ranked_and") == true);
     REQUIRE(algorithms.at("ranked_or") == true);
     REQUIRE(algorithms.at("maxscore") == true);
+    REQUIRE(algorithms.at("maxscore_bootstrap") == true);
+    REQUIRE(algorithms.at("ranked_or_window") == true);
     REQUIRE(algorithms.at("ranked_or_taat") == true);
     REQUIRE(algorithms.at("ranked_or_taat_lazy") == true);
+    REQUIRE(algorithms.at("ranked_or_taat_block_max") == true);
+    REQUIRE(algorithms.at("ranked_or_taat_quantized") == true);
+    REQUIRE(algorithms.at("auto") == true);
 }
 
 TEST_CASE("Algorithm requires WAND data", "[cli]") {
@@ -465,6 +471,26 @@ TEST_CASE("Algorithm requires WAND data", "[cli]") {
     }
 }
 
+TEST_CASE("Quantized accumulator requires the quantized scorer", "[cli]") {
+    CLI::App app("Algorithm scorer test");
+    pisa::Args<
+        pisa::arg::WandData<pisa::arg::WandMode::Optional>,
+        pisa::arg::Algorithm,
+        pisa::arg::Scorer>
+        args(&app);
+    SECTION("Other scorers throw") {
+        REQUIRE_THROWS(parse(app, {"-a", "ranked_or_taat_quantized", "-w", "WDATA", "-s", "bm25"}));
+    }
+    SECTION("Quantized scorer succeeds") {
+        REQUIRE_NOTHROW(
+            parse(app, {"-a", "ranked_or_taat_quantized", "-w", "WDATA", "-s", "quantized"})
+        );
+    }
+    SECTION("Other algorithms succeed with any scorer") {
+        REQUIRE_NOTHROW(parse(app, {"-a", "ranked_or_taat", "-w", "WDATA", "-s", "bm25"}));
+    }
+}
+
 TEST_CASE("Scorer", "[cli]") {
     CLI::App app("Scorer test");
     pisa::Args<pisa::arg::Scorer> args(&app);
@@ -512,6 +538,15 @@ TEST_CASE("Quantize", "[cli]") {
     SECTION("Wand without --quantize throws") {
         REQUIRE_THROWS(parse(app, {"--wand", "WAND"}));
     }
+    SECTION("Block max scores without scorer throws") {
+        REQUIRE_THROWS(parse(app, {"--block-max-scores"}));
+    }
+    SECTION("Block max scores") {
+        parse(app, {"--block-max-scores", "--scorer", "scorer", "--wand", "WAND"});
+        REQUIRE(args.block_max_scores());
+        REQUIRE_FALSE(args.quantization_bits().has_value());
+        REQUIRE(args.scorer_params().name == "scorer");
+    }
     SECTION("Long scorer & wand options with defaults") {
         parse(app, {"--quantize", "8", "--scorer", "scorer", "--wand", "WAND"});
         auto params = args.scorer_params();
@@ -559,6 +594,11 @@ TEST_CASE("Thresholds", "[cli]") {
         parse(app, {"-T", "THRESHOLDS"});
         REQUIRE(args.thresholds_file() == "THRESHOLDS");
     }
+    SECTION("Champion lists") {
+        parse(app, {"--champion-lists", "CHAMPIONS"});
+        REQUIRE(args.champion_lists_file() == "CHAMPIONS");
+        REQUIRE_FALSE(args.threshold_store_file().has_value());
+    }
 }
 
 TEST_CASE("Verbose", "[cli]") {
@@ -651,6 +691,7 @@ TEST_CASE("Compress", "[cli]") {
         REQUIRE(args.input_basename() == "COLLECTION");
         REQUIRE(args.output() == "OUTPUT");
         REQUIRE_FALSE(args.check());
+        REQUIRE_FALSE(args.dense_cutoff().has_value());
     }
     SECTION("With check") {
         parse(app, {"--collection", "COLLECTION", "--output", "OUTPUT", "--check"});
@@ -658,6 +699,37 @@ TEST_CASE("Compress", "[cli]") {
         REQUIRE(args.output() == "OUTPUT");
         REQUIRE(args.check());
     }
+    SECTION("Default hybrid options") {
+        parse(app, {"-c", "COLLECTION", "-o", "OUTPUT"});
+        REQUIRE(args.hybrid_options().decode_weight == 0.1);
+        REQUIRE_FALSE(args.hybrid_options().term_frequencies_file.has_value());
+        REQUIRE_FALSE(args.hybrid_options().decode_model_file.has_value());
+    }
+    SECTION("Hybrid options") {
+        parse(
+            app,
+            {"-c",
+             "COLLECTION",
+             "-o",
+             "OUTPUT",
+             "--decode-weight",
+             "2.5",
+             "--term-frequencies",
+             "FREQS",
+             "--decode-model",
+             "MODEL"}
+        );
+        REQUIRE(args.hybrid_options().decode_weight == 2.5);
+        REQUIRE(args.hybrid_options().term_frequencies_file == "FREQS");
+        REQUIRE(args.hybrid_options().decode_model_file == "MODEL");
+    }
+    SECTION("Dense cutoff") {
+        parse(app, {"-c", "COLLECTION", "-o", "OUTPUT", "--dense-cutoff", "0.25"});
+        REQUIRE(args.dense_cutoff() == 0.25);
+    }
+    SECTION("Throws with dense cutoff above 1") {
+        REQUIRE_THROWS(parse(app, {"-c", "COLLECTION", "-o", "OUTPUT", "--dense-cutoff", "2"}));
+    }
 }
 
 TEST_CASE("CreateWandData", "[cli]") {